@@ -12,25 +12,10 @@
 #include <stdlib.h>
 #include <math.h>
 
-#define MULTI_THREAD_KL_CALC
-#ifdef MULTI_THREAD_KL_CALC
-#include <pthread.h>
-#include <time.h>
-#endif
+#include <vector>
 
 extern "C"{
 
-#ifdef MULTI_THREAD_KL_CALC
-struct mul_thread_inputs{
-  long long* hist;
-  float* kl;
-  long long count;
-  long long i;
-  long long N;
-  long long BINS;
-};
-#endif
-
 static inline void print_trace(void)
 {
   void *array[10];
@@ -88,149 +73,69 @@ inline long long the_min_index(float *data, long long count) {
   return min_index;
 }
 
-float real_kl_diversity(float *data, long long count) {
-  const long long N = 2048;
+// KL divergence of each candidate threshold i = BINS, 2 * BINS, ..., N. P is
+// hist clipped into [0, i), Q is hist[0, i) quantized to BINS levels and
+// expanded back over the nonzero bins. Both only differ from zero on nonzero
+// bins and Q is constant inside a level, so with prefix sums of the counts,
+// of the nonzero bins and of P * log(P), each candidate costs O(BINS)
+// instead of rebuilding P and Q over all N bins.
+static long long kl_min_index(const long long *hist, const long long N,
+                              float *kl_min) {
   const long long BINS = 128;
   const long long KL_NUM = N / BINS;
-  float hist[N] = {0.0};
-  float kl[KL_NUM] = {0.0};
-
-  float data_max = the_max(data, count);
-  float width = data_max / (N - 1);
-
-  printf("%s %d: data_max=%f width=%f\n", __func__, __LINE__, data_max, width);
-
-  for (long long i = 0; i < count; i++) {
-    long long index = floor(fabs(data[i]) / width + 0.5);
-    hist[index] += 1;
-  }
-
-  long long m = 0;
-  float sum = 0;
-  for (long long i = BINS; i < N + 1; i += BINS) {
-    // P distribution
-    float *P = (float*)malloc(sizeof(float) * i);
-    for (long long j = 0; j < i; j++) {
-      P[j] = 0;
-    }
-    for (long long j = 0; j < N; j++) {
-      long long index = (j > (i - 1)) ? (i - 1) : j;
-      P[index] += hist[j];
-    }
-    for (long long j = 0; j < i; j++) {
-      P[j] /= count;
-    }
-
-    // Q distribution
-    long long expand_size = i / BINS;
-    long long idx = 0;
-    float *Q = (float*)malloc(sizeof(float) * i);
-    for (long long j = i - BINS; j < i; j++) {
-      sum += hist[j];
-    }
-    for (long long j = 0; j < BINS; j++) {
-      float sum_bin = 0;
-      float positive_cnt = 0;
-      long long bin_idx = idx;
-      for (long long k = 0; k < expand_size; k++) {
-        sum_bin += hist[idx];
-        positive_cnt += (hist[idx] > 0) ? 1 : 0;
-        idx++;
-      }
-      positive_cnt = (positive_cnt == 0) ? 1 : positive_cnt;
-      float Q_base = sum_bin / positive_cnt / sum;
-      while (bin_idx < idx) {
-        Q[bin_idx] = hist[bin_idx] ? Q_base : 0;
-        bin_idx++;
-      }
-    }
-    for (idx = 0; idx < i; idx++) {
-      kl[m] += P[idx] * (log10(P[idx] + 1e-30) - log10(Q[idx] + 1e-30));
-    }
-    m++;
-
-    free(P);
-    free(Q);
-  }
-
-  long long m_min = the_min_index(kl, m);
-  float threshold = width * (m_min + 1) * BINS;
-  printf("  threshold: %.12f, m: %lld, kl: %f\n", threshold, m_min, kl[m_min]);
-
-  return threshold;
-}
-
-#ifdef MULTI_THREAD_KL_CALC
-
-void* kl_calc_thread(void* args_input) {
-  struct mul_thread_inputs *args;
-  args = (struct mul_thread_inputs *)args_input;
-  long long* hist = args->hist;
-  long long i = args->i;
-  long long count = args->count;
-  long long N = args->N;
-  long long BINS = args->BINS;
-
-  // P distribution
-  float *P = (float*)malloc(sizeof(float) * i);
-  for (long long j = 0; j < i; j++) {
-    P[j] = 0;
-  }
+  ASSERT(KL_NUM > 0);
+  std::vector<long long> cnt(N + 1, 0);
+  std::vector<long long> nonzero(N + 1, 0);
+  std::vector<double> plogp(N + 1, 0.0);
   for (long long j = 0; j < N; j++) {
-    long long index = (j > (i - 1)) ? (i - 1) : j;
-    P[index] += hist[j];
-  }
-  for (long long j = 0; j < i; j++) {
-    P[j] /= count;
-  }
-
-  // Q distribution
-  float sum = 0.0;
-  long long expand_size = i / BINS;
-  long long idx = 0;
-  float *Q = (float*)malloc(sizeof(float) * i);
-  for (long long j = 0; j < i; j++) {
-    sum += hist[j];
+    cnt[j + 1] = cnt[j] + hist[j];
+    nonzero[j + 1] = nonzero[j] + (hist[j] > 0 ? 1 : 0);
   }
-  for (long long j = 0; j < BINS; j++) {
-    float sum_bin = 0;
-    float positive_cnt = 0;
-    long long bin_idx = idx;
-    for (long long k = 0; k < expand_size; k++) {
-      sum_bin += hist[idx];
-      positive_cnt += (hist[idx] > 0) ? 1 : 0;
-      idx++;
+  const double count = cnt[N];
+  for (long long j = 0; j < N; j++) {
+    double p = hist[j] / count;
+    plogp[j + 1] = plogp[j] + (hist[j] > 0 ? p * log(p) : 0.0);
+  }
+
+  std::vector<float> kl(KL_NUM);
+  for (long long m = 0; m < KL_NUM; m++) {
+    const long long i = (m + 1) * BINS;
+    const long long expand_size = i / BINS;
+    const double sum = cnt[i];
+    // sum of P * log(Q) over [0, i), as if P were not clipped
+    double p_logq = 0.0;
+#pragma omp simd reduction(+ : p_logq)
+    for (long long b = 0; b < BINS; b++) {
+      long long lo = b * expand_size;
+      long long hi = lo + expand_size;
+      double sum_bin = cnt[hi] - cnt[lo];
+      double positive_cnt = nonzero[hi] - nonzero[lo];
+      double q = sum_bin > 0 ? sum_bin / positive_cnt / sum : 1.0;
+      p_logq += sum_bin * log(q);
     }
-    positive_cnt = (positive_cnt == 0) ? 1 : positive_cnt;
-    float Q_base = sum_bin / positive_cnt / sum;
-    while (bin_idx < idx) {
-      Q[bin_idx] = hist[bin_idx] ? Q_base : 0;
-      bin_idx++;
+    // the last bin of P takes all counts from i - 1 on
+    double q_last = 0.0;
+    if (hist[i - 1] > 0) {
+      double sum_bin = cnt[i] - cnt[i - expand_size];
+      double positive_cnt = nonzero[i] - nonzero[i - expand_size];
+      q_last = sum_bin / positive_cnt / sum;
+      p_logq -= hist[i - 1] * log(q_last);
     }
+    double p_last = (cnt[N] - cnt[i - 1]) / count;
+    double kl_v = plogp[i - 1] - p_logq / count +
+                  p_last * (log(p_last + 1e-30) - log(q_last + 1e-30));
+    kl[m] = kl_v / log(10.0);
   }
-  for (idx = 0; idx < i; idx++) {
-    *(args->kl) += P[idx] * (log10(P[idx] + 1e-30) - log10(Q[idx] + 1e-30));
+  long long m_min = the_min_index(kl.data(), KL_NUM);
+  if (kl_min != NULL) {
+    *kl_min = kl[m_min];
   }
-
-  free(P);
-  free(Q);
-
-  return NULL;
+  return m_min;
 }
 
-float real_multi_thread_kl_diversity(float *data, long long count, const long long num_bins) {
-  const long long N = num_bins;
+float real_kl_diversity(float *data, long long count, const long long N) {
   const long long BINS = 128;
-  const long long KL_NUM = N / BINS;
-  long long *hist = new long long[N];
-  float *kl = new float[KL_NUM];
-
-  for (int i = 0; i < N; i++) {
-    hist[i] = 0LL;
-  }
-  for (int i = 0; i < KL_NUM; i++) {
-    kl[i] = 0.0;
-  }
+  std::vector<long long> hist(N, 0);
 
   float data_max = the_max(data, count);
   float width = data_max / (N - 1);
@@ -242,100 +147,36 @@ float real_multi_thread_kl_diversity(float *data, long long count, const long lo
     hist[index] += 1;
   }
 
-  long long m = 0;
-  pthread_t *id = new pthread_t[KL_NUM];
-  struct mul_thread_inputs *args_input = new struct mul_thread_inputs[KL_NUM];
-  for (long long i = BINS; i < N + 1; i += BINS) {
-    args_input[m].hist  = hist;
-    args_input[m].kl    = &kl[m];
-    args_input[m].count = count;
-    args_input[m].i     = i;
-    args_input[m].N     = N;
-    args_input[m].BINS  = BINS;
-    long long ret = pthread_create(&id[m], NULL, kl_calc_thread, (void *)&args_input[m]);
-    if (ret) {
-      printf("Create No. %lld thread error!\n", m);
-      exit(1);
-    }
-    m++;
-  }
-
-  for (long long i = 0; i < m; i++) {
-    pthread_join(id[i], NULL);
-  }
-
-  long long m_min = the_min_index(kl, m);
+  float kl_min;
+  long long m_min = kl_min_index(hist.data(), N, &kl_min);
   float threshold = width * (m_min + 1) * BINS;
-  printf("  threshold: %f, m: %lld, kl: %f\n", threshold, m_min, kl[m_min]);
-
-  delete[] hist;
-  delete[] kl;
-  delete[] id;
-  delete[] args_input;
-
+  printf("  threshold: %f, m: %lld, kl: %f\n", threshold, m_min, kl_min);
   return threshold;
 }
 
-float real_multi_thread_kl_diversity_hist(int *data, float &width, const long long N) {
+float real_kl_diversity_hist(const int *data, float width, const long long N) {
   const long long BINS = 128;
-  const long long KL_NUM = N / BINS;
-  long long *hist = new long long[N];
-  float *kl = new float[KL_NUM];
-  long long count = 0;
-
-  for (int i = 0; i < KL_NUM; i++) {
-    kl[i] = 0.0;
-  }
-
-  for (int i = 0; i < N; i++) {
-    hist[i] = data[i];
-    count += hist[i];
-  }
-
-  long long m = 0;
-  pthread_t *id = new pthread_t[KL_NUM];
-  struct mul_thread_inputs *args_input = new struct mul_thread_inputs[KL_NUM];
-  for (long long i = BINS; i < N + 1; i += BINS) {
-    args_input[m].hist  = hist;
-    args_input[m].kl    = &kl[m];
-    args_input[m].count = count;
-    args_input[m].i     = i;
-    args_input[m].N     = N;
-    args_input[m].BINS  = BINS;
-    long long ret = pthread_create(&id[m], NULL, kl_calc_thread, (void *)&args_input[m]);
-    if (ret) {
-      printf("Create No. %lld thread error!\n", m);
-      exit(1);
-    }
-    m++;
-  }
-
-  for (long long i = 0; i < m; i++) {
-    pthread_join(id[i], NULL);
-  }
-
-  long long m_min = the_min_index(kl, m);
-  float threshold = width * (m_min + 1) * BINS;
-  // printf("  threshold: %f, m: %lld, kl: %f, width: %f\n", threshold, m_min, kl[m_min], width);
-
-  delete[] hist;
-  delete[] kl;
-  delete[] id;
-  delete[] args_input;
-
-  return threshold;
+  std::vector<long long> hist(data, data + N);
+  long long m_min = kl_min_index(hist.data(), N, NULL);
+  return width * (m_min + 1) * BINS;
 }
-#endif
 
 float kl_diversity(float *data, long long count, long long num_bins) {
-#ifdef MULTI_THREAD_KL_CALC
-  return real_multi_thread_kl_diversity(data, count, num_bins);
-#else
-  return real_kl_diversity(data, count);
-#endif
+  return real_kl_diversity(data, count, num_bins);
 }
 
 float kl_diversity_hist(int *data, float width, long long num_bins) {
-  return real_multi_thread_kl_diversity_hist(data, width, num_bins);
+  return real_kl_diversity_hist(data, width, num_bins);
+}
+
+// thresholds of num histograms in one call, histogram k is
+// data[k * num_bins, (k + 1) * num_bins) with bin width widths[k]
+void kl_diversity_hist_batch(int *data, float *widths, long long num,
+                             long long num_bins, float *thresholds) {
+#pragma omp parallel for schedule(dynamic)
+  for (long long k = 0; k < num; k++) {
+    thresholds[k] =
+        real_kl_diversity_hist(data + k * num_bins, widths[k], num_bins);
+  }
 }
 }
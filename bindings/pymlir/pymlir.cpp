@@ -99,7 +99,10 @@ public:
     context_.reset();
   }
 
-  void load(std::string filename) {
+  // planned: share one arena among activations by liveness, only inputs,
+  // outputs and pinned tensors can be read after invoke
+  void load(std::string filename, bool planned = false,
+            std::vector<std::string> pinned = {}) {
     if (context_) {
       context_.reset();
     }
@@ -116,7 +119,10 @@ public:
     }
 
     interpreter_ = std::make_unique<ModuleInterpreter>(module_.get());
-    interpreter_->allocate_resources();
+    interpreter_->allocate_resources(
+        planned ? ModuleInterpreter::mem_mode_t::PLANNED_ARENA
+                : ModuleInterpreter::mem_mode_t::ALL_TENSOR_IN_MEM,
+        pinned);
     for (auto &name : interpreter_->input_names) {
       input_names.append(name);
     }
@@ -134,6 +140,12 @@ public:
     std::vector<std::string> ordered_names;
     auto &all_tensor_names = interpreter_->all_tensor_names;
     for (auto &tensor_name : all_tensor_names) {
+      if (!interpreter_->isTensorPinned(tensor_name)) {
+        // arena slots are reused by later ops, their data is stale here
+        throw std::runtime_error(
+            "get_all_tensor: tensor " + tensor_name +
+            " is not pinned, load with planned=False or pin it");
+      }
       ordered_names.emplace_back(tensor_name);
       tensorMap_[tensor_name] = interpreter_->getTensor(tensor_name);
       shapeMap_[tensor_name] = interpreter_->getTensorShape(tensor_name);
@@ -190,6 +202,9 @@ public:
   }
 
   void invoke() { interpreter_->invoke(); }
+  void set_inter_op_threads(int num) {
+    interpreter_->set_inter_op_threads(num);
+  }
   void fake_quant_weight() { interpreter_->fake_quant_weight(); }
 
   py::array invoke_at(const std::string name) {
@@ -200,6 +215,28 @@ public:
 
   void invoke_from(const std::string name) { interpreter_->invoke_from(name); }
 
+  void calib_stat_start(int bin_num) {
+    interpreter_->calib_stat_start(bin_num);
+  }
+  void calib_stat_histogram() { interpreter_->calib_stat_histogram(); }
+  void calib_stat_stop() { interpreter_->calib_stat_stop(); }
+
+  // name => (min, max, abs_max, width, histogram in int32)
+  py::dict get_calib_stat() {
+    py::dict py_ret;
+    for (auto &it : interpreter_->calib_stat()) {
+      auto &stat = it.second;
+      py::array_t<int32_t> hist(stat.hist.size());
+      auto hist_data = hist.mutable_data();
+      for (size_t i = 0; i < stat.hist.size(); i++) {
+        hist_data[i] = stat.hist[i];
+      }
+      py_ret[py::str(it.first)] = py::make_tuple(stat.min, stat.max,
+                                                 stat.abs_max, stat.width, hist);
+    }
+    return py_ret;
+  }
+
 public:
   py::list all_tensor_names;
   py::list input_names;
@@ -241,17 +278,28 @@ PYBIND11_MODULE(pymlir, m) {
 
   py::class_<py_module>(m, "module", "MLIR Module")
       .def(py::init<>())
-      .def("load", &py_module::load, "load module from IR")
+      .def("load", &py_module::load, "load module from IR, text or bytecode",
+           py::arg("filename"), py::arg("planned") = false,
+           py::arg("pinned") = std::vector<std::string>())
       .def("set_tensor", &py_module::set_tensor)
       .def("set_tensor_from_int", &py_module::set_tensor_from_int)
       .def("get_tensor", &py_module::get_tensor, "get one tensor data")
       .def("get_fp32_tensor", &py_module::get_fp32_tensor, "get one fp32 tensor data")
       .def("get_all_tensor", &py_module::getAllTensor, "dump all tensor data")
       .def("invoke", &py_module::invoke)
+      .def("set_inter_op_threads", &py_module::set_inter_op_threads,
+           "run independent ops concurrently in invoke")
       .def("fake_quant_weight", &py_module::fake_quant_weight)
       .def("invoke_at", &py_module::invoke_at, "invote at specified layer")
       .def("invoke_from", &py_module::invoke_from, "invote from specified layer to the end")
       .def("get_tensor_qinfo", &py_module::format_tensor_qinfo, "get simple quant info of tensor")
+      .def("calib_stat_start", &py_module::calib_stat_start,
+           "collect min/max of activations in the following invokes")
+      .def("calib_stat_histogram", &py_module::calib_stat_histogram,
+           "fix histogram widths by abs max, then collect histograms")
+      .def("calib_stat_stop", &py_module::calib_stat_stop)
+      .def("get_calib_stat", &py_module::get_calib_stat,
+           "get (min, max, abs_max, width, histogram) of activations")
       .def_readonly("input_names", &py_module::input_names)
       .def_readonly("output_names", &py_module::output_names)
       .def_readonly("all_tensor_names", &py_module::all_tensor_names)
@@ -42,6 +42,8 @@ public:
   static int64_t get_tensor_lmem_bytes(Value v, int64_t slice_n,
                                        int64_t slice_h, bool eu_align = true);
   static int64_t get_weight_lmem_bytes(Value v, bool eu_align = true);
+  // md5 of the loaded backend library file, "unknown" if it can't be read
+  static std::string get_lib_md5();
 
   template <typename FPtrTy> FPtrTy CastToFPtr(const char *symbolName) {
     assert(DL.isValid());
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "tpu_mlir/Backend/Arch.h"
+#include <mutex>
 
 #define MAX_CONV_IC (4095 - 32)
 #define MAX_TIU_CHL (4095 - 32)
@@ -1009,6 +1010,7 @@ class CV18xx : public Arch {
 public:
   static CV18xx &instance(module::Chip chip) {
     static CV18xx inst(chip);
+    main_ctx = &inst;
     cv18xx = &inst;
     return inst;
   }
@@ -1042,6 +1044,26 @@ public:
   static void dmabuf_convert(std::vector<uint8_t> &dmabuf);
   static void submit();
 
+  // Commands are generated into the cvikernel context bound to the calling
+  // thread: instance() binds the main one, a ScopedContext binds a private
+  // one for its lifetime, and other threads have none. Independent command
+  // buffers, e.g. of different routines, can then be generated on several
+  // threads at the same time.
+  class ScopedContext {
+  public:
+    ScopedContext();
+    ~ScopedContext();
+    ScopedContext(const ScopedContext &) = delete;
+    ScopedContext &operator=(const ScopedContext &) = delete;
+
+  private:
+    CV18xx *ctx;
+    CV18xx *prev;
+  };
+  // free the contexts kept for reuse by ScopedContext, each holds its own
+  // cvikernel command buffer
+  static void release_idle_contexts();
+
   static void parallel_enable() {
     cv18xx->cvk_ctx_->ops->parallel_enable(cv18xx->cvk_ctx_);
   }
@@ -1529,14 +1551,20 @@ protected:
                           uint32_t lmem_size, tiling_mode_t mode);
 
   CV18xx(module::Chip chip);
+  // a private cvikernel context sharing the library of main
+  explicit CV18xx(CV18xx *main);
   virtual ~CV18xx();
-  static CV18xx *cv18xx;
+  static CV18xx *main_ctx;
+  static thread_local CV18xx *cv18xx;
   void load_ctx(module::Chip chip);
   cvk_context_t *cvk_ctx_;
   uint8_t tdmaBaseSelects[MAX_GLOBAL_MEMORY_REGION];
   std::vector<uint8_t> cmdbuf_;
   std::vector<uint8_t> cvk_cmd_buf_;
   cvikernel_register dl_cvikernel_register;
+  // contexts released by ScopedContext, kept for reuse
+  std::vector<CV18xx *> idle_ctxs_;
+  std::mutex idle_mutex_;
 };
 
 } // namespace backend
@@ -14,6 +14,7 @@
 #include <fstream>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "tpu_mlir/Builder/BM168x/bmodel_generated.h"
 
@@ -58,6 +59,9 @@ class ModelGen {
   virtual ~ModelGen();
   flatbuffers::FlatBufferBuilder &Builder();
   Binary WriteBinary(size_t size, uint8_t *data);
+  // write binary data to a spill file instead of memory, it is copied behind
+  // flatbuffers when saved; call it before any WriteBinary
+  void SetBinaryStream(const std::string &spill_file);
 
   // add model elements
   void AddChip(const std::string &arch_name);
@@ -78,6 +82,7 @@ class ModelGen {
   bool IsTensorConflict(const flatbuffers::Vector<flatbuffers::Offset<Tensor>> *,
                         const flatbuffers::Vector<flatbuffers::Offset<Tensor>> *);
   bool IsShapeSame(const Shape *, const Shape *);
+  bool IsBinarySame(const Binary &binary, const uint8_t *data);
 
   typedef struct {
     std::string name;
@@ -87,7 +92,12 @@ class ModelGen {
   std::string chip_;
   flatbuffers::FlatBufferBuilder builder_;
   std::vector<uint8_t> binary_;
-  std::vector<Binary> binary_vector_;
+  uint64_t binary_size_;
+  // content hash => binaries with the hash, for dedup
+  std::unordered_multimap<uint64_t, Binary> binary_index_;
+  // spill file of binary data in stream mode
+  std::string binary_file_name_;
+  std::fstream binary_file_;
   std::vector<NET_INFO_T> net_vector_;
   std::vector<flatbuffers::Offset<bmodel::Net>> nets_;
   uint64_t max_neuron_size_;
@@ -12,6 +12,7 @@
 #include "tpu_mlir/Dialect/Tpu/Transforms/GmemAllocator.hpp"
 #include "tpu_mlir/Support/Module.h"
 #include <cstdint>
+#include <map>
 
 using namespace llvm;
 using namespace mlir;
@@ -27,6 +28,39 @@ public:
                                 PatternRewriter &rewriter) const override;
 };
 
-void populateWeightReorderPatterns(RewritePatternSet *patterns);
+// reordered coeff of an int8 conv, computed without touching the IR
+struct conv_int8_reorder_t {
+  int64_t use_3ic_optimize = -1; // attribute to set, -1 for none
+  bool merged = false;           // coeff holds requant, bias and filter
+  bool isINT4Conv = false;
+  bool has_bias = false;
+  int64_t oc = 0;
+  std::shared_ptr<std::vector<int8_t>> coeff;
+  std::vector<int64_t> shape;
+};
+typedef std::map<Operation *, conv_int8_reorder_t> conv_int8_prepared_t;
+
+// int8 conv takes the coeffs prepared by the pass, the ones not found there
+// are computed inline
+template <>
+class WeightReorder<tpu::Conv2DOp, int8_t>
+    : public OpRewritePattern<tpu::Conv2DOp> {
+public:
+  WeightReorder(MLIRContext *context, conv_int8_prepared_t *prepared = nullptr)
+      : OpRewritePattern<tpu::Conv2DOp>(context), prepared(prepared) {}
+  LogicalResult matchAndRewrite(tpu::Conv2DOp op,
+                                PatternRewriter &rewriter) const override;
+
+private:
+  conv_int8_prepared_t *prepared;
+};
+
+void populateWeightReorderPatterns(RewritePatternSet *patterns,
+                                   conv_int8_prepared_t *prepared = nullptr);
+
+// compute reordered coeffs of the int8 convs in the module ahead of the
+// patterns, which then only swap them into the IR; params and weights are
+// read on the calling thread, the reorders run on all threads
+void prepareWeightReorder(ModuleOp module, conv_int8_prepared_t &prepared);
 } // namespace bm1684x
 } // namespace tpu_mlir
@@ -84,13 +84,16 @@ public:
   CviTpuRoutine(flatbuffers::FlatBufferBuilder &fbb, func::CallOp &call,
                 int *layer_id, std::string chip);
   flatbuffers::Offset<Routine> build();
+  // generate cmdbuf into the cvikernel context of the calling thread
+  void codeGen();
 
   std::vector<uint8_t> cmdbuf;
 
 private:
-  int *layer_id;
-  void codeGen();
-  void codegen_for_group(tpu::GroupOp gOP);
+  int layer_id_start;
+  // return the next layer id; only count layer ids if dry_run
+  int codegen_ops(int layer_id, bool dry_run);
+  void codegen_for_group(tpu::GroupOp gOP, int &layer_id, bool dry_run);
 };
 
 class CviCpuRoutine : public CviRoutine {
@@ -140,6 +143,7 @@ private:
   std::vector<top::WeightOp> weights;
 
   void addRoutine(func::CallOp &call, int *layer_id);
+  void codegenRoutines(ModuleOp &module);
   FBModel build();
   FBWeightVector buildWeightMap();
   FBTensorVector buildNeuronMap();
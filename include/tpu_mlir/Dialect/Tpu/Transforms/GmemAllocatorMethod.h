@@ -83,6 +83,19 @@ public:
   updateGmemUsedStatistic(std::vector<ValueInfo> &ops,
                           std::map<ValueInfo, TensorLive> &liveRange);
 
+  // statistic and address dumps are split from assignGaddr so that
+  // methods can run concurrently and be reported in order afterwards
+  void printGmemUsedStatistic();
+
+  void printGaddr(std::vector<ValueInfo> &ops,
+                  std::map<ValueInfo, TensorLive> &liveRange,
+                  int64_t baseGaddr);
+
+  // check that no two tensors alive at the same time share an address,
+  // conflicting pairs are dumped and false is returned
+  bool verifyGaddr(std::vector<ValueInfo> &ops,
+                   std::map<ValueInfo, TensorLive> &liveRange);
+
   // static uint32_t getTensorGmemSize(Value &tensor, uint32_t aligment_);
 
 public:
@@ -92,6 +105,8 @@ protected:
   std::string name_;
   uint32_t aligment_;
   std::vector<std::list<GmemBlock>> album_;
+  int64_t totalGmemUsed_ = 0;
+  int64_t totalNeuronSize_ = 0;
 };
 
 class GmemAllocFitFirst : public GmemAllocatorMethod {
@@ -132,6 +147,41 @@ public:
                       bool neuronMemoryReuse, int64_t baseGaddr) override;
 };
 
+// Place each tensor at the offset of the smallest gap that fits among the
+// tensors alive at the same time. Tensors alive together are looked up in a
+// balanced interval index, so a graph of N tensors costs O(N log^2 N + K)
+// instead of scanning every allocated tensor per tensor.
+class GmemAllocBestFit : public GmemAllocatorMethod {
+public:
+  GmemAllocBestFit(std::map<ValueInfo, int64_t> &gaddrMap, uint32_t aligment);
+
+  int64_t assignGaddr(std::vector<ValueInfo> &ops,
+                      std::map<ValueInfo, TensorLive> &liveRange,
+                      bool neuronMemoryReuse, int64_t baseGaddr) override;
+
+protected:
+  // placement order of tensors, [lo, hi) is the live range on compressed
+  // positions and num_pos the count of positions
+  virtual std::vector<int> placeOrder(const std::vector<int> &lo,
+                                      const std::vector<int> &hi,
+                                      const std::vector<int64_t> &size,
+                                      int num_pos);
+};
+
+// Interval graph coloring by breadth: tensors alive at the position with the
+// largest total live size are placed first, larger tensors before smaller.
+class GmemAllocGreedyByBreadth : public GmemAllocBestFit {
+public:
+  GmemAllocGreedyByBreadth(std::map<ValueInfo, int64_t> &gaddrMap,
+                           uint32_t aligment);
+
+protected:
+  std::vector<int> placeOrder(const std::vector<int> &lo,
+                              const std::vector<int> &hi,
+                              const std::vector<int64_t> &size,
+                              int num_pos) override;
+};
+
 class GmemAllocatorMethodFactory {
 public:
   static GmemAllocatorMethod *makeMethod(std::string method_name,
@@ -143,6 +193,12 @@ public:
     } else if (method_name == "OpSizeOrderAssign") {
       return static_cast<GmemAllocatorMethod *>(
           new GmemAllocOpSizeOrder(gaddrMap, aligment));
+    } else if (method_name == "BestFitAssign") {
+      return static_cast<GmemAllocatorMethod *>(
+          new GmemAllocBestFit(gaddrMap, aligment));
+    } else if (method_name == "GreedyByBreadthAssign") {
+      return static_cast<GmemAllocatorMethod *>(
+          new GmemAllocGreedyByBreadth(gaddrMap, aligment));
     } else {
       assert(0);
       return nullptr;
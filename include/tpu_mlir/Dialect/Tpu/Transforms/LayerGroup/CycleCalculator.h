@@ -39,6 +39,11 @@ public:
   virtual int64_t getStoreCycle(Value v, const tensor_info_t &tensor_info,
                                 group_type_t group_type) = 0;
 
+  // cycles of backend queries are cached by signature in the process, and
+  // can be loaded from and saved to file to be reused by later compiles
+  static void loadCycleCache(const std::string &filename);
+  static void saveCycleCache(const std::string &filename);
+
 protected:
   void set_local_sec_info(local_sec_info_t &sec_info, Operation *op,
                           TensorInfo &tensor_infos, group_type_t group_type);
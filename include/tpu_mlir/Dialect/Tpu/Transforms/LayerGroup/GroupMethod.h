@@ -54,6 +54,7 @@ public:
 
   bool is_layer_group_valid(LgInfo &lg_info, bool calc_cost,
                             int64_t *group_cost);
+  bool is_layer_group_valid_cached(LgInfo &lg_info, int64_t *group_cost);
   bool group_one_layer_proc(const LgInfo &lg_info, bool calc_cost,
                             int64_t *group_cost);
   bool isLgSupport(Operation *op);
@@ -87,6 +88,9 @@ protected:
   std::shared_ptr<LmemAllocator> lmem_allocator_;
   std::shared_ptr<CycleCalculator> cycle_calculator_;
   std::vector<std::vector<int64_t>> cut_results_;
+  // (first op, last op) of group => (valid, cost)
+  llvm::DenseMap<std::pair<Operation *, Operation *>, std::pair<bool, int64_t>>
+      group_cost_cache_;
   int64_t group_cost_;
   int64_t MAX_COST;
   int64_t opt_;
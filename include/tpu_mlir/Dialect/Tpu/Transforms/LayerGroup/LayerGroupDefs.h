@@ -48,6 +48,7 @@ typedef std::pair<int64_t, int64_t> slice_pair_t; // idx and slice
 struct slice_info_t {
   std::vector<slice_pair_t> h; // h_idx and h_slice
   std::vector<slice_pair_t> n; // n_idx and n_slice
+  std::vector<slice_pair_t> w; // w_idx and w_slice
 };
 
 typedef struct mem_buffer_key {
@@ -122,6 +123,7 @@ typedef struct {
 typedef struct {
   int64_t nsecs;
   int64_t hsecs;
+  int64_t wsecs;
 } shape_secs_t;
 
 struct LgInfo {
@@ -10,12 +10,31 @@
 #pragma once
 
 #include "mlir/IR/OpDefinition.h"
+#include <memory>
+#include <vector>
 
 namespace tpu_mlir {
+// state of an op that only depends on its attributes and weights, built in
+// init() so that inference() does the compute only
+struct InferenceCache {
+  virtual ~InferenceCache() = default;
+};
+
 struct InferenceParameter {
   std::vector<float *> inputs;
   std::vector<float *> outputs;
   void *handle = nullptr;
+  // released in deinit() or with the parameter
+  std::unique_ptr<InferenceCache> cache;
+
+  template <typename T> T &make_cache() {
+    cache = std::make_unique<T>();
+    return static_cast<T &>(*cache);
+  }
+  template <typename T> T &get_cache() {
+    assert(cache != nullptr && "init() did not build the cache");
+    return static_cast<T &>(*cache);
+  }
 };
 
 } // namespace tpu_mlir
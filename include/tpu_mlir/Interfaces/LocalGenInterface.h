@@ -26,6 +26,8 @@ typedef struct {
   int64_t n_slice;
   int64_t h_idx;
   int64_t h_slice;
+  int64_t w_idx;
+  int64_t w_slice;
   int64_t id;
   int64_t stage;
   bool eu_align;
@@ -101,8 +101,8 @@ private:
   bool do_relu_ = false;
   float relu_limit_ = -1;
   algorithm algorithm_;
-  stream engine_stream;
   primitive binary_prim;
+  memory scratchpad_mem;
   memory lhs_mem;
   memory rhs_mem;
   memory dst_mem;
@@ -18,14 +18,18 @@ public:
   Conv();
   ~Conv();
   void filter_init(float *weight, conv_attr_t &attr);
+  // weight_is_coeff: filter and bias are constant, and are packed into the
+  // layout of the primitive once here instead of on every run
+  // src_dt: s8/u8 runs the int8 primitive with s8 filter, input and filter
+  // hold integer values in float, the output is the exact s32 accumulation
   void setup(float *input, float *weight, float *bias, float *output,
-             conv_attr_t attr);
+             conv_attr_t attr, bool weight_is_coeff = true,
+             memory::data_type src_dt = memory::data_type::f32);
   void run();
 private:
   void pad_init(float *input, conv_attr_t &attr);
 private:
   engine eng;
-  stream eng_stream;
   std::vector<primitive> net;
   std::vector<std::unordered_map<int, memory>> net_args;
   convolution_forward::primitive_desc conv_prim_desc;
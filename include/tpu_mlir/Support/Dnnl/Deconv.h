@@ -32,7 +32,6 @@ public:
 
 private:
   engine eng;
-  stream eng_stream;
   std::vector<primitive> net;
   std::vector<std::unordered_map<int, memory>> net_args;
   deconvolution_forward::primitive_desc deconv_prim_desc;
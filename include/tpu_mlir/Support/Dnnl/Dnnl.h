@@ -21,5 +21,12 @@
 namespace tpu_mlir {
 
 dnnl::memory::data_type getDnnlType(mlir::Value v);
+// s8/u8 when input and weight can run on the oneDNN int8 primitives,
+// otherwise f32. Both paths write f32 output: the int8 path rounds its exact
+// s32 sum once, the f32 path rounds while accumulating. K is the reduction
+// length, so the int8 path is only taken while K * max|x| * max|w| + max|bias|
+// stays below 2^24, where both paths are exact and agree bit by bit.
+dnnl::memory::data_type getDnnlInt8Type(mlir::Value input, mlir::Value weight,
+                                        int64_t K, mlir::Value bias);
 
 }
@@ -10,8 +10,50 @@
 
 #pragma once
 #include "oneapi/dnnl/dnnl.hpp"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
 using namespace dnnl;
 namespace tpu_mlir {
 
 void post_relu(primitive_attr &attr, bool &do_relu, double &relu_limit);
+
+// cpu engine shared by all dnnl wrappers
+engine &dnnl_engine();
+// stream of the calling thread, ops may run on several threads
+stream &dnnl_stream();
+
+// Primitives are cached process wide, keyed by the bytes of the operation
+// desc (shapes, formats, strides, pads ...) plus the primitive attributes
+// (post-ops), so repeated shapes and reloads of the same model skip the
+// primitive creation.
+std::string dnnl_cache_key(const void *data, size_t size);
+std::string dnnl_cache_key(const primitive_attr &attr);
+template <typename desc_t> std::string dnnl_cache_key(const desc_t &desc) {
+  return dnnl_cache_key(&desc.data, sizeof(desc.data));
+}
+void dnnl_cache_record(bool hit);
+void dnnl_cache_stat(int64_t &hit, int64_t &miss);
+
+template <typename prim_t>
+prim_t dnnl_primitive(
+    const std::string &key,
+    const std::function<typename prim_t::primitive_desc()> &create,
+    typename prim_t::primitive_desc *pd = nullptr) {
+  using pd_t = typename prim_t::primitive_desc;
+  static std::mutex mutex;
+  static std::map<std::string, std::pair<pd_t, prim_t>> cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iter = cache.find(key);
+  dnnl_cache_record(iter != cache.end());
+  if (iter == cache.end()) {
+    auto new_pd = create();
+    iter = cache.emplace(key, std::make_pair(new_pd, prim_t(new_pd))).first;
+  }
+  if (pd != nullptr) {
+    *pd = iter->second.first;
+  }
+  return iter->second.second;
+}
 } // namespace tpu_mlir
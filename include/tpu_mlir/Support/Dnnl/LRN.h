@@ -63,8 +63,8 @@ private:
   float alpha_, beta_, bias_;
   algorithm algorithm_;
   int64_t size_;
-  stream engine_stream;
   primitive lrn_prim;
+  memory scratchpad_mem;
   memory src_mem;
   memory dst_mem;
 };
@@ -19,16 +19,23 @@ public:
                   int64_t K, int64_t N, bool right_transpose);
   void input_init(float *input, int64_t input_zp, int64_t batch,
                   int64_t M, int64_t K);
+  // right_is_coeff: right and bias are constant, and are transposed, zero
+  // point adjusted and packed into the layout of the primitive once here
+  // instead of on every run
+  // left_dt: s8/u8 runs the int8 primitive with s8 right, the output is the
+  // exact s32 accumulation
   void setup(float *left, float *right, float *bias, float *output,
              int64_t batch, int64_t M, int64_t K, int64_t N, bool do_relu,
              double relu_limit, int64_t right_zp, bool right_transpose,
-             int64_t input_zp);
+             int64_t input_zp, bool right_is_coeff = false,
+             memory::data_type left_dt = memory::data_type::f32);
 
   void run();
 
 private:
+  void right_prepare();
+
   engine eng;
-  stream engine_stream;
   std::vector<primitive> net;
   std::vector<std::unordered_map<int, memory>> net_args;
   std::shared_ptr<std::vector<float>> bias0;
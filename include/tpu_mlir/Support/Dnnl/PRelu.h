@@ -46,10 +46,10 @@ public:
   void run();
 private:
   engine eng;
-  stream eng_stream;
   memory::dims src_shape;
   memory::dims dst_shape;
   primitive prelu_prim;
+  memory scratchpad_mem;
   memory src_mem;
   memory weights_mem;
   memory dst_mem;
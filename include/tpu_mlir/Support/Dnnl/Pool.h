@@ -19,8 +19,10 @@ class Pooling {
 public:
   Pooling();
   ~Pooling();
+  // dt: s8/u8 pools integer values held in float on int8 data, the input
+  // and output are reordered from and to f32
   void setup(float *input, float *output, pool_attr_t attr, bool is_avg,
-             int izp = 0);
+             int izp = 0, memory::data_type dt = memory::data_type::f32);
   void run();
 
 private:
@@ -31,7 +33,6 @@ public:
 
 private:
   engine eng;
-  stream eng_stream;
   std::vector<primitive> net;
   std::vector<std::unordered_map<int, memory>> net_args;
   pooling_forward::primitive_desc prim_desc;
@@ -20,6 +20,10 @@ uint16_t f32_to_f16(float src);
 uint16_t f32_to_bf16(float src, bool is_tpu = true);
 float f16_to_f32(uint16_t src);
 float bf16_to_f32(uint16_t src);
+// bulk version of f32_to_f16/f32_to_bf16
+void f32_to_f16(const float *p_src, uint16_t *p_dst, int64_t num);
+void f32_to_bf16(const float *p_src, uint16_t *p_dst, int64_t num,
+                 bool is_tpu = true);
 
 /*
 convert to f32 float to f16/bf16 float
@@ -119,6 +119,16 @@ int64_t applyMultiplierAndRShift(
     int64_t v, int64_t multiplier, int64_t rshift,
     tpu::RequantMode qmode = tpu::RequantMode::MultiplierShift,
     RoundingMode rmode=ROUNDING_HALF_UP);
+// requant int8 sums in place, the same as
+//   v = applyMultiplierAndRShift(data[i] + bias, multiplier, rshift, qmode,
+//                                rmode) + zero_point;
+//   data[i] = saturate(do_relu && v < 0 ? 0 : v, out_type);
+// MultiplierShift and OnlyShift with ROUNDING_HALF_UP run as a vector loop,
+// other modes and CV18xx run the scalar one
+void requant_int8(float *data, int64_t num, int32_t bias, int64_t multiplier,
+                  int64_t rshift, int64_t zero_point, bool do_relu,
+                  mlir::Type out_type, tpu::RequantMode qmode,
+                  RoundingMode rmode = ROUNDING_HALF_UP);
 
 void pad_tensor(float *p_after_pad, float *src, int n, int c, int h, int w,
                 int pt, int pb, int pl, int pr, float pad_value);
@@ -174,9 +184,10 @@ bool permute_reset(const std::vector<int64_t> &shape,
                    const std::vector<int64_t> &order,
                    std::vector<int64_t> &to_shape,
                    std::vector<int64_t> &to_order, int to_dim);
+// permute tensor of any dims; float/int8/uint8/uint16/int32 are instantiated
 template <typename T>
-void function_permute(T *from, T *to, const std::vector<int64_t> &shape_5,
-                      const std::vector<int64_t> &order_5);
+void function_permute(T *from, T *to, const std::vector<int64_t> &shape,
+                      const std::vector<int64_t> &order);
 
 // compare
 bool compare(float lhs, float rhs, llvm::StringRef mode);
@@ -16,13 +16,16 @@
 
 #include "tpu_mlir/Interfaces/InferenceInterface.h"
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
 
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
 
 #define DEBUG_TYPE "interpreter"
@@ -33,11 +36,24 @@ namespace tpu_mlir {
 class ModuleInterpreter {
 
 public:
+  // How activation buffers are held on the host
+  enum class mem_mode_t {
+    // every activation owns a buffer for the whole run
+    ALL_TENSOR_IN_MEM,
+    // activations share one arena, offsets reused by liveness; only inputs,
+    // outputs and pinned tensors keep their own buffer
+    PLANNED_ARENA,
+  };
+
   // Interpret the given MLIR module expressed in MLIR TPU IR dialect
   explicit ModuleInterpreter(ModuleOp module);
   virtual ~ModuleInterpreter();
-  void allocate_resources();
+  void allocate_resources(mem_mode_t mode = mem_mode_t::ALL_TENSOR_IN_MEM,
+                          const std::vector<std::string> &pinned = {});
   void invoke(bool express_type = true);
+  // run up to `num` independent ops of invoke concurrently, OMP threads of
+  // each op are divided among them; 1 means run ops one by one in walk order
+  void set_inter_op_threads(int num);
   void fake_quant_weight();
   std::shared_ptr<std::vector<float>> invoke_at(std::string name);
   void invoke_from(const std::string op_name);
@@ -46,6 +62,29 @@ public:
   std::shared_ptr<std::vector<float>> getTensor(const std::string &name, bool express_type = false);
   bool getTensorQuantInfo(const std::string name, std::string &dtype, float &scale, int &zp);
   llvm::ArrayRef<int64_t> getTensorShape(const std::string &name);
+  // false if the tensor lives in the arena and is overwritten by later ops
+  bool isTensorPinned(const std::string &name);
+
+  // Calibration statistics of activations, updated right after each op of
+  // invoke(), so only the final tables leave the interpreter
+  struct tensor_stat_t {
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    float abs_max = 0.0f;
+    // bin width of hist, fixed by calib_stat_histogram()
+    float width = 0.0f;
+    // counts of round(|x| / width), zeros excluded
+    std::vector<int64_t> hist;
+  };
+  // start collecting min/max/abs_max of every activation
+  void calib_stat_start(int bin_num);
+  // fix the bin width of each activation by its abs_max so far, then
+  // collect histograms in the following invokes
+  void calib_stat_histogram();
+  void calib_stat_stop();
+  const std::map<std::string, tensor_stat_t> &calib_stat() const {
+    return stat_map;
+  }
 
 public:
   std::vector<std::string> input_names;
@@ -54,11 +93,34 @@ public:
       all_tensor_names; // activation tensor, without weight
   std::vector<std::string> all_weight_names; // weight tensor
 
+private:
+  // plan arena offsets for the activations not pinned in mem_map
+  void plan_arena(const std::map<std::string, int64_t> &counts,
+                  const std::map<std::string, std::pair<int64_t, int64_t>>
+                      &live_range);
+  float *getTensorPtr(const std::string &name, int64_t &count);
+  // run ops of func as a dataflow graph on thread pool
+  void invoke_parallel(func::FuncOp func);
+  // update calibration statistics of the results of op
+  void update_stat(Operation *op);
+
 private:
   ModuleOp module;
+  mem_mode_t mem_mode;
+  int inter_op_threads;
+  std::unique_ptr<llvm::ThreadPool> pool;
   std::map<std::string, Value> value_map;
   std::map<std::string, std::shared_ptr<InferenceParameter>> inference_map;
   std::map<std::string, std::shared_ptr<std::vector<float>>> mem_map;
+  // PLANNED_ARENA only: name => (offset, count) in arena, in floats
+  std::map<std::string, std::pair<int64_t, int64_t>> arena_map;
+  std::vector<float> arena;
+  enum class stat_stage_t { NONE, MINMAX, HISTOGRAM };
+  stat_stage_t stat_stage = stat_stage_t::NONE;
+  // entries are created before invoke, ops only update their own ones
+  std::map<std::string, tensor_stat_t> stat_map;
+  // histogram bin of each rounded |x| / width
+  std::vector<int> stat_bin_of;
 };
 
 } // namespace tpu_mlir
@@ -47,8 +47,14 @@ void compressBf16Data(
     const uint8_t *ibuf, int isz, uint8_t *obuf, int *osz,
     CompressCommandInfo *cmd_info);
 
-// unit test
-void testCompress(void);
+// decompress to osz bytes, cmd_info is read from the header
+void decompressInt8Data(
+    const uint8_t *ibuf, int isz, uint8_t *obuf, int osz,
+    CompressCommandInfo *cmd_info);
+
+void decompressBf16Data(
+    const uint8_t *ibuf, int isz, uint8_t *obuf, int osz,
+    CompressCommandInfo *cmd_info);
 
 class WeightCompresser {
 public:
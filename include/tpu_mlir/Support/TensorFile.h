@@ -19,17 +19,21 @@
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/Support/LogicalResult.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <atomic>
+#include <cstdio>
 #include <ctime>
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <string>
 #include <system_error>
 #include <type_traits>
+#include <unordered_map>
 
 #include <iomanip>
 template <typename T> static std::string int_to_hex(T i) {
@@ -122,7 +126,10 @@ public:
       return failure();
     }
     arr.fortran_order = false;
-    memcpy(arr.data_holder->data(), data, arr.num_bytes());
+    memcpy(arr.data<char>(), data, arr.num_bytes());
+    // codegen may update different tensors from several threads
+    std::lock_guard<std::mutex> lock(update_mutex);
+    changed_names.insert(name.str());
     cnt_update++;
     return success();
   }
@@ -147,6 +154,7 @@ public:
       shape_npz.push_back((size_t)*it);
     }
     cnpy::npz_add_array(map, name.str(), &data[0], shape_npz);
+    changed_names.insert(name.str());
     cnt_add++;
     return success();
   }
@@ -177,6 +185,7 @@ public:
       shape_npz.push_back((size_t)*it);
     }
     cnpy::npz_add_array(map, name.str(), &data[0], shape_npz);
+    changed_names.insert(name.str());
     cnt_add++;
     return success();
   }
@@ -199,7 +208,7 @@ public:
       llvm_unreachable("readTensor failed");
       return failure();
     }
-    auto arr = it->second;
+    const auto &arr = it->second;
     if (arr.num_bytes() != count * sizeof(T)) {
       llvm::errs() << "size does not match for tensor " << name.str() << "\n";
       llvm_unreachable("readTensor failed");
@@ -211,7 +220,7 @@ public:
       colMajorToRowMajor(data_holder, arr);
     } else {
       int cpy_bytes = isINT4 ? (count+1)/2 : arr.num_bytes();
-      memcpy(data, arr.data_holder->data(), cpy_bytes);
+      memcpy(data, arr.data<char>(), cpy_bytes);
     }
     return success();
   }
@@ -231,6 +240,39 @@ public:
     return data;
   }
 
+  /// view a tensor in place without copy, data is mapped from file if the
+  /// tensor is stored uncompressed; the view is valid until the tensor is
+  /// updated or deleted
+  template <typename T>
+  llvm::ArrayRef<T> readTensorView(llvm::StringRef name,
+                                   RankedTensorType &type) {
+    auto count = type.getNumElements();
+    bool isINT4 = type.getElementType().isInteger(4);
+    if (!isINT4) {
+      assert(check_type<T>(type.getElementType()) == true);
+    }
+    auto it = map.find(name.str());
+    if (it == map.end()) {
+      llvm::errs() << "failed to find tensor " << name.str() << " to read\n";
+      llvm_unreachable("readTensorView failed");
+    }
+    auto &arr = it->second;
+    if (arr.num_bytes() != count * sizeof(T)) {
+      llvm::errs() << "size does not match for tensor " << name.str() << "\n";
+      llvm_unreachable("readTensorView failed");
+    }
+    if (arr.fortran_order) {
+      // convert to row major once, content is not changed
+      auto data_holder = std::make_shared<std::vector<char>>(arr.num_bytes());
+      colMajorToRowMajor(*data_holder, arr);
+      arr.data_holder = data_holder;
+      arr.mapped_data.reset();
+      arr.fortran_order = false;
+    }
+    const auto &carr = arr;
+    return llvm::ArrayRef<T>(carr.data<T>(), isINT4 ? (count + 1) / 2 : count);
+  }
+
   /// delete a tensor from file
   /// if the name is not found, return failure()
   LogicalResult deleteTensor(const llvm::StringRef name) {
@@ -243,10 +285,28 @@ public:
       return failure();
     }
     map.erase(it);
+    changed_names.erase(name.str());
     cnt_del++;
     return success();
   }
 
+  /// return an unused tensor name, "<prefix>_<suffix>" if it is free, else
+  /// "<prefix>_<index>_<suffix>"; the next index to try is kept per name, so
+  /// repeated requests don't rescan the taken ones
+  std::string getUniqueName(llvm::StringRef prefix, llvm::StringRef suffix) {
+    std::string name = prefix.str() + "_" + suffix.str();
+    if (map.find(name) == map.end()) {
+      return name;
+    }
+    auto &index = name_index[name];
+    std::string new_name;
+    do {
+      new_name =
+          prefix.str() + "_" + std::to_string(++index) + "_" + suffix.str();
+    } while (map.find(new_name) != map.end());
+    return new_name;
+  }
+
   void getAllNames(std::set<StringRef> &names) {
     for (auto &name : map) {
       names.insert(name.first);
@@ -259,12 +319,12 @@ public:
                                std::vector<std::vector<T> *> &tensors,
                                std::vector<std::vector<int64_t>> &shapes) {
     for (auto it = map.begin(); it != map.end(); it++) {
-      auto arr = it->second;
+      const auto &arr = it->second;
       assert(arr.type == 'f'); // support float only for now
       assert(arr.word_size == sizeof(float));
       auto count = arr.num_bytes() / arr.word_size;
       std::vector<T> *tensor = new std::vector<T>(count);
-      memcpy(tensor->data(), arr.data_holder->data(), arr.num_bytes());
+      memcpy(tensor->data(), arr.data<char>(), arr.num_bytes());
       tensors.push_back(tensor);
       std::vector<int64_t> shape(arr.shape.size());
       shape.assign(arr.shape.begin(), arr.shape.end());
@@ -279,6 +339,10 @@ public:
 
   bool changed() { return cnt_update + cnt_add + cnt_del > 0; }
 
+  /// rewrite the whole file on next save, dropping the space of deleted or
+  /// updated tensors
+  void compact() { need_compact = true; }
+
   template <typename T>
   void colMajorToRowMajor(T &des, const cnpy::NpyArray &src) {
     static_assert(std::is_same<typename T::value_type, char>::value,
@@ -295,10 +359,15 @@ public:
         ind_n = (ind_n - sub_n) / n; // ind(n+1) = (ind(n) - sub(n)) / n
       }
       memcpy(des.data() + des_offset * word_size,
-             src.data_holder->data() + src_offset * word_size, word_size);
+             src.data<char>() + src_offset * word_size, word_size);
     }
   }
 
+  /// save tensors to file
+  /// if the file was loaded or saved before under the same name, or can be
+  /// reflinked to the new name, only added or updated tensors are appended
+  /// to it, and the whole file is rewritten once more than half of it is
+  /// unreferenced; otherwise the whole file is written
   void save(const std::string &file = "") {
     assert(!readOnly);
     bool same_name = true;
@@ -306,7 +375,7 @@ public:
       same_name = false;
       filename = file;
     }
-    if (cnt_add + cnt_del + cnt_update == 0 && same_name) {
+    if (cnt_add + cnt_del + cnt_update == 0 && same_name && !need_compact) {
       return;
     }
     for (auto &it : map) {
@@ -316,11 +385,26 @@ public:
             new std::vector<char>(array.num_bytes()));
         colMajorToRowMajor(*data_holder.get(), array);
         array.data_holder = data_holder;
+        array.mapped_data.reset();
         array.fortran_order = false;
       }
     }
 
-    cnpy::npz_save_all(filename, map);
+    if (disk_file.empty() || map.empty() || need_compact ||
+        !append()) {
+      // tensors may still be mapped from filename, so write aside and then
+      // replace it; the old mapping stays valid after rename
+      auto tmp_file = filename + ".tmp";
+      cnpy::npz_save_all(tmp_file, map);
+      if (!map.empty() &&
+          std::rename(tmp_file.c_str(), filename.c_str()) != 0) {
+        llvm::errs() << "failed to save " << filename << "\n";
+        llvm_unreachable("TensorFile save error!");
+      }
+    }
+    disk_file = map.empty() ? "" : filename;
+    changed_names.clear();
+    need_compact = false;
     cnt_add = 0;
     cnt_del = 0;
     cnt_update = 0;
@@ -328,19 +412,44 @@ public:
   }
 
 private:
-  /// load the file
+  /// load the file, uncompressed tensors are mapped instead of read
   LogicalResult load(void) {
-    map = cnpy::npz_load(filename);
+    map = cnpy::npz_load_mmap(filename);
     if (map.size() > 0) {
+      disk_file = filename;
       return success();
     } else {
       return failure();
     }
   }
 
+  /// append changed tensors to the file last loaded or saved; return false
+  /// if the file should be rewritten instead. Pipeline stages save to a new
+  /// file and keep the previous one for its mlir, so the file is reflinked
+  /// to filename first, and it is rewritten where reflink is not supported.
+  bool append() {
+    if (disk_file != filename && !cnpy::npz_reflink(disk_file, filename)) {
+      return false;
+    }
+    size_t dead_bytes = cnpy::npz_append_all(filename, map, changed_names);
+    uint64_t file_bytes = 0;
+    if (llvm::sys::fs::file_size(filename, file_bytes)) {
+      return false;
+    }
+    return dead_bytes * 2 <= file_bytes;
+  }
+
   std::string filename;
   bool readOnly;
   cnpy::npz_t map;
+  /// the file holding unchanged tensors of map, empty if none
+  std::string disk_file;
+  /// tensors added or updated since last load or save
+  std::set<std::string> changed_names;
+  std::mutex update_mutex;
+  /// last index used by getUniqueName for each taken name
+  std::unordered_map<std::string, int64_t> name_index;
+  bool need_compact = false;
   std::atomic<int> cnt_del = {0};
   std::atomic<int> cnt_add = {0};
   std::atomic<int> cnt_update = {0};
@@ -15,8 +15,11 @@
 #include "tpu_mlir/Interfaces/LocalGenInterface.h"
 #include "tpu_mlir/Support/MathUtils.h"
 #include "tpu_mlir/Support/Module.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
+#include <dlfcn.h>
+#include <link.h>
 
 using namespace tpu_mlir::backend;
 
@@ -124,6 +127,31 @@ int64_t Arch::get_weight_lmem_bytes(Value v, bool eu_align) {
   return (int64_t)n * c_per_npu * eu_aligned * dbytes;
 }
 
+std::string Arch::get_lib_md5() {
+  // the library is loaded once per process, so is its md5
+  static std::string md5 = []() -> std::string {
+    if (LIB_NAME.empty()) {
+      return "unknown";
+    }
+    // ask the loader where the loaded library was found
+    void *handle = dlopen(LIB_NAME.data(), RTLD_LAZY | RTLD_NOLOAD);
+    if (handle == nullptr) {
+      return "unknown";
+    }
+    std::string result = "unknown";
+    struct link_map *map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) == 0 && map != nullptr) {
+      auto hash = llvm::sys::fs::md5_contents(map->l_name);
+      if (hash) {
+        result = hash->digest().str().str();
+      }
+    }
+    dlclose(handle);
+    return result;
+  }();
+  return md5;
+}
+
 Arch::~Arch() {}
 
 void Arch::load_library() {
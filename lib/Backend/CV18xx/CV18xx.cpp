@@ -10,6 +10,7 @@
 #include "tpu_mlir/Backend/CV18xx/CV18xx.h"
 #include "tpu_mlir/Interfaces/LocalGenInterface.h"
 #include "tpu_mlir/Support/Module.h"
+#include "omp.h"
 #include <iostream>
 #include <llvm/Support/Debug.h>
 #include <llvm/Support/Format.h>
@@ -20,7 +21,8 @@
 
 namespace tpu_mlir {
 namespace backend {
-CV18xx *CV18xx ::cv18xx = nullptr;
+CV18xx *CV18xx::main_ctx = nullptr;
+thread_local CV18xx *CV18xx::cv18xx = nullptr;
 void CV18xx::write_cmdbuf(const void *cmdbuf, uint32_t size) {
   cv18xx->cmdbuf_.resize(size);
   memcpy(&cv18xx->cmdbuf_[0], cmdbuf, size);
@@ -40,6 +42,46 @@ void CV18xx::dmabuf_convert(std::vector<uint8_t> &dmabuf) {
                                         cv18xx->cmdbuf_.size(), dmabuf.data());
 }
 
+CV18xx::ScopedContext::ScopedContext() : ctx(nullptr), prev(cv18xx) {
+  {
+    std::lock_guard<std::mutex> lock(main_ctx->idle_mutex_);
+    if (!main_ctx->idle_ctxs_.empty()) {
+      ctx = main_ctx->idle_ctxs_.back();
+      main_ctx->idle_ctxs_.pop_back();
+    }
+  }
+  if (ctx == nullptr) {
+    ctx = new CV18xx(main_ctx);
+  }
+  cv18xx = ctx;
+}
+
+CV18xx::ScopedContext::~ScopedContext() {
+  ctx->cvk_ctx_->ops->reset(ctx->cvk_ctx_);
+  ctx->cmdbuf_.clear();
+  cv18xx = prev;
+  {
+    // each context reserves a full cmdbuf, keep no more than one per thread
+    std::lock_guard<std::mutex> lock(main_ctx->idle_mutex_);
+    if ((int)main_ctx->idle_ctxs_.size() < omp_get_max_threads()) {
+      main_ctx->idle_ctxs_.push_back(ctx);
+      return;
+    }
+  }
+  delete ctx;
+}
+
+void CV18xx::release_idle_contexts() {
+  std::vector<CV18xx *> ctxs;
+  {
+    std::lock_guard<std::mutex> lock(main_ctx->idle_mutex_);
+    ctxs.swap(main_ctx->idle_ctxs_);
+  }
+  for (auto ctx : ctxs) {
+    delete ctx;
+  }
+}
+
 void CV18xx::submit() {
   uint32_t size;
   uint8_t *cmdbuf =
@@ -680,11 +722,19 @@ CV18xx::CV18xx(module::Chip chip) {
   LMEM_BANK_BYTES = LMEM_BYTES / LMEM_BANKS;
 }
 
+CV18xx::CV18xx(CV18xx *main) {
+  DL = main->DL;
+  load_ctx(chip);
+}
+
 CV18xx::~CV18xx() {
-  cv18xx->cvk_ctx_->ops->cleanup(cv18xx->cvk_ctx_);
+  for (auto ctx : idle_ctxs_) {
+    delete ctx;
+  }
+  cvk_ctx_->ops->cleanup(cvk_ctx_);
   cvk_cmd_buf_.clear();
   cvk_cmd_buf_.shrink_to_fit();
-  free(cv18xx->cvk_ctx_);
+  free(cvk_ctx_);
 }
 
 cvk_fmt_t CV18xx::getDataType(mlir::Type type) {
@@ -10,6 +10,7 @@
 
 #include "tpu_mlir/Builder/BM168x/bmodel.hpp"
 #include <memory.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <ctime>
 #include <iostream>
@@ -47,6 +48,7 @@ const uint32_t BMODEL_MAGIC = 0xFF55AAEE;
 ModelGen::ModelGen(uint32_t reserved_size)
 {
   binary_.reserve(reserved_size);
+  binary_size_ = 0;
   max_neuron_size_ = 0;
 }
 
@@ -58,24 +60,76 @@ FlatBufferBuilder &ModelGen::Builder()
 ModelGen::~ModelGen()
 {
   builder_.Release();
+  if (!binary_file_name_.empty()) {
+    binary_file_.close();
+    remove(binary_file_name_.c_str());
+  }
+}
+
+void ModelGen::SetBinaryStream(const string &spill_file)
+{
+  ASSERT(!spill_file.empty() && binary_size_ == 0);
+  binary_file_.open(spill_file, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!binary_file_) {
+    BMODEL_LOG(FATAL) << "Open file[" << spill_file << "] failed." << std::endl;
+    exit(-1);
+  }
+  binary_file_name_ = spill_file;
+  vector<uint8_t>().swap(binary_);
+}
+
+// hash of binary content, only used to find dedup candidates
+static uint64_t HashBinary(const uint8_t *data, size_t size)
+{
+  const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+  uint64_t hash = size * prime;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    hash = (hash ^ (word * prime)) * prime;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * prime;
+  }
+  return hash ^ (hash >> 32);
+}
+
+bool ModelGen::IsBinarySame(const Binary &binary, const uint8_t *data)
+{
+  if (binary_file_name_.empty()) {
+    return memcmp(data, binary_.data() + binary.start(), binary.size()) == 0;
+  }
+  vector<uint8_t> buffer(binary.size());
+  binary_file_.seekg(binary.start(), std::ios::beg);
+  binary_file_.read((char *)buffer.data(), binary.size());
+  ASSERT(binary_file_);
+  return memcmp(data, buffer.data(), binary.size()) == 0;
 }
 
 Binary ModelGen::WriteBinary(size_t size, uint8_t *data)
 {
   // ASSERT(size != 0 && data != NULL);
-  for (auto &binary : binary_vector_) {
-    if (binary.size() != size) {
-      continue;
-    }
-    if (memcmp(data, binary_.data() + binary.start(), size) == 0) {
-      return binary;
+  uint64_t hash = HashBinary(data, size);
+  auto range = binary_index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.size() == size && IsBinarySame(it->second, data)) {
+      return it->second;
     }
   }
-  uint64_t start = binary_.size();
-  binary_.insert(binary_.end(), size, 0);
-  memcpy(binary_.data() + start, data, size);
+  uint64_t start = binary_size_;
+  if (binary_file_name_.empty()) {
+    binary_.insert(binary_.end(), size, 0);
+    memcpy(binary_.data() + start, data, size);
+  } else {
+    binary_file_.seekp(start, std::ios::beg);
+    binary_file_.write((char *)data, size);
+    ASSERT(binary_file_);
+  }
+  binary_size_ += size;
   Binary new_bin(start, size);
-  binary_vector_.push_back(new_bin);
+  binary_index_.emplace(hash, new_bin);
   return new_bin;
 }
 
@@ -267,7 +321,7 @@ size_t ModelGen::Finish()
   builder_.Finish(model);
 
   // return size
-  size_t size = sizeof(MODEL_HEADER_T) + builder_.GetSize() + binary_.size();
+  size_t size = sizeof(MODEL_HEADER_T) + builder_.GetSize() + binary_size_;
   return size;
 }
 
@@ -289,10 +343,16 @@ void ModelGen::Save(const string &filename)
   header.magic = BMODEL_MAGIC;
   header.header_size = sizeof(header);
   header.flatbuffers_size = builder_.GetSize();
-  header.binary_size = binary_.size();
+  header.binary_size = binary_size_;
   fout.write((char *)&header, sizeof(header));
   fout.write((char *)builder_.GetBufferPointer(), builder_.GetSize());
-  fout.write((char *)binary_.data(), binary_.size());
+  if (binary_file_name_.empty()) {
+    fout.write((char *)binary_.data(), binary_.size());
+  } else if (binary_size_ > 0) {
+    binary_file_.flush();
+    binary_file_.seekg(0, std::ios::beg);
+    fout << binary_file_.rdbuf();
+  }
   fout.close();
 }
 
@@ -304,11 +364,18 @@ void ModelGen::Save(void *buffer)
   p_header->magic = BMODEL_MAGIC;
   p_header->header_size = sizeof(MODEL_HEADER_T);
   p_header->flatbuffers_size = builder_.GetSize();
-  p_header->binary_size = binary_.size();
+  p_header->binary_size = binary_size_;
   uint8_t *p_flb = (uint8_t *)buffer + p_header->header_size;
   memcpy(p_flb, builder_.GetBufferPointer(), p_header->flatbuffers_size);
   uint8_t *p_binary = p_flb + p_header->flatbuffers_size;
-  memcpy(p_binary, binary_.data(), p_header->binary_size);
+  if (binary_file_name_.empty()) {
+    memcpy(p_binary, binary_.data(), p_header->binary_size);
+  } else {
+    binary_file_.flush();
+    binary_file_.seekg(0, std::ios::beg);
+    binary_file_.read((char *)p_binary, binary_size_);
+    ASSERT(binary_file_);
+  }
 }
 
 ModelCtx::ModelCtx(const string &filename) : model_gen_(NULL), model_(NULL), bmodel_pointer_(NULL)
@@ -98,7 +98,8 @@ int64_t top::ConvOp::getFLOPs() {
 LogicalResult top::ConvOp::init(InferenceParameter &p) {
   auto conv = new Conv();
   auto attr = parseParam();
-  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr);
+  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr,
+              module::isWeight(getFilter()));
   p.handle = (void *)conv;
   return success();
 }
@@ -89,62 +89,32 @@ static void gru_compute(InferenceParameter &p, const gru_attr_t &attr,
     last_h += attr.batch_size * attr.hidden_size;
   }
   float *prev_hidden_state = h;
-  float *x_wr = x_wz + attr.input_size * attr.hidden_size;
-  float *x_wh = x_wr + attr.input_size * attr.hidden_size;
-
-  float *x_br = x_bz + attr.hidden_size;
-  float *x_bh = x_br + attr.hidden_size;
-
-  float *h_wr = h_wz + attr.hidden_size * attr.hidden_size;
-  float *h_wh = h_wr + attr.hidden_size * attr.hidden_size;
-
   float *h_bz = x_bz + 3 * attr.hidden_size;
-  float *h_br = h_bz + attr.hidden_size;
-  float *h_bh = h_br + attr.hidden_size;
 
-  std::vector<float> x_z(attr.batch_size * attr.hidden_size);
-  std::vector<float> x_r(attr.batch_size * attr.hidden_size);
-  std::vector<float> x_h(attr.batch_size * attr.hidden_size);
+  // weights and biases of gates z/r/h are contiguous, so the three gates
+  // are one [3 * hidden_size] GEMM; the input projection does not depend
+  // on h and is done for all timesteps at once
+  int64_t gate_size = 3 * attr.hidden_size;
+  std::vector<float> x_gates(attr.seq_len * attr.batch_size * gate_size);
+  std::vector<float> h_gates(attr.batch_size * gate_size);
 
-  std::vector<float> h_z(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_r(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_h(attr.batch_size * attr.hidden_size);
-
-  std::vector<float> g_z(attr.batch_size * attr.hidden_size);
-  std::vector<float> g_r(attr.batch_size * attr.hidden_size);
-  std::vector<float> g_h(attr.batch_size * attr.hidden_size);
+  dnnl_mm(input, x_wz, x_bz, x_gates.data(), attr.seq_len * attr.batch_size,
+          attr.input_size, gate_size, false);
 
   for (int s = 0; s < attr.seq_len; s++) {
-    // matrixmul
-    // x op w_x : [batch, x_size] op [x_size, attr.hidden_size] => [batch,
-    // attr.hidden_size] h op w_h : [batch, h_size] op [h_size,
-    // attr.hidden_size] => [batch, attr.hidden_size] note: h_size =
-    // attr.hidden_size?
     int seq_idx = forward ? s : (attr.seq_len - s - 1);
-    float *x = input + seq_idx * attr.batch_size * attr.input_size;
-
-    dnnl_mm(x, x_wz, x_bz, x_z.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-    dnnl_mm(x, x_wr, x_br, x_r.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-    dnnl_mm(x, x_wh, x_bh, x_h.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-
-    dnnl_mm(prev_hidden_state, h_wz, h_bz, h_z.data(), attr.batch_size,
-            attr.hidden_size, attr.hidden_size, false);
-    dnnl_mm(prev_hidden_state, h_wr, h_br, h_r.data(), attr.batch_size,
-            attr.hidden_size, attr.hidden_size, false);
-    dnnl_mm(prev_hidden_state, h_wh, h_bh, h_h.data(), attr.batch_size,
-            attr.hidden_size, attr.hidden_size, false);
+    dnnl_mm(prev_hidden_state, h_wz, h_bz, h_gates.data(), attr.batch_size,
+            attr.hidden_size, gate_size, false);
 
     for (int batch = 0; batch < attr.batch_size; batch++) {
-      float *xz = x_z.data() + batch * attr.hidden_size;
-      float *xr = x_r.data() + batch * attr.hidden_size;
-      float *xh = x_h.data() + batch * attr.hidden_size;
-
-      float *hz = h_z.data() + batch * attr.hidden_size;
-      float *hr = h_r.data() + batch * attr.hidden_size;
-      float *hh = h_h.data() + batch * attr.hidden_size;
+      float *xz =
+          x_gates.data() + (seq_idx * attr.batch_size + batch) * gate_size;
+      float *xr = xz + attr.hidden_size;
+      float *xh = xr + attr.hidden_size;
+
+      float *hz = h_gates.data() + batch * gate_size;
+      float *hr = hz + attr.hidden_size;
+      float *hh = hr + attr.hidden_size;
       float *pre_state = prev_hidden_state + batch * attr.hidden_size;
       float *hidden_state = pre_state;
       if (attr.output_y) {
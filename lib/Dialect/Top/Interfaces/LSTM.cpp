@@ -95,70 +95,38 @@ static void lstm_compute(InferenceParameter &p, const lstm_attr_t &attr,
     last_h += attr.batch_size * attr.hidden_size;
     last_c += attr.batch_size * attr.hidden_size;
   }
-  float *x_wo = x_wi + attr.input_size * attr.hidden_size;
-  float *x_wf = x_wo + attr.input_size * attr.hidden_size;
-  float *x_wc = x_wf + attr.input_size * attr.hidden_size;
-  float *x_bo = x_bi + attr.hidden_size;
-  float *x_bf = x_bo + attr.hidden_size;
-  float *x_bc = x_bf + attr.hidden_size;
-  float *h_wo = h_wi + attr.hidden_size * attr.hidden_size;
-  float *h_wf = h_wo + attr.hidden_size * attr.hidden_size;
-  float *h_wc = h_wf + attr.hidden_size * attr.hidden_size;
   float *h_bi = x_bi + 4 * attr.hidden_size;
   // if (!forward) h_bi += 2 * 4 * attr.hidden_size;
-  float *h_bo = h_bi + attr.hidden_size;
-  float *h_bf = h_bo + attr.hidden_size;
-  float *h_bc = h_bf + attr.hidden_size;
-
-  std::vector<float> x_i(attr.batch_size * attr.hidden_size);
-  std::vector<float> x_o(attr.batch_size * attr.hidden_size);
-  std::vector<float> x_f(attr.batch_size * attr.hidden_size);
-  std::vector<float> x_c(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_i(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_o(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_f(attr.batch_size * attr.hidden_size);
-  std::vector<float> h_c(attr.batch_size * attr.hidden_size);
+
+  // weights and biases of gates i/o/f/c are contiguous, so the four gates
+  // are one [4 * hidden_size] GEMM; the input projection does not depend
+  // on h and is done for all timesteps at once
+  int64_t gate_size = 4 * attr.hidden_size;
+  std::vector<float> x_gates(attr.seq_len * attr.batch_size * gate_size);
+  std::vector<float> h_gates(attr.batch_size * gate_size);
   std::vector<float> gi(attr.batch_size * attr.hidden_size);
   std::vector<float> go(attr.batch_size * attr.hidden_size);
   std::vector<float> gf(attr.batch_size * attr.hidden_size);
   std::vector<float> gc(attr.batch_size * attr.hidden_size);
 
+  dnnl_mm(input, x_wi, x_bi, x_gates.data(), attr.seq_len * attr.batch_size,
+          attr.input_size, gate_size, false);
+
   for (int s = 0; s < attr.seq_len; s++) {
-    // matrixmul
-    // x op w_x : [batch, x_size] op [x_size, attr.hidden_size] => [batch,
-    // attr.hidden_size] h op w_h : [batch, h_size] op [h_size,
-    // attr.hidden_size] => [batch, attr.hidden_size] note: h_size =
-    // attr.hidden_size?
     int seq_idx = forward ? s : (attr.seq_len - s - 1);
-    float *x = input + seq_idx * attr.batch_size * attr.input_size;
-
-    dnnl_mm(x, x_wi, x_bi, x_i.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-    dnnl_mm(x, x_wo, x_bo, x_o.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-    dnnl_mm(x, x_wf, x_bf, x_f.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-    dnnl_mm(x, x_wc, x_bc, x_c.data(), attr.batch_size, attr.input_size,
-            attr.hidden_size, false);
-
-    dnnl_mm(h, h_wi, h_bi, h_i.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, h_wo, h_bo, h_o.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, h_wf, h_bf, h_f.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, h_wc, h_bc, h_c.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
+    dnnl_mm(h, h_wi, h_bi, h_gates.data(), attr.batch_size, attr.hidden_size,
+            gate_size, false);
 
     for (int batch = 0; batch < attr.batch_size; batch++) {
-      float *xi = x_i.data() + batch * attr.hidden_size;
-      float *xo = x_o.data() + batch * attr.hidden_size;
-      float *xf = x_f.data() + batch * attr.hidden_size;
-      float *xc = x_c.data() + batch * attr.hidden_size;
-      float *hi = h_i.data() + batch * attr.hidden_size;
-      float *ho = h_o.data() + batch * attr.hidden_size;
-      float *hf = h_f.data() + batch * attr.hidden_size;
-      float *hc = h_c.data() + batch * attr.hidden_size;
+      float *xi =
+          x_gates.data() + (seq_idx * attr.batch_size + batch) * gate_size;
+      float *xo = xi + attr.hidden_size;
+      float *xf = xo + attr.hidden_size;
+      float *xc = xf + attr.hidden_size;
+      float *hi = h_gates.data() + batch * gate_size;
+      float *ho = hi + attr.hidden_size;
+      float *hf = ho + attr.hidden_size;
+      float *hc = hf + attr.hidden_size;
       float *cell_state = c + batch * attr.hidden_size;
       float *hidden_state = h + batch * attr.hidden_size;
       if (attr.output_y) {
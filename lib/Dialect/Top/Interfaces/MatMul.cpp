@@ -63,7 +63,7 @@ LogicalResult top::MatMulOp::init(InferenceParameter &p) {
   auto a = parseParam();
   matmul->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], a.batch,
                 a.M, a.K, a.N, a.do_relu, a.relu_limit, 0, a.right_transpose,
-                0);
+                0, module::isWeight(getRight()));
   p.handle = (void *)matmul;
   return success();
 }
@@ -63,7 +63,10 @@ public:
       module::setWeightFile(file_name);
       return;
     }
-    if (top_dialect->wFile->changed() == false && same_name) {
+    if (compact) {
+      top_dialect->wFile->compact();
+    }
+    if (top_dialect->wFile->changed() == false && same_name && !compact) {
       return;
     }
     std::set<StringRef> weight_names;
@@ -83,7 +86,7 @@ public:
     for (auto &name : dif_names) {
       top_dialect->wFile->deleteTensor(name);
     }
-    if (top_dialect->wFile->changed() == false && same_name) {
+    if (top_dialect->wFile->changed() == false && same_name && !compact) {
       return;
     }
     top_dialect->wFile->save(file_name);
@@ -15,6 +15,7 @@
 #include "mlir/IR/OpImplementation.h"
 #include "mlir/IR/TypeUtilities.h"
 #include <numeric>
+#include <shared_mutex>
 
 using namespace mlir;
 using namespace tpu_mlir::tpu;
@@ -53,15 +54,23 @@ static std::map<Operation *, pool_attr_t> group_pool_attrs;
 static std::map<Operation *, deconv_attr_t> group_deconv_attrs;
 static std::map<Operation *, slice_attr_t> group_slice_attrs;
 
+// the layer group search reads the params from several threads
+static std::shared_mutex group_attrs_mutex;
+
 template <typename OpTy, typename AttrTy>
 const AttrTy &getOpParam(OpTy &op, std::map<Operation *, AttrTy> &map) {
   auto op_ = op.getOperation();
-  auto iter = map.find(op_);
-  if (iter != map.end()) {
-    return iter->second;
+  {
+    std::shared_lock<std::shared_mutex> lock(group_attrs_mutex);
+    auto iter = map.find(op_);
+    if (iter != map.end()) {
+      return iter->second;
+    }
   }
-  map[op_] = op.parseParam();
-  return map[op_];
+  auto param = op.parseParam();
+  std::unique_lock<std::shared_mutex> lock(group_attrs_mutex);
+  // map nodes are stable, the reference stays valid after unlock
+  return map.try_emplace(op_, param).first->second;
 }
 
 const conv_attr_t &getConv2DParam(tpu::Conv2DOp &op) {
@@ -23,16 +23,83 @@ using namespace tpu_mlir::bm1684x;
 // WeightReorderInterface
 // ======================================
 
+static bool conv_int8_reorder_match(tpu::Conv2DOp op) {
+  return module::getStorageType(op.getFilter()).isInteger(8) &&
+         !op.getCoeffMerged();
+}
+
+namespace {
+// everything conv_int8_reorder reads from the IR and the weight file
+struct conv_int8_reorder_param_t {
+  conv_attr_t attr;
+  bool merge = true;
+  bool isINT4Conv = false;
+  int use_3ic_optimize = 0;
+  std::shared_ptr<std::vector<int8_t>> filter;
+  i32_array_t bias;
+  int32_t out_zp = 0;
+  i64_array_t multiplier;
+  i64_array_t rshift;
+};
+} // namespace
+
+// getters of the op create attributes in the context, so this runs on the
+// pass thread
+static conv_int8_reorder_param_t conv_int8_reorder_param(tpu::Conv2DOp op) {
+  conv_int8_reorder_param_t p;
+  auto &attr = p.attr;
+  attr = op.parseParam();
+  p.merge = !module::getStorageType(op.getOutput()).isInteger(32);
+  auto in_stype = module::getStorageType(op.getInput());
+  p.isINT4Conv = (in_stype.isInteger(4) && !attr.is_dw);
+  int IC_PARALLEL = BM168x::ic_num(p.isINT4Conv ? 0.5 : 1);
+
+  int use_3ic_optimize = 0;
+  if (attr.ic * attr.kh * attr.kw <= IC_PARALLEL && attr.kh > 1 &&
+      attr.kw > 1) {
+    use_3ic_optimize = 3; // merge kh and kw to ic
+  } else if (attr.ic * attr.kw <= IC_PARALLEL && attr.kw > 1 &&
+             (attr.kh < attr.kw || attr.ic * attr.kh > IC_PARALLEL)) {
+    use_3ic_optimize = 2; // merge kw to ic
+  } else if (attr.ic * attr.kh <= IC_PARALLEL && attr.kh > 1) {
+    use_3ic_optimize = 1; // merge kh to ic
+  } else {
+    use_3ic_optimize = 0;
+  }
+
+  auto pre_op = op.getInput().getDefiningOp();
+  if (use_3ic_optimize && !isa<top::InputOp>(*pre_op)) {
+    // broadcast input using BDC rather than GDMA
+    use_3ic_optimize |= 0x10;
+  }
+  if (use_3ic_optimize && !op.getInput().hasOneUse()) {
+    // broadcast input using BDC to a buffer
+    use_3ic_optimize |= 0x30;
+  }
+  if (module::isBM1686()) {
+    use_3ic_optimize = 0;
+  }
+  p.use_3ic_optimize = use_3ic_optimize;
+
+  p.filter = op.getFilter().getDefiningOp<top::WeightOp>().read<int8_t>();
+  if (!p.merge) {
+    return p;
+  }
+  if (attr.has_bias) {
+    p.bias = op.getBias().getDefiningOp<top::WeightOp>().read<int32_t>();
+  }
+  p.out_zp = module::getUniformQuantizedType(op.getOutput()).getZeroPoint();
+  p.multiplier = module::getI64Array(op.getMultiplier(), attr.oc, 1);
+  p.rshift = module::getI64Array(op.getRshift(), attr.oc, 0);
+  return p;
+}
+
 // refer to net_compiler: bool BM1684XCoeffArranger::ConvWeightArr(GraphEdge*
 // edge)
-template <>
-LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
-    tpu::Conv2DOp op, PatternRewriter &rewriter) const {
-  if (!module::getStorageType(op.getFilter()).isInteger(8) ||
-      op.getCoeffMerged())
-    return failure();
-
-  auto attr = op.parseParam();
+// only transforms the buffers of param, so several convs can run at once
+static conv_int8_reorder_t conv_int8_reorder(conv_int8_reorder_param_t &param) {
+  conv_int8_reorder_t result;
+  auto &attr = param.attr;
   int input_c = attr.ic;
   int output_c = attr.oc;
   int kh = attr.kh;
@@ -67,54 +134,21 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
     }
   }
 
-  bool merge = true;
-  auto out_stype = module::getStorageType(op.getOutput());
-  if (out_stype.isInteger(32)) {
-    merge = false;
-  }
-  bool isINT4Conv = false;
-  auto in_stype = module::getStorageType(op.getInput());
-  isINT4Conv = (in_stype.isInteger(4) && !attr.is_dw);
+  bool merge = param.merge;
+  bool isINT4Conv = param.isINT4Conv;
   if (isINT4Conv) {
     IC_PARALLEL = BM168x::ic_num(0.5);
   }
+  result.merged = merge;
+  result.isINT4Conv = isINT4Conv;
+  result.has_bias = attr.has_bias;
+  result.oc = attr.oc;
 
   // filter
-  auto filterOp = op.getFilter().getDefiningOp<top::WeightOp>();
-  auto filter_i8 = filterOp.read<int8_t>();
+  auto filter_i8 = std::move(param.filter);
   std::vector<int64_t> filter_shape = {attr.oc, attr.ic / attr.groups, attr.kh,
                                        attr.kw};
-  auto filter_type = module::getStorageType(op.getFilter());
-  int use_3ic_optimize = 0;
-  if (attr.ic * attr.kh * attr.kw <= IC_PARALLEL && attr.kh > 1 &&
-      attr.kw > 1) {
-    use_3ic_optimize = 3; // merge kh and kw to ic
-  } else if (attr.ic * attr.kw <= IC_PARALLEL && attr.kw > 1 &&
-             (attr.kh < attr.kw || attr.ic * attr.kh > IC_PARALLEL)) {
-    use_3ic_optimize = 2; // merge kw to ic
-  } else if (attr.ic * attr.kh <= IC_PARALLEL && attr.kh > 1) {
-    use_3ic_optimize = 1; // merge kh to ic
-  } else {
-    use_3ic_optimize = 0;
-  }
-
-  auto stype = module::getStorageType(op.getFilter());
-  auto new_type = RankedTensorType::get(filter_shape, stype);
-  int weight_size = align_up(gic, IC_PARALLEL) * output_c * kh * kw * 1;
-  auto data_i8 = std::make_shared<std::vector<int8_t>>(weight_size);
-
-  auto pre_op = op.getInput().getDefiningOp();
-  if (use_3ic_optimize && !isa<top::InputOp>(*pre_op)) {
-    // broadcast input using BDC rather than GDMA
-    use_3ic_optimize |= 0x10;
-  }
-  if (use_3ic_optimize && !op.getInput().hasOneUse()) {
-    // broadcast input using BDC to a buffer
-    use_3ic_optimize |= 0x30;
-  }
-  if (module::isBM1686()) {
-    use_3ic_optimize = 0;
-  }
+  int use_3ic_optimize = param.use_3ic_optimize;
 
   if (attr.is_dw == false) {
     if (strideh_gt_15 || stridew_gt_15) {
@@ -122,79 +156,30 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
       filter_shape[1] = output_c;
       filter_shape[2] = ceiling_func(gic, IC_PARALLEL);
       filter_shape[3] = kh * kw * IC_PARALLEL;
-
-      for (int oc = 0; oc < output_c; oc++) {
-        for (int ic_idx = 0; ic_idx < ceiling_func(gic, IC_PARALLEL);
-             ic_idx++) {
-          for (int ic_inner = 0; ic_inner < IC_PARALLEL; ic_inner++) {
-            for (int icell_h = 0; icell_h < (kh / cell_h); icell_h++) {
-              for (int ih = 0; ih < cell_h; ih++) {
-                for (int icell_w = 0; icell_w < (kw / cell_w); icell_w++) {
-                  for (int iw = 0; iw < cell_w; iw++) {
-                    if (ic_idx * IC_PARALLEL + ic_inner >= gic)
-                      continue;
-                    int orig_offset =
-                        oc * gic * kh * kw +
-                        (ic_idx * IC_PARALLEL + ic_inner) * kh * kw +
-                        (icell_h * cell_h + ih) * kw + icell_w * cell_w + iw;
-                    int trans_offset =
-                        oc * kh * kw * align_up(gic, IC_PARALLEL) +
-                        (icell_h * (kw / cell_w) + icell_w) * cell_h * cell_w *
-                            align_up(gic, IC_PARALLEL) +
-                        ic_idx * cell_h * cell_w * IC_PARALLEL +
-                        (ih * cell_w + iw) * IC_PARALLEL + ic_inner;
-                    data_i8->at(trans_offset) = filter_i8->at(orig_offset);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-
-      auto stype = module::getStorageType(op.getFilter());
-      auto new_type = RankedTensorType::get(filter_shape, stype);
-      auto new_op =
-          top::WeightOp::create(op, "filter_reorderd", *data_i8, new_type);
-      op->setOperand(1, new_op);
-      if (merge == false) {
-        if (attr.has_bias) {
-          auto elem_type = module::getStorageType(op.getBias());
-          auto bias_type = RankedTensorType::get({1, attr.oc, 1, 1}, elem_type);
-          op.getBias().setType(bias_type);
+      filter_i8 = tpu::reorder_cell_ic_parallel(*filter_i8, output_c, gic, kh,
+                                                kw, cell_h, cell_w,
+                                                IC_PARALLEL);
+      if (merge) {
+        tpu::reshape_coeff_for_broadcast_channel(filter_i8, filter_shape,
+                                                 false, isINT4Conv);
+        if (isINT4Conv) {
+          tpu::compact_coeff_for_int4(filter_i8, filter_shape);
         }
-        return success();
-      }
-      tpu::reshape_coeff_for_broadcast_channel(data_i8, filter_shape, false,
-                                               isINT4Conv);
-      if (isINT4Conv) {
-        tpu::compact_coeff_for_int4(data_i8, filter_shape);
       }
     } else {
       tpu::reshape_coeff_for_3ic(filter_i8, filter_shape, use_3ic_optimize,
                                  isINT4Conv);
-      op->setAttr("use_3ic_optimize",
-                  rewriter.getI64IntegerAttr(use_3ic_optimize));
+      result.use_3ic_optimize = use_3ic_optimize;
     }
   } else {
     filter_shape = {1, attr.oc, 1, attr.kh * attr.kw};
   }
 
   if (merge == false) {
-    auto stype = module::getStorageType(op.getFilter());
-    auto new_type = RankedTensorType::get(filter_shape, stype);
-    auto new_op =
-        top::WeightOp::create(op, "filter_reorderd", *filter_i8, new_type);
-    op->setOperand(1, new_op);
-    if (attr.has_bias) {
-      auto elem_type = module::getStorageType(op.getBias());
-      auto bias_type = RankedTensorType::get({1, attr.oc, 1, 1}, elem_type);
-      op.getBias().setType(bias_type);
-    }
-    return success();
+    result.coeff = filter_i8;
+    result.shape = filter_shape;
+    return result;
   }
-  // auto filter_data = (strideh_gt_15 || stridew_gt_15) == true ? data_i8 :
-  // filter_i8;
   if (!(strideh_gt_15 || stridew_gt_15)) {
     tpu::reshape_coeff_for_broadcast_channel(filter_i8, filter_shape, false,
                                              isINT4Conv);
@@ -211,8 +196,7 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
   std::vector<int64_t> bias_shape = {1, attr.oc, 1, 1};
   int64_t bias_w_bytes = 0;
   if (attr.has_bias) {
-    auto biasOp = op.getBias().getDefiningOp<top::WeightOp>();
-    bias_new = biasOp.read<int32_t>();
+    bias_new = std::move(param.bias);
     tpu::reshape_coeff_for_broadcast_channel(bias_new, bias_shape, false,
                                              isINT4Conv);
     assert(new_oc == bias_shape[1]);
@@ -220,11 +204,10 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
   }
 
   // requant
-  auto qtype = module::getUniformQuantizedType(op.getOutput());
-  int32_t out_zp = qtype.getZeroPoint();
+  int32_t out_zp = param.out_zp;
   auto quant_data = std::make_shared<std::vector<int32_t>>(attr.oc * 3, 0);
-  auto m_data = module::getI64Array(op.getMultiplier(), attr.oc, 1);
-  auto r_data = module::getI64Array(op.getRshift(), attr.oc, 0);
+  auto &m_data = param.multiplier;
+  auto &r_data = param.rshift;
   int64_t quant_w_size = 0;
   bool align = true;
   if (module::isBM1686()) {
@@ -278,9 +261,7 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
     auto quant_ptr = quant_data->data() + i * quant_shape[3];
     auto bias_ptr =
         attr.has_bias ? (bias_new->data() + i * bias_shape[3]) : nullptr;
-    auto filter_ptr = (strideh_gt_15 || stridew_gt_15) == true
-                          ? data_i8->data() + i * filter_shape[3]
-                          : filter_i8->data() + i * filter_shape[3];
+    auto filter_ptr = filter_i8->data() + i * filter_shape[3];
     // copy quant
     memcpy(coeff_ptr + quant_offset, quant_ptr, quant_w_bytes);
     if (attr.has_bias) {
@@ -297,10 +278,78 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
       coeff_shape[3] /= IC_PARALLEL;
     }
   }
+  result.coeff = new_coeff;
+  result.shape = coeff_shape;
+  return result;
+}
+
+void tpu_mlir::bm1684x::prepareWeightReorder(ModuleOp module,
+                                             conv_int8_prepared_t &prepared) {
+  std::vector<tpu::Conv2DOp> convs;
+  module.walk([&](tpu::Conv2DOp op) {
+    if (module::isWeight(op.getFilter()) && conv_int8_reorder_match(op)) {
+      convs.push_back(op);
+    }
+  });
+  if (convs.empty()) {
+    return;
+  }
+  // weights are read by all threads, load them before going parallel
+  auto dialect = module->getContext()->getLoadedDialect("top");
+  auto top_dialect = llvm::cast<top::TopDialect>(dialect);
+  if (top_dialect->wFile == nullptr) {
+    top_dialect->loadWeightFile(module::getWeightFile());
+  }
+  // the IR and the weight file are read here, only the buffer transforms
+  // run on omp threads
+  std::vector<conv_int8_reorder_param_t> params;
+  params.reserve(convs.size());
+  for (auto op : convs) {
+    params.push_back(conv_int8_reorder_param(op));
+  }
+  std::vector<conv_int8_reorder_t> results(convs.size());
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < (int)convs.size(); i++) {
+    results[i] = conv_int8_reorder(params[i]);
+  }
+  for (size_t i = 0; i < convs.size(); i++) {
+    prepared[convs[i]] = std::move(results[i]);
+  }
+}
+
+LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
+    tpu::Conv2DOp op, PatternRewriter &rewriter) const {
+  if (!conv_int8_reorder_match(op))
+    return failure();
+
+  conv_int8_reorder_t reorder;
+  if (prepared != nullptr && prepared->count(op)) {
+    reorder = std::move(prepared->at(op));
+    prepared->erase(op);
+  } else {
+    auto param = conv_int8_reorder_param(op);
+    reorder = conv_int8_reorder(param);
+  }
+  if (reorder.use_3ic_optimize >= 0) {
+    op->setAttr("use_3ic_optimize",
+                rewriter.getI64IntegerAttr(reorder.use_3ic_optimize));
+  }
   auto elem_type = module::getStorageType(op.getFilter());
-  auto coeff_type = RankedTensorType::get(coeff_shape, elem_type);
+  auto coeff_type = RankedTensorType::get(reorder.shape, elem_type);
+  if (reorder.merged == false) {
+    auto new_op = top::WeightOp::create(op, "filter_reorderd", *reorder.coeff,
+                                        coeff_type);
+    op->setOperand(1, new_op);
+    if (reorder.has_bias) {
+      auto elem_type = module::getStorageType(op.getBias());
+      auto bias_type = RankedTensorType::get({1, reorder.oc, 1, 1}, elem_type);
+      op.getBias().setType(bias_type);
+    }
+    return success();
+  }
   bool sign = coeff_type.getElementType().isSignedInteger();
-  auto coeff_op = top::WeightOp::create(op, "merge", *new_coeff, coeff_type);
+  auto coeff_op =
+      top::WeightOp::create(op, "merge", *reorder.coeff, coeff_type);
   op->removeAttr("rshift");
   op->removeAttr("multiplier");
   op->setAttr("coeff_merged", rewriter.getBoolAttr(true));
@@ -308,12 +357,11 @@ LogicalResult WeightReorder<tpu::Conv2DOp, int8_t>::matchAndRewrite(
   auto none = module::getNoneOp(op);
   op->setOperand(2, none.getResult());
 
-  auto new_type_ = RankedTensorType::get(coeff_shape, in_stype);
-  if (isINT4Conv) {
+  if (reorder.isINT4Conv) {
     // weight data type is same as input tensor's data type, and sign is same
     // as Filter.
-    new_type_ =
-        RankedTensorType::get(coeff_shape, rewriter.getIntegerType(4, sign));
+    auto new_type_ = RankedTensorType::get(reorder.shape,
+                                           rewriter.getIntegerType(4, sign));
     op.getFilter().setType(new_type_);
   }
   return success();
@@ -360,8 +408,6 @@ LogicalResult weight_reorder_bf16_bm1684x(tpu::Conv2DOp op,
   const int IC_PARALLEL = BM168x::ic_num(2);
   auto filter_u16 = filterOp.read<uint16_t>();
   auto filter_type = module::getStorageType(op.getFilter());
-  int weight_size = align_up(gic, IC_PARALLEL) * output_c * kh * kw * 2;
-  auto data_bf16 = std::make_shared<std::vector<uint16_t>>(weight_size);
 
   if (attr.is_dw) {
     filter_shape = {1, attr.ic, attr.kh, attr.kw};
@@ -413,34 +459,8 @@ LogicalResult weight_reorder_bf16_bm1684x(tpu::Conv2DOp op,
       filter_shape[2] = ceiling_func(gic, IC_PARALLEL);
       filter_shape[3] = kh * kw * IC_PARALLEL;
 
-      for (int oc = 0; oc < output_c; oc++) {
-        for (int ic_idx = 0; ic_idx < ceiling_func(gic, IC_PARALLEL);
-             ic_idx++) {
-          for (int ic_inner = 0; ic_inner < IC_PARALLEL; ic_inner++) {
-            for (int icell_h = 0; icell_h < (kh / cell_h); icell_h++) {
-              for (int ih = 0; ih < cell_h; ih++) {
-                for (int icell_w = 0; icell_w < (kw / cell_w); icell_w++) {
-                  for (int iw = 0; iw < cell_w; iw++) {
-                    if (ic_idx * IC_PARALLEL + ic_inner >= gic)
-                      continue;
-                    int orig_offset =
-                        oc * gic * kh * kw +
-                        (ic_idx * IC_PARALLEL + ic_inner) * kh * kw +
-                        (icell_h * cell_h + ih) * kw + icell_w * cell_w + iw;
-                    int trans_offset =
-                        oc * kh * kw * align_up(gic, IC_PARALLEL) +
-                        (icell_h * (kw / cell_w) + icell_w) * cell_h * cell_w *
-                            align_up(gic, IC_PARALLEL) +
-                        ic_idx * cell_h * cell_w * IC_PARALLEL +
-                        (ih * cell_w + iw) * IC_PARALLEL + ic_inner;
-                    data_bf16->at(trans_offset) = filter_u16->at(orig_offset);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
+      filter_u16 = tpu::reorder_cell_ic_parallel(
+          *filter_u16, output_c, gic, kh, kw, cell_h, cell_w, IC_PARALLEL);
     } else {
       tpu::reshape_coeff_for_3ic(filter_u16, filter_shape, use_3ic_optimize);
       op->setAttr("use_3ic_optimize",
@@ -466,10 +486,8 @@ LogicalResult weight_reorder_bf16_bm1684x(tpu::Conv2DOp op,
   }
 
   auto new_type = RankedTensorType::get(filter_shape, filter_type);
-  auto filter_data =
-      (strideh_gt_15 || stridew_gt_15) == true ? *data_bf16 : *filter_u16;
   auto new_op =
-      top::WeightOp::create(op, "filter_reorderd", filter_data, new_type);
+      top::WeightOp::create(op, "filter_reorderd", *filter_u16, new_type);
   op->setOperand(1, new_op);
   return success();
 }
@@ -736,8 +754,8 @@ void tpu::Conv2DOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
   common.groups = attr.groups;
   common.pad_h_t = (in_gi.h_idx == 0 ? attr.pht : 0);
   common.pad_h_b = (in_gi.h_idx + in_gi.h_slice == attr.ih ? attr.phb : 0);
-  common.pad_w_l = attr.pwl;
-  common.pad_w_r = attr.pwr;
+  common.pad_w_l = (in_gi.w_idx == 0 ? attr.pwl : 0);
+  common.pad_w_r = (in_gi.w_idx + in_gi.w_slice == attr.iw ? attr.pwr : 0);
   common.round_mode = ROUNDING_HALF_UP;
   common.has_bias = attr.has_bias;
   common.bias_sign = true;
@@ -13,6 +13,7 @@
 #include "tpu_mlir/Support/Dnnl/Conv.h"
 #include "tpu_mlir/Support/Module.h"
 #include "tpu_mlir/Support/MathUtils.h"
+#include "ConvUtils.h"
 
 using namespace tpu_mlir::backend;
 using namespace tpu_mlir::bm1684x;
@@ -33,24 +34,8 @@ static void filter_reorder(std::shared_ptr<std::vector<T>> &filter,
   int32_t IC_PARALLEL = BM168x::ic_num(type_bytes);
   auto kernel_hw = kh * kw;
   int32_t new_ic = ceiling_func(ic * kd, IC_PARALLEL);
-  int32_t new_hw = kernel_hw * IC_PARALLEL;
-  auto filter_new = std::make_shared<std::vector<T>>(oc * new_ic * new_hw, 0);
-  for (int oc_idx = 0; oc_idx < oc; oc_idx++) {
-    for (int ic_idx = 0; ic_idx < new_ic; ic_idx++) {
-      for (int k_idx = 0; k_idx < kernel_hw; k_idx++) {
-        for (int inner = 0; inner < IC_PARALLEL; inner++) {
-          if (ic_idx * IC_PARALLEL + inner >= ic * kd)
-            break;
-          int orig_offset = oc_idx * ic * kd * kh * kw +
-                            (ic_idx * IC_PARALLEL + inner) * kernel_hw + k_idx;
-          int trans_offset = oc_idx * new_ic * new_hw + ic_idx * new_hw +
-                             k_idx * IC_PARALLEL + inner;
-          filter_new->at(trans_offset) = filter->at(orig_offset);
-        }
-      }
-    }
-  }
-  filter = filter_new;
+  filter =
+      tpu::reorder_ic_parallel(*filter, oc, ic * kd, kernel_hw, IC_PARALLEL);
   shape = {1, oc, new_ic, kh * kw, IC_PARALLEL};
 }
 
@@ -40,11 +40,8 @@ static void reshape_coeff_for_broadcast_channel(
       if (i * new_c + j >= c) {
         break;
       }
-      for (uint k = 0; k < w; k++) {
-        uint src_idx = (i * new_c + j) * w + k;
-        uint dst_idx = j * new_w + i * (align ? old_w_align : w) + k;
-        coeff_new->at(dst_idx) = coeff->at(src_idx);
-      }
+      std::copy_n(coeff->data() + (i * new_c + j) * w, w,
+                  coeff_new->data() + j * new_w + i * (align ? old_w_align : w));
     }
   }
 
@@ -55,6 +52,47 @@ static void reshape_coeff_for_broadcast_channel(
   shape.back() = new_w;
 }
 
+// convert (oc, ic, kernel) to (oc, DIV_UP(ic, IC_PARALLEL), kernel,
+// IC_PARALLEL), zero padding ic
+template <typename T>
+static std::shared_ptr<std::vector<T>>
+reorder_ic_parallel(std::vector<T> &filter, int64_t oc, int64_t ic,
+                    int64_t kernel, int64_t IC_PARALLEL) {
+  int64_t new_ic = ceiling_func(ic, IC_PARALLEL);
+  int64_t align_ic = new_ic * IC_PARALLEL;
+  auto filter_new = std::make_shared<std::vector<T>>(oc * align_ic * kernel);
+  T *src = filter.data();
+  std::vector<T> filter_pad;
+  if (align_ic != ic) {
+    filter_pad.assign(oc * align_ic * kernel, 0);
+    for (int64_t i = 0; i < oc; i++) {
+      std::copy_n(filter.data() + i * ic * kernel, ic * kernel,
+                  filter_pad.data() + i * align_ic * kernel);
+    }
+    src = filter_pad.data();
+  }
+  function_permute(src, filter_new->data(), {oc * new_ic, IC_PARALLEL, kernel},
+                   {0, 2, 1});
+  return filter_new;
+}
+
+// convert (oc, ic, kh, kw) with kernel split into cells of (cell_h, cell_w)
+// to (oc, kh / cell_h * kw / cell_w, DIV_UP(ic, IC_PARALLEL), cell_h * cell_w,
+// IC_PARALLEL), zero padding ic
+template <typename T>
+static std::shared_ptr<std::vector<T>>
+reorder_cell_ic_parallel(std::vector<T> &filter, int64_t oc, int64_t ic,
+                         int64_t kh, int64_t kw, int64_t cell_h,
+                         int64_t cell_w, int64_t IC_PARALLEL) {
+  int64_t ncell_h = kh / cell_h, ncell_w = kw / cell_w;
+  std::vector<T> filter_cell(filter.size());
+  function_permute(filter.data(), filter_cell.data(),
+                   {oc, ic, ncell_h, cell_h, ncell_w, cell_w},
+                   {0, 2, 4, 1, 3, 5});
+  return reorder_ic_parallel(filter_cell, oc * ncell_h * ncell_w, ic,
+                             cell_h * cell_w, IC_PARALLEL);
+}
+
 template <typename T>
 static void filter_reorder(std::shared_ptr<std::vector<T>> &filter,
                            std::vector<int64_t> &shape,
@@ -66,22 +104,8 @@ static void filter_reorder(std::shared_ptr<std::vector<T>> &filter,
   auto kernel_hw = kh * kw;
   int64_t new_ic = ceiling_func(ic, IC_PARALLEL);
   int64_t new_hw = kernel_hw * IC_PARALLEL;
-  auto filter_new = std::make_shared<std::vector<T>>(oc * new_ic * new_hw, 0);
-  for (int oc_idx = 0; oc_idx < oc; oc_idx++) {
-    for (int ic_idx = 0; ic_idx < new_ic; ic_idx++) {
-      for (int k_idx = 0; k_idx < kernel_hw; k_idx++) {
-        for (int inner = 0; inner < IC_PARALLEL; inner++) {
-          if (ic_idx * IC_PARALLEL + inner >= ic)
-            break;
-          int orig_offset = oc_idx * ic * kh * kw +
-                            (ic_idx * IC_PARALLEL + inner) * kernel_hw + k_idx;
-          int trans_offset = oc_idx * new_ic * new_hw + ic_idx * new_hw +
-                             k_idx * IC_PARALLEL + inner;
-          filter_new->at(trans_offset) = filter->at(orig_offset);
-        }
-      }
-    }
-  }
+  auto filter_new =
+      reorder_ic_parallel(*filter, oc, ic, kernel_hw, IC_PARALLEL);
   assert(shape.size() > 2);
   filter = filter_new;
   shape.assign(shape.size(), 1);
@@ -100,17 +124,10 @@ static void reshape_coeff_for_3ic(std::shared_ptr<std::vector<T>> &weight,
 
   // if merge kw to ic, it need convert (oc, ic, kh, kw) to (oc, ic, kw, kh).
   if (use_3ic_optimize == 2) {
-    auto khw = std::make_shared<std::vector<T>>(kh * kw, 0);
-    for (uint i = 0; i < oc * ic; ++i) {
-      for (uint j = 0; j < kh; ++j) {
-        for (uint k = 0; k < kw; ++k) {
-          khw->at(k * kh + j) = weight->at(i * kh * kw + j * kw + k);
-        }
-      }
-      for (uint j = 0; j < kh * kw; ++j) {
-        weight->at(i * kh * kw + j) = khw->at(j);
-      }
-    }
+    auto weight_trans = std::make_shared<std::vector<T>>(weight->size());
+    function_permute(weight->data(), weight_trans->data(), {oc * ic, kh, kw},
+                     {0, 2, 1});
+    weight = weight_trans;
   }
 
   int64_t new_ic, new_kernel;
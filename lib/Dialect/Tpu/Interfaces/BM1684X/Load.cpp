@@ -70,11 +70,14 @@ void tpu::LoadOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
     g_stride.C = 0;
     g_stride.H = 0;
   }
-  auto s_stride = BM168x::getLocalStride(gi.n_slice, C, real_hslice, W,
-                                         fmt_bytes, gi.eu_align);
+  // w is only split for tensors loaded by stride move
+  int64_t real_wslice = gi.w_slice < W ? gi.w_slice : W;
+  auto s_stride = BM168x::getLocalStride(gi.n_slice, C, real_hslice,
+                                         real_wslice, fmt_bytes, gi.eu_align);
   auto g_addr = module::getAddress(getInput());
-  int64_t g_offset =
-      (gi.n_idx * g_stride.N + gi.h_idx * g_stride.H) * fmt_bytes;
+  int64_t g_offset = (gi.n_idx * g_stride.N + gi.h_idx * g_stride.H +
+                      gi.w_idx * g_stride.W) *
+                     fmt_bytes;
   int64_t use_3ic = getUse_3icOptimize();
   if (use_3ic < 4 && use_3ic > 0) {
     auto use_op = *getOutput().getUsers().begin();
@@ -92,9 +95,10 @@ void tpu::LoadOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
     }
   } else {
     BM168x::instance()->dl_tensor_stride_move_gen_cmd(
-        gi.out_addr, 0, g_addr + g_offset, gi.n_slice, C, real_hslice, W,
-        g_stride.N, g_stride.C, g_stride.H, g_stride.W, s_stride.N, s_stride.C,
-        s_stride.H, s_stride.W, gdma_format, GDMA_VALUE_DIR_S2L, 0, pid_node);
+        gi.out_addr, 0, g_addr + g_offset, gi.n_slice, C, real_hslice,
+        real_wslice, g_stride.N, g_stride.C, g_stride.H, g_stride.W,
+        s_stride.N, s_stride.C, s_stride.H, s_stride.W, gdma_format,
+        GDMA_VALUE_DIR_S2L, 0, pid_node);
   }
 }
 
@@ -140,6 +140,9 @@ void tpu::Pool2DOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
   common.pad_h_t = (in_gi.h_idx == 0 ? attr.pad_h : 0);
   common.pad_h_b =
       (in_gi.h_idx + in_gi.h_slice == attr.ih ? attr.pad_h_after : 0);
+  common.pad_w_l = (in_gi.w_idx == 0 ? attr.pad_w : 0);
+  common.pad_w_r =
+      (in_gi.w_idx + in_gi.w_slice == attr.iw ? attr.pad_w_after : 0);
 
   if (getPoolMode() == tpu::PoolMode::Avg) {
     bool with_pad = has_pad(attr) && attr.count_include_pad == 0;
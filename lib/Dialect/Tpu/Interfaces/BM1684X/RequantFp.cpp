@@ -72,7 +72,7 @@ void tpu::RequantFpOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
   param.n = sec_info.out_n_slice;
   param.c = c;
   param.h = sec_info.out_h_slice;
-  param.w = w;
+  param.w = sec_info.out_w_slice;
 
   auto oqtype = module::getUniformQuantizedType(getOutput());
   param.scale_value = getScale().convertToDouble();
@@ -83,7 +83,7 @@ void tpu::RequantIntOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
   param.n = sec_info.n_slice;
   param.c = c;
   param.h = sec_info.h_slice;
-  param.w = w;
+  param.w = sec_info.w_slice;
   param.mul_value = getMultiplier();
   param.shift_value = -getRshift();
   param.offset_value = oqtype.getZeroPoint();
@@ -57,14 +57,16 @@ void tpu::StoreOp::codegen_local_bm1684x(int64_t n_step, int64_t h_step,
   auto fmt_bytes = BM168x::getFmtBytes(data_type);
 
   auto g_stride = BM168x::getGlobalStride(N, C, H, W);
+  int64_t real_wslice = gi.w_slice < W ? gi.w_slice : W;
   auto s_stride = BM168x::getLocalStride(
-      gi.n_slice, C, real_hslice, W, fmt_bytes, gi.eu_align);
+      gi.n_slice, C, real_hslice, real_wslice, fmt_bytes, gi.eu_align);
   auto g_addr = module::getAddress(getOutput());
-  int64_t g_offset =
-      (gi.n_idx * g_stride.N + gi.h_idx * g_stride.H) * fmt_bytes;
+  int64_t g_offset = (gi.n_idx * g_stride.N + gi.h_idx * g_stride.H +
+                      gi.w_idx * g_stride.W) *
+                     fmt_bytes;
   BM168x::instance()->dl_tensor_stride_move_gen_cmd(
       gi.out_addr, 0, g_addr + g_offset, gi.n_slice, C,
-      real_hslice, W, s_stride.N, s_stride.C, s_stride.H,
+      real_hslice, real_wslice, s_stride.N, s_stride.C, s_stride.H,
       s_stride.W, g_stride.N, g_stride.C, g_stride.H, g_stride.W, gdma_format,
       GDMA_VALUE_DIR_L2S, 0, pid_node);
 }
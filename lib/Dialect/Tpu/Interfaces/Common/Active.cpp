@@ -15,11 +15,6 @@
 #include "tpu_mlir/Support/MathUtils.h"
 #include "tpu_mlir/Support/Float16.h"
 
-static mlir::Type t;
-
-LogicalResult tpu::ActiveOp::init(InferenceParameter &p) { return success(); }
-void tpu::ActiveOp::deinit(InferenceParameter &p) {}
-
 static inline double elu(double x, double alpha) {
   return x > 0 ? x : alpha * (std::exp(x) - 1);
 }
@@ -32,7 +27,7 @@ static inline double gelu(double x) {
   return 0.5 * x * (1.0 + std::erf(x / std::sqrt(2.0)));
 }
 
-static inline double hswish(double x) {
+static inline double hswish(double x, mlir::Type t) {
   if (t.isBF16()) {
     return BF16(x * std::max(0.0f, std::min(1.0f, BF16(BF16(x + 3.0) / 6.0))));
   }
@@ -42,76 +37,82 @@ static inline double hswish(double x) {
   return x * std::max(0.0, std::min(1.0, (x + 3.0) / 6.0));
 }
 
-static void active_func(InferenceParameter &p, int64_t num, activate_f func) {
-#pragma omp parallel for schedule(static, omp_schedule(num))
-  for (int i = 0; i < num; ++i) {
-    p.outputs[0][i] = func(p.inputs[0][i]);
-  }
-}
+namespace {
+struct ActiveCache : public InferenceCache {
+  activate_f func;
+};
+} // namespace
 
-LogicalResult tpu::ActiveOp::inference(InferenceParameter &p) {
-  t = module::getStorageType(getOutput());
-  auto num_element = module::getNumElements(getInput());
+LogicalResult tpu::ActiveOp::init(InferenceParameter &p) {
+  auto &cache = p.make_cache<ActiveCache>();
+  auto t = module::getStorageType(getOutput());
   switch (getMode()) {
   case ActiveMode::ABSVAL:
-    active_func(p, num_element, [](double val) { return std::abs(val); });
+    cache.func = [](double val) { return std::abs(val); };
     break;
   case ActiveMode::ELU: {
     const auto coeffs_ = module::getF64Array(getCoeffs(), 1, 0);
     const double alpha = coeffs_->at(0);
-    active_func(p, num_element, [alpha](double val) {
-      return elu(val, alpha);
-    });
+    cache.func = [alpha](double val) { return elu(val, alpha); };
     break;
   }
   case ActiveMode::ERF:
-    active_func(p, num_element, [](double val) { return std::erf(val); });
+    cache.func = [](double val) { return std::erf(val); };
     break;
   case ActiveMode::EXP:
-    active_func(p, num_element, [](double val) { return std::exp(val); });
+    cache.func = [](double val) { return std::exp(val); };
     break;
   case ActiveMode::LN:
-    active_func(p, num_element, [](double val) { return std::log(val); });
+    cache.func = [](double val) { return std::log(val); };
     break;
   case ActiveMode::SQRT:
-    active_func(p, num_element, [](double val) { return std::sqrt(val); });
+    cache.func = [](double val) { return std::sqrt(val); };
     break;
   case ActiveMode::SILU:
-    active_func(p, num_element,
-                [](double val) { return val / (1 + std::exp(-val)); });
+    cache.func = [](double val) { return val / (1 + std::exp(-val)); };
     break;
   case ActiveMode::SIGMOID:
-    active_func(p, num_element,
-                [](double val) { return 1 / (1 + std::exp(-val)); });
+    cache.func = [](double val) { return 1 / (1 + std::exp(-val)); };
     break;
   case ActiveMode::HSIGMOID: {
     const auto coeffs_ = module::getF64Array(getCoeffs(), 2, 0);
     const double alpha = coeffs_->at(1);
     const double beta = coeffs_->at(0);
-    active_func(p, num_element, [alpha, beta](double val) {
+    cache.func = [alpha, beta](double val) {
       return hsigmoid(val, alpha, beta);
-    });
+    };
     break;
   }
   case ActiveMode::HSWISH:
-    active_func(p, num_element, [](double val) { return hswish(val); });
+    cache.func = [t](double val) { return hswish(val, t); };
     break;
   case ActiveMode::TANH:
-    active_func(p, num_element, [](double val) { return std::tanh(val); });
+    cache.func = [](double val) { return std::tanh(val); };
     break;
   case ActiveMode::GELU:
-    active_func(p, num_element, [](double val) { return gelu(val); });
+    cache.func = [](double val) { return gelu(val); };
     break;
   case ActiveMode::SOFT_PLUS:
-    active_func(p, num_element,
-                [](double val) { return std::log(std::exp(val) + 1); });
+    cache.func = [](double val) { return std::log(std::exp(val) + 1); };
     break;
   case ActiveMode::FLOOR:
-    active_func(p, num_element, [](double val) { return std::floor(val); });
+    cache.func = [](double val) { return std::floor(val); };
     break;
   default:
     llvm_unreachable("Not Implemented");
   }
+  return success();
+}
+void tpu::ActiveOp::deinit(InferenceParameter &p) { p.cache.reset(); }
+
+LogicalResult tpu::ActiveOp::inference(InferenceParameter &p) {
+  auto t = module::getStorageType(getOutput());
+  auto num_element = module::getNumElements(getInput());
+  auto &func = p.get_cache<ActiveCache>().func;
+#pragma omp parallel for schedule(static, omp_schedule(num_element))
+  for (int i = 0; i < num_element; ++i) {
+    p.outputs[0][i] = func(p.inputs[0][i]);
+  }
   if (t.isBF16()) {
     BF16(p.outputs[0], p.outputs[0], num_element);
   } else if (t.isF16()) {
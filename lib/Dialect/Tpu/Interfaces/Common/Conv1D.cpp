@@ -51,12 +51,49 @@ conv_attr_t tpu::Conv1DOp::parseParam() {
   return p;
 }
 
+namespace {
+// per channel requant of the quantized conv
+struct Conv1DCache : public InferenceCache {
+  std::vector<int64_t> multiplier, rshift;
+  int64_t zero_point = 0;
+  tpu::RequantMode qmode;
+  RoundingMode rmode;
+};
+} // namespace
+
 LogicalResult tpu::Conv1DOp::init(InferenceParameter &p) {
   auto conv = new Conv();
   auto attr = parseParam();
 
-  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr);
+  int64_t K = attr.ic / attr.groups * attr.kd * attr.kh * attr.kw;
+  auto src_dt = attr.kernel_zp == 0
+                    ? getDnnlInt8Type(getInput(), getFilter(), K, getBias())
+                    : memory::data_type::f32;
+  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr,
+              module::isWeight(getFilter()), src_dt);
   p.handle = (void *)conv;
+  if (module::isUniformQuantized(getOutput())) {
+    auto &cache = p.make_cache<Conv1DCache>();
+    int64_t c = attr.oc;
+    auto rshift_v = module::getI64Array(getRshift().value());
+    auto multiplier_v =
+        module::getI64Array(getMultiplier(), rshift_v->size(), 1);
+    bool per_axis = rshift_v->size() == c;
+    cache.rshift.resize(c);
+    cache.multiplier.resize(c);
+    for (int ic = 0; ic < c; ic++) {
+      cache.rshift[ic] = per_axis ? rshift_v->at(ic) : rshift_v->at(0);
+      cache.multiplier[ic] =
+          per_axis ? multiplier_v->at(ic) : multiplier_v->at(0);
+    }
+    cache.zero_point =
+        module::getUniformQuantizedType(getOutput()).getZeroPoint();
+    cache.qmode = getQuantMode();
+    bool is_tf = cache.qmode == tpu::RequantMode::QDM ||
+                 cache.qmode == tpu::RequantMode::TFLite ||
+                 cache.qmode == tpu::RequantMode::TFLite_LShift;
+    cache.rmode = is_tf ? ROUNDING_HALF_AWAY_FROM_ZERO : ROUNDING_HALF_UP;
+  }
   return success();
 }
 
@@ -66,6 +103,7 @@ void tpu::Conv1DOp::deinit(InferenceParameter &p) {
     delete conv;
     p.handle = nullptr;
   }
+  p.cache.reset();
 }
 
 LogicalResult tpu::Conv1DOp::inference(InferenceParameter &p) {
@@ -85,30 +123,16 @@ LogicalResult tpu::Conv1DOp::inference(InferenceParameter &p) {
     }
   } else if (module::isUniformQuantized(getOutput())) {
     int64_t n, c, h, w;
-    auto sType = module::getStorageType(getOutput());
     module::getNCHW(getOutput(), n, c, h, w);
-    auto o_qtype = module::getUniformQuantizedType(getOutput());
-    auto rshift_v = module::getI64Array(getRshift().value());
-    auto multiplier_v =
-        module::getI64Array(getMultiplier(), rshift_v->size(), 1);
-    bool per_axis = rshift_v->size() == c;
-    auto mode = getQuantMode();
-    bool is_tf = mode == tpu::RequantMode::QDM ||
-                 mode == tpu::RequantMode::TFLite ||
-                 mode == tpu::RequantMode::TFLite_LShift;
-    auto rmode = is_tf ? ROUNDING_HALF_AWAY_FROM_ZERO : ROUNDING_HALF_UP;
+    auto &cache = p.get_cache<Conv1DCache>();
 #pragma omp parallel for schedule(static, omp_schedule(c))
     for (int ic = 0; ic < c; ic++) {
-      int64_t shift = per_axis ? rshift_v->at(ic) : rshift_v->at(0);
-      int64_t multi = per_axis ? multiplier_v->at(ic) : multiplier_v->at(0);
+      int64_t shift = cache.rshift[ic];
+      int64_t multi = cache.multiplier[ic];
       for (int in = 0; in < n; in++) {
-        for (int hw = 0; hw < h * w; hw++) {
-          int offset = (in * c + ic) * h * w + hw;
-          auto v = applyMultiplierAndRShift(p.outputs[0][offset], multi, shift,
-                                            mode, rmode) +
-                   o_qtype.getZeroPoint();
-          p.outputs[0][offset] = saturate(v, sType);
-        }
+        requant_int8(p.outputs[0] + (in * c + ic) * h * w, h * w, 0, multi,
+                     shift, cache.zero_point, false, out_type, cache.qmode,
+                     cache.rmode);
       }
     }
   }
@@ -128,6 +152,18 @@ LogicalResult tpu::Conv1DOp::BackwardH(int64_t &in_idx, int64_t &in_slice,
   return success();
 }
 
+LogicalResult tpu::Conv1DOp::BackwardW(int64_t &in_idx, int64_t &in_slice,
+                                       int64_t out_idx, int64_t out_slice) {
+  auto attr = parseParam();
+  int kw_with_dw = (attr.kw - 1) * attr.dw + 1;
+  in_slice = (out_slice - 1) * attr.sw +
+             (kw_with_dw >= attr.sw ? kw_with_dw : attr.sw);
+  in_idx = out_idx * attr.sw - attr.pwl;
+  bool is_last = (out_idx + out_slice == attr.ow);
+  LocalGenInterface::fixSlice(in_idx, in_slice, attr.iw, is_last);
+  return success();
+}
+
 void tpu::Conv1DOp::assign_sec_info(int64_t n_step, int64_t h_step,
                                     group_type_t group_type,
                                     local_sec_info_t &sec_info) {
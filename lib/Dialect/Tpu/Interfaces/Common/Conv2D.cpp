@@ -60,6 +60,18 @@ conv_attr_t tpu::Conv2DOp::parseParam() {
   return p;
 }
 
+namespace {
+// per channel requant of the quantized conv
+struct Conv2DCache : public InferenceCache {
+  std::vector<int64_t> multiplier, rshift;
+  std::shared_ptr<std::vector<int32_t>> bias_i32;
+  int64_t zero_point = 0;
+  bool do_relu = false;
+  tpu::RequantMode qmode;
+  RoundingMode rmode;
+};
+} // namespace
+
 LogicalResult tpu::Conv2DOp::init(InferenceParameter &p) {
   auto conv = new Conv();
   auto attr = parseParam();
@@ -69,8 +81,44 @@ LogicalResult tpu::Conv2DOp::init(InferenceParameter &p) {
       p.inputs[2][i] = 0.f;
     }
   }
-  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr);
+  int64_t K = attr.ic / attr.groups * attr.kd * attr.kh * attr.kw;
+  auto src_dt = attr.kernel_zp == 0
+                    ? getDnnlInt8Type(getInput(), getFilter(), K, getBias())
+                    : memory::data_type::f32;
+  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr,
+              module::isWeight(getFilter()), src_dt);
   p.handle = (void *)conv;
+  if (module::isUniformQuantized(getOutput())) {
+    auto &cache = p.make_cache<Conv2DCache>();
+    int64_t c = attr.oc;
+    auto rshift_v = module::getI64Array(getRshift().value());
+    auto multiplier_v =
+        module::getI64Array(getMultiplier(), rshift_v->size(), 1);
+    bool per_axis = rshift_v->size() == c;
+    cache.qmode = getQuantMode();
+    cache.rshift.resize(c);
+    cache.multiplier.resize(c, 1);
+    for (int ic = 0; ic < c; ic++) {
+      cache.rshift[ic] = per_axis ? rshift_v->at(ic) : rshift_v->at(0);
+      if (cache.qmode != tpu::RequantMode::OnlyShift) {
+        cache.multiplier[ic] =
+            per_axis ? multiplier_v->at(ic) : multiplier_v->at(0);
+      }
+    }
+    // do bias after conv prevent precision issue
+    cache.bias_i32 = std::make_shared<std::vector<int32_t>>(c, 0);
+    if (getWithBias()) {
+      auto biasOp = cast<top::WeightOp>(getBias().getDefiningOp());
+      cache.bias_i32 = biasOp.read_as_int32();
+    }
+    cache.do_relu = getDoRelu();
+    cache.zero_point =
+        module::getUniformQuantizedType(getOutput()).getZeroPoint();
+    bool is_tf = cache.qmode == tpu::RequantMode::QDM ||
+                 cache.qmode == tpu::RequantMode::TFLite ||
+                 cache.qmode == tpu::RequantMode::TFLite_LShift;
+    cache.rmode = is_tf ? ROUNDING_HALF_AWAY_FROM_ZERO : ROUNDING_HALF_UP;
+  }
   return success();
 }
 
@@ -80,6 +128,7 @@ void tpu::Conv2DOp::deinit(InferenceParameter &p) {
     delete conv;
     p.handle = nullptr;
   }
+  p.cache.reset();
 }
 
 LogicalResult tpu::Conv2DOp::inference(InferenceParameter &p) {
@@ -99,46 +148,17 @@ LogicalResult tpu::Conv2DOp::inference(InferenceParameter &p) {
     }
   } else if (module::isUniformQuantized(getOutput())) {
     int64_t n, c, h, w;
-    auto sType = module::getStorageType(getOutput());
     module::getNCHW(getOutput(), n, c, h, w);
-    auto o_qtype = module::getUniformQuantizedType(getOutput());
-    auto rshift_v = module::getI64Array(getRshift().value());
-    auto multiplier_v =
-        module::getI64Array(getMultiplier(), rshift_v->size(), 1);
-    bool per_axis = rshift_v->size() == c;
-    // do bias after conv prevent precision issue
-    auto bias_i32 = std::make_shared<std::vector<int32_t>>(c, 0);
-    bool do_relu = getDoRelu();
-    if (getWithBias()) {
-      auto biasOp = cast<top::WeightOp>(getBias().getDefiningOp());
-      bias_i32 = biasOp.read_as_int32();
-    }
-    auto qmode = getQuantMode();
-    bool is_tf = qmode == tpu::RequantMode::QDM ||
-                 qmode == tpu::RequantMode::TFLite ||
-                 qmode == tpu::RequantMode::TFLite_LShift;
-    auto rmode = is_tf ? ROUNDING_HALF_AWAY_FROM_ZERO : ROUNDING_HALF_UP;
-
+    auto &cache = p.get_cache<Conv2DCache>();
 #pragma omp parallel for schedule(static, omp_schedule(c))
     for (int ic = 0; ic < c; ic++) {
-      int64_t shift = per_axis ? rshift_v->at(ic) : rshift_v->at(0);
-      int64_t multi = 1;
-      if (qmode != tpu::RequantMode::OnlyShift) {
-        multi = per_axis ? multiplier_v->at(ic) : multiplier_v->at(0);
-      }
-      int32_t bias = bias_i32->at(ic);
+      int64_t shift = cache.rshift[ic];
+      int64_t multi = cache.multiplier[ic];
+      int32_t bias = cache.bias_i32->at(ic);
       for (int in = 0; in < n; in++) {
-        for (int hw = 0; hw < h * w; hw++) {
-          int offset = (in * c + ic) * h * w + hw;
-          int64_t v = 0;
-          int64_t tmp = p.outputs[0][offset] + bias;
-          v = applyMultiplierAndRShift(tmp, multi, shift, qmode, rmode) +
-              o_qtype.getZeroPoint();
-          if (do_relu && (v < 0)) {
-            v = 0;
-          }
-          p.outputs[0][offset] = saturate(v, out_type);
-        }
+        requant_int8(p.outputs[0] + (in * c + ic) * h * w, h * w, bias, multi,
+                     shift, cache.zero_point, cache.do_relu, out_type,
+                     cache.qmode, cache.rmode);
       }
     }
   }
@@ -158,6 +178,18 @@ LogicalResult tpu::Conv2DOp::BackwardH(int64_t &in_idx, int64_t &in_slice,
   return success();
 }
 
+LogicalResult tpu::Conv2DOp::BackwardW(int64_t &in_idx, int64_t &in_slice,
+                                       int64_t out_idx, int64_t out_slice) {
+  auto &attr = getConv2DParam(*this);
+  int kw_with_dw = (attr.kw - 1) * attr.dw + 1;
+  in_slice = (out_slice - 1) * attr.sw +
+             (kw_with_dw >= attr.sw ? kw_with_dw : attr.sw);
+  in_idx = out_idx * attr.sw - attr.pwl;
+  bool is_last = (out_idx + out_slice == attr.ow);
+  LocalGenInterface::fixSlice(in_idx, in_slice, attr.iw, is_last);
+  return success();
+}
+
 void tpu::Conv2DOp::assign_sec_info(int64_t n_step, int64_t h_step,
                                     group_type_t group_type,
                                     local_sec_info_t &sec_info) {
@@ -168,22 +200,32 @@ void tpu::Conv2DOp::assign_sec_info(int64_t n_step, int64_t h_step,
   auto gi = getGroupInfo(n_step, h_step);
   auto in_gi = LocalGenInterface::getGroupInfo(getInput(), n_step, h_step);
   int64_t pad_h_b = (in_gi.h_idx + in_gi.h_slice == attr.ih ? attr.phb : 0);
+  int64_t pad_w_r = (in_gi.w_idx + in_gi.w_slice == attr.iw ? attr.pwr : 0);
   sec_info.n_slice = in_gi.n_slice;
   sec_info.h_slice = in_gi.h_slice;
   sec_info.h_idx = in_gi.h_idx;
   sec_info.is_h_split = !(in_gi.h_idx == 0 && in_gi.h_slice == attr.ih);
   // to be compatible with nntoolchain
   if (sec_info.is_h_split) {
-    sec_info.h_idx = h_step == 0 ? -attr.pht : in_gi.h_idx;
+    sec_info.h_idx = gi.h_idx == 0 ? -attr.pht : in_gi.h_idx;
     sec_info.h_slice = sec_info.h_idx < 0 ? sec_info.h_slice - sec_info.h_idx
                                           : sec_info.h_slice;
     sec_info.h_slice = sec_info.h_slice + pad_h_b;
   }
-  sec_info.w_slice = attr.iw;
+  sec_info.w_slice = in_gi.w_slice;
+  sec_info.w_idx = in_gi.w_idx;
+  sec_info.is_w_split = !(in_gi.w_idx == 0 && in_gi.w_slice == attr.iw);
+  if (sec_info.is_w_split) {
+    sec_info.w_idx = gi.w_idx == 0 ? -attr.pwl : in_gi.w_idx;
+    sec_info.w_slice = sec_info.w_idx < 0 ? sec_info.w_slice - sec_info.w_idx
+                                          : sec_info.w_slice;
+    sec_info.w_slice = sec_info.w_slice + pad_w_r;
+  }
   sec_info.out_n_slice = gi.n_slice;
   sec_info.out_h_idx = gi.h_idx;
   sec_info.out_h_slice = gi.h_slice;
-  sec_info.out_w_slice = attr.ow;
+  sec_info.out_w_idx = gi.w_idx;
+  sec_info.out_w_slice = gi.w_slice;
 }
 
 mlir::Type tpu::Conv2DOp::type_verify(uint64_t opd_idx, TypeCastMode &mode) {
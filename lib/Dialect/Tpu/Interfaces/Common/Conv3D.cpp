@@ -71,7 +71,12 @@ LogicalResult tpu::Conv3DOp::init(InferenceParameter &p) {
   auto conv = new Conv();
   auto attr = parseParam();
 
-  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr);
+  int64_t K = attr.ic / attr.groups * attr.kd * attr.kh * attr.kw;
+  auto src_dt = attr.kernel_zp == 0
+                    ? getDnnlInt8Type(getInput(), getFilter(), K, getBias())
+                    : memory::data_type::f32;
+  conv->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], attr,
+              module::isWeight(getFilter()), src_dt);
   p.handle = (void *)conv;
   return success();
 }
@@ -116,6 +121,18 @@ LogicalResult tpu::Conv3DOp::BackwardH(int64_t &in_idx, int64_t &in_slice,
   return success();
 }
 
+LogicalResult tpu::Conv3DOp::BackwardW(int64_t &in_idx, int64_t &in_slice,
+                                       int64_t out_idx, int64_t out_slice) {
+  auto attr = parseParam();
+  int kw_with_dw = (attr.kw - 1) * attr.dw + 1;
+  in_slice = (out_slice - 1) * attr.sw +
+             (kw_with_dw >= attr.sw ? kw_with_dw : attr.sw);
+  in_idx = out_idx * attr.sw - attr.pwl;
+  bool is_last = (out_idx + out_slice == attr.ow);
+  LocalGenInterface::fixSlice(in_idx, in_slice, attr.iw, is_last);
+  return success();
+}
+
 void tpu::Conv3DOp::assign_sec_info(int64_t n_step, int64_t h_step,
                                     group_type_t group_type,
                                     local_sec_info_t &sec_info) {
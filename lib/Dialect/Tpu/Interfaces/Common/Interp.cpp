@@ -201,42 +201,56 @@ void interp_core(
         }
     }
 }
-LogicalResult tpu::InterpOp::init(InferenceParameter &p) { return success(); }
-void tpu::InterpOp::deinit(InferenceParameter &p) {}
 
-LogicalResult tpu::InterpOp::inference(InferenceParameter &p) {
-      int64_t n, c, ih, iw, oh, ow;
-    module::getNCHW(getInput(), n, c, ih, iw);
-    module::getNCHW(getOutput(), n, c, oh, ow);
-    PLATFORM_SUPPORT platform_sp;
+namespace {
+struct InterpCache : public InferenceCache {
+  int64_t n, c, ih, iw, oh, ow;
+  bool align_corners = false, half_pixel = false;
+  PLATFORM_SUPPORT platform_sp;
+};
+} // namespace
+
+LogicalResult tpu::InterpOp::init(InferenceParameter &p) {
+    auto &cache = p.make_cache<InterpCache>();
+    module::getNCHW(getInput(), cache.n, cache.c, cache.ih, cache.iw);
+    module::getNCHW(getOutput(), cache.n, cache.c, cache.oh, cache.ow);
     int coord = 0;
-    bool align_corners = (getCoordMode() == tpu::ResizeCoordMode::align_corners);
-    bool half_pixel = (getCoordMode() == tpu::ResizeCoordMode::half_pixel);
-    if (getCoordMode() == tpu::ResizeCoordMode::half_pixel)
+    auto coord_mode = getCoordMode();
+    cache.align_corners = (coord_mode == tpu::ResizeCoordMode::align_corners);
+    cache.half_pixel = (coord_mode == tpu::ResizeCoordMode::half_pixel);
+    if (coord_mode == tpu::ResizeCoordMode::half_pixel)
         coord = 0;
-    else if (getCoordMode() == tpu::ResizeCoordMode::pytorch_half_pixel)
+    else if (coord_mode == tpu::ResizeCoordMode::pytorch_half_pixel)
         coord = 1;
-    else if (getCoordMode() == tpu::ResizeCoordMode::align_corners)
+    else if (coord_mode == tpu::ResizeCoordMode::align_corners)
         coord = 2;
-    const int in_hw = ih * iw;
-    const int out_hw = oh * ow;
     if (getMode() == tpu::ResizeMode::nearest) {
-        platform_sp = ONNX_NEAREST;
-        align_corners = true;
-        half_pixel = false;
+        cache.platform_sp = ONNX_NEAREST;
+        cache.align_corners = true;
+        cache.half_pixel = false;
     } else if (getMode() == tpu::ResizeMode::linear) {
-        platform_sp = PYTORCH_SUPPORT;
-        align_corners = (coord == 2) ? 1: 0;
-        half_pixel = (coord == 0 || coord == 1) ? 1 : 0;
+        cache.platform_sp = PYTORCH_SUPPORT;
+        cache.align_corners = (coord == 2) ? 1: 0;
+        cache.half_pixel = (coord == 0 || coord == 1) ? 1 : 0;
     }
+    return success();
+}
+void tpu::InterpOp::deinit(InferenceParameter &p) { p.cache.reset(); }
+
+LogicalResult tpu::InterpOp::inference(InferenceParameter &p) {
+    auto &cache = p.get_cache<InterpCache>();
+    const int64_t n = cache.n, c = cache.c;
+    const int64_t ih = cache.ih, iw = cache.iw, oh = cache.oh, ow = cache.ow;
+    const int in_hw = ih * iw;
+    const int out_hw = oh * ow;
 
 #pragma omp parallel for schedule(static, omp_schedule(n*c))
     for (int i = 0; i < n *c ; i++){
         interp_core<float>(p.inputs[0] + i * in_hw,
                             p.outputs[0] + i * out_hw,
-                            ih, iw, oh, ow, 0, 0, align_corners,
-                            half_pixel,
-                            platform_sp);
+                            ih, iw, oh, ow, 0, 0, cache.align_corners,
+                            cache.half_pixel,
+                            cache.platform_sp);
     }
     return success();
 }
@@ -73,46 +73,28 @@ static void lstm_compute(InferenceParameter &p, const lstm_attr_t &attr,
     last_c += attr.batch_size * attr.hidden_size;
   }
 
-  float *r_wo = r_wi + attr.hidden_size * attr.hidden_size;
-  float *r_wf = r_wo + attr.hidden_size * attr.hidden_size;
-  float *r_wc = r_wf + attr.hidden_size * attr.hidden_size;
-
-  float *r_bo = r_bi + attr.hidden_size;
-  float *r_bf = r_bo + attr.hidden_size;
-  float *r_bc = r_bf + attr.hidden_size;
-
-  std::vector<float> gate_i(attr.batch_size * attr.hidden_size);
-  std::vector<float> gate_o(attr.batch_size * attr.hidden_size);
-  std::vector<float> gate_f(attr.batch_size * attr.hidden_size);
-  std::vector<float> gate_c(attr.batch_size * attr.hidden_size);
+  // recurrence of gates i/o/f/c as one [4 * hidden_size] GEMM, the input
+  // projection is already done before this op
+  int64_t gate_size = 4 * attr.hidden_size;
+  std::vector<float> gates(attr.batch_size * gate_size);
 
   for (int s = 0; s < attr.seq_len; s++) {
     int seq_idx = forward ? s : (attr.seq_len - s - 1);
     float *x = input + seq_idx * attr.batch_size * attr.input_size;
 
-    dnnl_mm(h, r_wi, r_bi, gate_i.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, r_wo, r_bo, gate_o.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, r_wf, r_bf, gate_f.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-    dnnl_mm(h, r_wc, r_bc, gate_c.data(), attr.batch_size, attr.hidden_size,
-            attr.hidden_size, false);
-
-    BF16(gate_i.data(), gate_i.data(), gate_i.size());
-    BF16(gate_o.data(), gate_o.data(), gate_o.size());
-    BF16(gate_f.data(), gate_f.data(), gate_f.size());
-    BF16(gate_c.data(), gate_c.data(), gate_c.size());
+    dnnl_mm(h, r_wi, r_bi, gates.data(), attr.batch_size, attr.hidden_size,
+            gate_size, false);
+    BF16(gates.data(), gates.data(), gates.size());
 
     for (int batch = 0; batch < attr.batch_size; batch++) {
       float *xi = x + batch * attr.input_size;
       float *xo = xi + attr.hidden_size;
       float *xf = xo + attr.hidden_size;
       float *xc = xf + attr.hidden_size;
-      float *gi = gate_i.data() + batch * attr.hidden_size;
-      float *go = gate_o.data() + batch * attr.hidden_size;
-      float *gf = gate_f.data() + batch * attr.hidden_size;
-      float *gc = gate_c.data() + batch * attr.hidden_size;
+      float *gi = gates.data() + batch * gate_size;
+      float *go = gi + attr.hidden_size;
+      float *gf = go + attr.hidden_size;
+      float *gc = gf + attr.hidden_size;
       float *cell_state = c + batch * attr.hidden_size;
       float *hidden_state = h + batch * attr.hidden_size;
       if (attr.output_y) {
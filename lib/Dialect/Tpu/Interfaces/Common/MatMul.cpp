@@ -58,14 +58,59 @@ matmul_attr_t tpu::MatMulOp::parseParam() {
   return p;
 }
 
+namespace {
+// requant of the quantized matmul, one multiplier and rshift per batch
+struct MatMulCache : public InferenceCache {
+  std::vector<int64_t> multiplier, rshift;
+  int64_t zero_point = 0;
+  int64_t batch = 1, isz = 0;
+  tpu::RequantMode qmode;
+};
+} // namespace
+
 LogicalResult tpu::MatMulOp::init(InferenceParameter &p) {
   auto matmul = new MatMul();
   auto a = parseParam();
 
+  auto left_dt = (a.input_zp == 0 && a.right_zp == 0)
+                     ? getDnnlInt8Type(getInput(), getRight(), a.K, getBias())
+                     : memory::data_type::f32;
   matmul->setup(p.inputs[0], p.inputs[1], p.inputs[2], p.outputs[0], a.batch,
                 a.M, a.K, a.N, a.do_relu, a.relu_limit, a.right_zp,
-                a.right_transpose, a.input_zp);
+                a.right_transpose, a.input_zp, module::isWeight(getRight()),
+                left_dt);
   p.handle = (void *)matmul;
+  if (module::isUniformQuantized(getOutput())) {
+    auto &cache = p.make_cache<MatMulCache>();
+    cache.qmode = getQuantMode();
+    if (module::isCV18xx()) {
+      bool is_fc = isa<top::WeightOp>(getRight().getDefiningOp());
+      i64_array_t rshift_v;
+      i64_array_t multiplier_v;
+      if (is_fc) {
+        rshift_v = module::getI64Array(getRshifts(), a.batch, 0);
+        multiplier_v = module::getI64Array(getMultipliers(), a.batch, 1);
+      } else {
+        rshift_v = module::getI64Array(getRshifts(), 1, 0);
+        multiplier_v = module::getI64Array(getMultipliers(), 1, 1);
+        rshift_v->resize(a.batch, rshift_v->at(0));
+        multiplier_v->resize(a.batch, multiplier_v->at(0));
+      }
+      cache.batch = a.batch;
+      cache.isz = a.M * a.N;
+      cache.rshift = *rshift_v;
+      cache.multiplier = *multiplier_v;
+    } else {
+      auto rshift_v = module::getI64Array(getRshifts(), 1, 0);
+      auto multiplier_v = module::getI64Array(getMultipliers(), 1, 1);
+      assert(rshift_v->size() == 1);
+      assert(multiplier_v->size() == 1);
+      cache.rshift = *rshift_v;
+      cache.multiplier = *multiplier_v;
+      cache.zero_point =
+          module::getUniformQuantizedType(getOutput()).getZeroPoint();
+    }
+  }
   return success();
 }
 
@@ -75,6 +120,7 @@ void tpu::MatMulOp::deinit(InferenceParameter &p) {
     delete matmul;
     p.handle = nullptr;
   }
+  p.cache.reset();
   return;
 }
 
@@ -95,40 +141,25 @@ LogicalResult tpu::MatMulOp::inference(InferenceParameter &p) {
       F16(p.outputs[0], p.outputs[0], num_elem);
     }
   } else if (module::isUniformQuantized(getOutput())) {
-    auto qmode = getQuantMode();
+    auto &cache = p.get_cache<MatMulCache>();
+    auto qmode = cache.qmode;
     if (is_cv18xx) {
-      auto a = parseParam();
-      bool is_fc = isa<top::WeightOp>(getRight().getDefiningOp());
-      i64_array_t rshift_v;
-      i64_array_t multiplier_v;
-      if (is_fc) {
-        rshift_v = module::getI64Array(getRshifts(), a.batch, 0);
-        multiplier_v = module::getI64Array(getMultipliers(), a.batch, 1);
-      } else {
-        rshift_v = module::getI64Array(getRshifts(), 1, 0);
-        multiplier_v = module::getI64Array(getMultipliers(), 1, 1);
-        rshift_v->resize(a.batch, rshift_v->at(0));
-        multiplier_v->resize(a.batch, multiplier_v->at(0));
-      }
-      int64_t isz = a.M * a.N;
-      for (int64_t i = 0; i < a.batch; ++i) {
+      int64_t isz = cache.isz;
+      for (int64_t i = 0; i < cache.batch; ++i) {
 #pragma omp parallel for schedule(static, omp_schedule(isz))
         for (int64_t j = 0; j < isz; ++j) {
           int64_t offset = i * isz + j;
           int64_t v = 0;
           v = applyMultiplierAndRShift(p.outputs[0][offset],
-                                       multiplier_v->at(i), rshift_v->at(i),
+                                       cache.multiplier[i], cache.rshift[i],
                                        qmode, ROUNDING_HALF_AWAY_FROM_ZERO);
           p.outputs[0][offset] = saturate(v, out_type);
         }
       }
     } else {
-      auto o_qtype = module::getUniformQuantizedType(getOutput());
-      auto rshift_v = module::getI64Array(getRshifts(), 1, 0);
-      auto multiplier_v = module::getI64Array(getMultipliers(), 1, 1);
-      assert(rshift_v->size() == 1);
-      assert(multiplier_v->size() == 1);
-      auto num_output = module::getNumElements(getOutput());
+      int64_t multi = cache.multiplier[0];
+      int64_t rshift = cache.rshift[0];
+      auto num_output = num_elem;
       if (qmode == tpu::RequantMode::TFLite_LShift ||
           qmode == tpu::RequantMode::TFLite) {
 #pragma omp parallel for schedule(static, omp_schedule(num_output))
@@ -136,18 +167,19 @@ LogicalResult tpu::MatMulOp::inference(InferenceParameter &p) {
           // auto v = (((int64_t)(p.outputs[0][i] * mlti) + (1 << (rft - 1))) >>
           // rft);
           auto v = MultiplyByQuantizedMultiplier((int32_t)(p.outputs[0][i]),
-                                                 (int32_t)multiplier_v->at(0),
-                                                 -(int32_t)rshift_v->at(0)) +
-                   o_qtype.getZeroPoint();
+                                                 (int32_t)multi,
+                                                 -(int32_t)rshift) +
+                   cache.zero_point;
           p.outputs[0][i] = saturate(v, out_type);
         }
       } else if (qmode == tpu::RequantMode::MultiplierShift) {
-#pragma omp parallel for schedule(static, omp_schedule(num_output))
-        for (int i = 0; i < num_output; ++i) {
-          auto v = applyMultiplierAndRShift(
-                       p.outputs[0][i], multiplier_v->at(0), rshift_v->at(0)) +
-                   o_qtype.getZeroPoint();
-          p.outputs[0][i] = saturate(v, out_type);
+        int64_t block = 1024;
+        int64_t num_block = (num_output + block - 1) / block;
+#pragma omp parallel for schedule(static, omp_schedule(num_block))
+        for (int64_t b = 0; b < num_block; ++b) {
+          int64_t len = std::min(block, num_output - b * block);
+          requant_int8(p.outputs[0] + b * block, len, 0, multi, rshift,
+                       cache.zero_point, false, out_type, qmode);
         }
       }
     }
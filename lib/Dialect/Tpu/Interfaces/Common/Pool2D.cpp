@@ -54,7 +54,11 @@ LogicalResult tpu::Pool2DOp::init(InferenceParameter &p) {
   if (dtype.isa<quant::UniformQuantizedType>() && is_avg_pooling) {
     izp = dtype.cast<quant::UniformQuantizedType>().getZeroPoint();
   }
-  pooling->setup(p.inputs[0], p.outputs[0], attr, is_avg_pooling, izp);
+  // max pooling only picks one of the inputs, so it is exact on int8 data
+  auto dt = !is_avg_pooling && module::getStorageType(getInput()).isInteger(8)
+                ? getDnnlType(getInput())
+                : memory::data_type::f32;
+  pooling->setup(p.inputs[0], p.outputs[0], attr, is_avg_pooling, izp, dt);
   p.handle = (void *)pooling;
   return success();
 }
@@ -163,6 +167,24 @@ LogicalResult tpu::Pool2DOp::BackwardH(int64_t &in_idx, int64_t &in_slice,
   return success();
 }
 
+LogicalResult tpu::Pool2DOp::BackwardW(int64_t &in_idx, int64_t &in_slice,
+                                       int64_t out_idx, int64_t out_slice) {
+  auto &attr = getPool2DParam(*this);
+  if (attr.is_global) {
+    if (out_idx != 0 || out_slice != attr.ow) {
+      return failure();
+    }
+    in_idx = 0;
+    in_slice = attr.iw;
+    return success();
+  }
+  in_slice = (out_slice - 1) * attr.sw + attr.kw;
+  in_idx = out_idx * attr.sw - attr.pad_w;
+  bool is_last = (out_idx + out_slice == attr.ow);
+  LocalGenInterface::fixSlice(in_idx, in_slice, attr.iw, is_last);
+  return success();
+}
+
 void tpu::Pool2DOp::assign_sec_info(int64_t n_step, int64_t h_step,
                                     group_type_t group_type,
                                     local_sec_info_t &sec_info) {
@@ -174,23 +196,35 @@ void tpu::Pool2DOp::assign_sec_info(int64_t n_step, int64_t h_step,
   auto in_gi = LocalGenInterface::getGroupInfo(getInput(), n_step, h_step);
   int64_t pad_h_b =
       (in_gi.h_idx + in_gi.h_slice == attr.ih ? attr.pad_h_after : 0);
+  int64_t pad_w_r =
+      (in_gi.w_idx + in_gi.w_slice == attr.iw ? attr.pad_w_after : 0);
   sec_info.n_slice = in_gi.n_slice;
   sec_info.h_slice = in_gi.h_slice;
   sec_info.h_idx = in_gi.h_idx;
   sec_info.is_h_split = !(in_gi.h_idx == 0 && in_gi.h_slice == attr.ih);
   // to be compatible with nntoolchain
   if (sec_info.is_h_split) {
-    sec_info.h_idx = h_step == 0 ? -attr.pad_h : in_gi.h_idx;
+    sec_info.h_idx = gi.h_idx == 0 ? -attr.pad_h : in_gi.h_idx;
     sec_info.h_slice = sec_info.h_idx < 0
                             ? sec_info.h_slice - sec_info.h_idx
                             : sec_info.h_slice;
     sec_info.h_slice = sec_info.h_slice + pad_h_b;
   }
-  sec_info.w_slice = attr.iw;
+  sec_info.w_slice = in_gi.w_slice;
+  sec_info.w_idx = in_gi.w_idx;
+  sec_info.is_w_split = !(in_gi.w_idx == 0 && in_gi.w_slice == attr.iw);
+  if (sec_info.is_w_split) {
+    sec_info.w_idx = gi.w_idx == 0 ? -attr.pad_w : in_gi.w_idx;
+    sec_info.w_slice = sec_info.w_idx < 0
+                            ? sec_info.w_slice - sec_info.w_idx
+                            : sec_info.w_slice;
+    sec_info.w_slice = sec_info.w_slice + pad_w_r;
+  }
   sec_info.out_n_slice = gi.n_slice;
   sec_info.out_h_idx = gi.h_idx;
   sec_info.out_h_slice = gi.h_slice;
-  sec_info.out_w_slice = attr.ow;
+  sec_info.out_w_idx = gi.w_idx;
+  sec_info.out_w_slice = gi.w_slice;
 }
 
 LogicalResult tpu::Pool2DOp::DynBackwardH(int64_t &in_idx, int64_t &in_slice,
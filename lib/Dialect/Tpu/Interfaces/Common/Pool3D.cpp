@@ -62,7 +62,11 @@ LogicalResult tpu::Pool3DOp::init(InferenceParameter &p) {
   if (dtype.isa<quant::UniformQuantizedType>() && is_avg_pooling) {
     izp = dtype.cast<quant::UniformQuantizedType>().getZeroPoint();
   }
-  pooling->setup(p.inputs[0], p.outputs[0], attr, is_avg_pooling, izp);
+  // max pooling only picks one of the inputs, so it is exact on int8 data
+  auto dt = !is_avg_pooling && module::getStorageType(getInput()).isInteger(8)
+                ? getDnnlType(getInput())
+                : memory::data_type::f32;
+  pooling->setup(p.inputs[0], p.outputs[0], attr, is_avg_pooling, izp, dt);
   p.handle = (void *)pooling;
   return success();
 }
@@ -137,6 +141,16 @@ LogicalResult tpu::Pool3DOp::BackwardH(int64_t &in_idx, int64_t &in_slice,
   return success();
 }
 
+LogicalResult tpu::Pool3DOp::BackwardW(int64_t &in_idx, int64_t &in_slice,
+                                       int64_t out_idx, int64_t out_slice) {
+  auto attr = parseParam();
+  in_slice = (out_slice - 1) * attr.sw + attr.kw;
+  in_idx = out_idx * attr.sw - attr.pad_w;
+  bool is_last = (out_idx + out_slice == attr.ow);
+  LocalGenInterface::fixSlice(in_idx, in_slice, attr.iw, is_last);
+  return success();
+}
+
 void tpu::Pool3DOp::assign_sec_info(int64_t n_step, int64_t h_step,
                                     group_type_t group_type,
                                     local_sec_info_t &sec_info) {
@@ -15,24 +15,34 @@
 
 
 
+namespace {
+struct RequantFpCache : public InferenceCache {
+  tpu::RequantMode mode;
+  float scale = 1.f, offset = 0.f;
+  int64_t zero_point = 0;
+};
+} // namespace
+
 LogicalResult tpu::RequantFpOp::init(InferenceParameter &p) {
+  auto &cache = p.make_cache<RequantFpCache>();
+  cache.mode = getQuantMode();
+  cache.scale = getScale().convertToDouble();
+  cache.offset = getOffset().convertToDouble();
+  cache.zero_point =
+      module::getUniformQuantizedType(getOutput()).getZeroPoint();
   return success();
 }
-void tpu::RequantFpOp::deinit(InferenceParameter &p) {}
+void tpu::RequantFpOp::deinit(InferenceParameter &p) { p.cache.reset(); }
 
 LogicalResult tpu::RequantFpOp::inference(InferenceParameter &p) {
   auto o_sType = module::getStorageType(getOutput());
-  auto o_qtype = module::getUniformQuantizedType(getOutput());
-  auto mode = getQuantMode();
-  auto shape = module::getShape(getOutput());
-  int64_t length = 1;
-  for (int i = 0; i < shape.size(); ++i) {
-    length *= shape[i];
-  }
+  auto &cache = p.get_cache<RequantFpCache>();
+  auto mode = cache.mode;
+  int64_t length = module::getNumElements(getOutput());
 
-  float scale_v = getScale().convertToDouble();
-  float offset_v = getOffset().convertToDouble();
-  int64_t zero_point = o_qtype.getZeroPoint();
+  float scale_v = cache.scale;
+  float offset_v = cache.offset;
+  int64_t zero_point = cache.zero_point;
 
   switch (mode) {
   case RequantMode::TFLite:
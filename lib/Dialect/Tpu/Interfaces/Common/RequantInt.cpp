@@ -13,29 +13,42 @@
 
 #include "tpu_mlir/Support/MathUtils.h"
 
+namespace {
+struct RequantIntCache : public InferenceCache {
+  tpu::RequantMode mode;
+  int64_t multi = 1, shift_val = 0, zero_point = 0, zp_x = 0;
+};
+} // namespace
+
 LogicalResult tpu::RequantIntOp::init(InferenceParameter &p) {
+  auto &cache = p.make_cache<RequantIntCache>();
+  cache.mode = getQuantMode();
+  if (module::isUniformQuantized(getInput())) {
+    auto i_qtype = module::getUniformQuantizedType(getInput());
+    cache.zp_x = i_qtype.getZeroPoint();
+    assert(cache.mode == tpu::RequantMode::MultiplierShift);
+  }
+  cache.shift_val = -getRshift();
+  cache.multi = getMultiplier();
+  cache.zero_point =
+      module::getUniformQuantizedType(getOutput()).getZeroPoint();
   return success();
 }
-void tpu::RequantIntOp::deinit(InferenceParameter &p) {}
+void tpu::RequantIntOp::deinit(InferenceParameter &p) { p.cache.reset(); }
 
 LogicalResult tpu::RequantIntOp::inference(InferenceParameter &p) {
   auto o_sType = module::getStorageType(getOutput());
-  auto o_qtype = module::getUniformQuantizedType(getOutput());
-  auto mode = getQuantMode();
+  auto &cache = p.get_cache<RequantIntCache>();
+  auto mode = cache.mode;
   auto shape = module::getShape(getOutput());
   int64_t inner = 1;
   for (int i = 2; i < shape.size(); ++i) {
     inner *= shape[i];
   }
-  int64_t zp_x = 0;
-  if (module::isUniformQuantized(getInput())) {
-    auto i_qtype = module::getUniformQuantizedType(getInput());
-    zp_x = i_qtype.getZeroPoint();
-    assert(mode == tpu::RequantMode::MultiplierShift);
-  }
-  int64_t shift_val = -getRshift();
-  int64_t multi = getMultiplier();
-  int64_t zero_point = o_qtype.getZeroPoint();
+  int64_t zp_x = cache.zp_x;
+  int64_t shift_val = cache.shift_val;
+  int64_t multi = cache.multi;
+  int64_t zero_point = cache.zero_point;
 
   if (mode == tpu::RequantMode::TFLite_LShift ||
       mode == tpu::RequantMode::TFLite) {
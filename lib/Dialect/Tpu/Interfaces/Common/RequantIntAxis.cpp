@@ -13,35 +13,77 @@
 
 #include "tpu_mlir/Support/MathUtils.h"
 
+namespace {
+// multiplier, shift and zero point of each channel, decoded from quant
+struct RequantIntAxisCache : public InferenceCache {
+  tpu::RequantMode mode;
+  int64_t zp_x = 0;
+  bool quant_is_coeff = false;
+  std::vector<int64_t> multi, shift, zero_point;
+};
+} // namespace
+
+static void decode_quant(const float *quant, int64_t c,
+                         RequantIntAxisCache &cache) {
+  bool is_bm1686 = module::isBM1686();
+  cache.multi.resize(c);
+  cache.shift.resize(c);
+  cache.zero_point.resize(c);
+  for (int64_t i = 0; i < c; ++i) {
+    if (cache.mode == tpu::RequantMode::TFLite_LShift ||
+        cache.mode == tpu::RequantMode::TFLite) {
+      cache.multi[i] = quant[i * 3];
+      cache.shift[i] = quant[i * 3 + 1];
+      cache.zero_point[i] = quant[i * 3 + 2];
+    } else if (is_bm1686) {
+      cache.multi[i] = quant[i * 2];
+      uint32_t tmp = quant[i * 2 + 1];
+      cache.shift[i] = (int64_t)(-(char)(tmp & 0xff));
+      cache.zero_point[i] = (int64_t)(short)((tmp & 0xffff0000) >> 16);
+    } else {
+      cache.multi[i] = quant[i * 3];
+      cache.shift[i] = -quant[i * 3 + 1];
+      cache.zero_point[i] = quant[i * 3 + 2];
+    }
+  }
+}
+
 LogicalResult tpu::RequantIntAxisOp::init(InferenceParameter &p) {
+  auto &cache = p.make_cache<RequantIntAxisCache>();
+  cache.mode = getQuantMode();
+  if (module::isUniformQuantized(getInput())) {
+    auto i_qtype = module::getUniformQuantizedType(getInput());
+    cache.zp_x = i_qtype.getZeroPoint();
+    assert(cache.mode == tpu::RequantMode::MultiplierShift);
+  }
+  cache.quant_is_coeff = module::isWeight(getQuant());
+  if (cache.quant_is_coeff) {
+    decode_quant(p.inputs[1], module::getShape(getOutput())[1], cache);
+  }
   return success();
 }
-void tpu::RequantIntAxisOp::deinit(InferenceParameter &p) {}
+void tpu::RequantIntAxisOp::deinit(InferenceParameter &p) { p.cache.reset(); }
 
 LogicalResult tpu::RequantIntAxisOp::inference(InferenceParameter &p) {
-  auto i_sType = module::getStorageType(getInput());
   auto o_sType = module::getStorageType(getOutput());
-  auto o_qtype = module::getUniformQuantizedType(getOutput());
-
   auto shape = module::getShape(getOutput());
-  auto mode = getQuantMode();
+  auto &cache = p.get_cache<RequantIntAxisCache>();
+  if (!cache.quant_is_coeff) {
+    decode_quant(p.inputs[1], shape[1], cache);
+  }
+  auto mode = cache.mode;
   int64_t inner = 1;
   for (int i = 2; i < shape.size(); ++i) {
     inner *= shape[i];
   }
-  int64_t zp_x = 0;
-  if (module::isUniformQuantized(getInput())) {
-    auto i_qtype = module::getUniformQuantizedType(getInput());
-    zp_x = i_qtype.getZeroPoint();
-    assert(mode == tpu::RequantMode::MultiplierShift);
-  }
+  int64_t zp_x = cache.zp_x;
   if (mode == tpu::RequantMode::TFLite_LShift ||
       mode == tpu::RequantMode::TFLite) {
 #pragma omp parallel for schedule(static, omp_schedule(shape[1]))
     for (int c = 0; c < shape[1]; ++c) {
-      int64_t multi = p.inputs[1][c * 3];
-      int64_t shift_val = p.inputs[1][c * 3 + 1];
-      int64_t zero_point = p.inputs[1][c * 3 + 2];
+      int64_t multi = cache.multi[c];
+      int64_t shift_val = cache.shift[c];
+      int64_t zero_point = cache.zero_point[c];
       for (int n = 0; n < shape[0]; ++n) {
         for (int i = 0; i < inner; ++i) {
           int offset = (n * shape[1] + c) * inner + i;
@@ -55,17 +97,9 @@ LogicalResult tpu::RequantIntAxisOp::inference(InferenceParameter &p) {
   } else if (mode == tpu::RequantMode::MultiplierShift) {
 #pragma omp parallel for schedule(static, omp_schedule(shape[1]))
     for (int c = 0; c < shape[1]; ++c) {
-      int64_t multi, rshift_val, zero_point;
-      if (module::isBM1686()) {
-        multi = p.inputs[1][c * 2];
-        uint32_t tmp = p.inputs[1][c * 2 + 1];
-        rshift_val = (int64_t)(-(char)(tmp & 0xff));
-        zero_point = (int64_t)(short)((tmp & 0xffff0000) >> 16);
-      } else {
-        multi = p.inputs[1][c * 3];
-        rshift_val = -p.inputs[1][c * 3 + 1];
-        zero_point = p.inputs[1][c * 3 + 2];
-      }
+      int64_t multi = cache.multi[c];
+      int64_t rshift_val = cache.shift[c];
+      int64_t zero_point = cache.zero_point[c];
       for (int n = 0; n < shape[0]; ++n) {
         for (int i = 0; i < inner; ++i) {
           int offset = (n * shape[1] + c) * inner + i;
@@ -15,38 +15,53 @@
 #include "tpu_mlir/Support/LutFunc.h"
 #include "tpu_mlir/Support/MathUtils.h"
 
-LogicalResult tpu::SoftmaxOp::init(InferenceParameter &p) { return success(); }
-
-void tpu::SoftmaxOp::deinit(InferenceParameter &p) {}
-
-LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
+namespace {
+struct SoftmaxCache : public InferenceCache {
+  int outer_dim = 1, inner_dim = 1, channel = 1;
+  bool is_cv18xx = false, has_table = false, do_log = false;
+  // scale of the quantized input
+  float scale = 1.0f;
+};
+} // namespace
+
+LogicalResult tpu::SoftmaxOp::init(InferenceParameter &p) {
+  auto &cache = p.make_cache<SoftmaxCache>();
   auto axis_ = getAxis();
   auto input_shape = module::getShape(getInput());
-  auto out_type = module::getStorageType(getOutput());
-  auto num_elem = module::getNumElements(getOutput());
-  bool is_cv18xx = module::isCV18xx();
-
-  int outer_dim = 1;
   for (int i = 0; i < axis_; i++) {
-    outer_dim *= input_shape[i];
+    cache.outer_dim *= input_shape[i];
   }
-
-  int inner_dim = 1;
   for (int i = axis_ + 1; i < input_shape.size(); i++) {
-    inner_dim *= input_shape[i];
+    cache.inner_dim *= input_shape[i];
+  }
+  cache.channel = input_shape[axis_];
+  cache.is_cv18xx = module::isCV18xx();
+  cache.has_table = !module::isNone(getTable());
+  cache.do_log = getLog();
+  if (module::isUniformQuantized(getInput())) {
+    cache.scale = module::getUniformQuantizedType(getInput()).getScale();
   }
+  return success();
+}
 
-  int channel = input_shape[axis_];
-  bool has_table = !module::isNone(getTable());
+void tpu::SoftmaxOp::deinit(InferenceParameter &p) { p.cache.reset(); }
+
+LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
+  auto &cache = p.get_cache<SoftmaxCache>();
+  auto out_type = module::getStorageType(getOutput());
+  auto num_elem = module::getNumElements(getOutput());
+  bool is_cv18xx = cache.is_cv18xx;
+  int outer_dim = cache.outer_dim;
+  int inner_dim = cache.inner_dim;
+  int channel = cache.channel;
+  bool has_table = cache.has_table;
+  bool do_log = cache.do_log;
   if (out_type.isa<FloatType>()) {
-    float scale = 1.0f;
-    if (module::isUniformQuantized(getInput())) {
-      auto qtype = module::getUniformQuantizedType(getInput());
-      scale = qtype.getScale();
-    }
+    float scale = cache.scale;
     std::vector<float> max_arr(inner_dim);
     std::vector<float> sum_arr(inner_dim);
     std::vector<float> sub_arr(channel * inner_dim);
+    std::vector<float> ex_arr(is_cv18xx ? channel * inner_dim : 0);
 
     const auto bottom_data = p.inputs[0];
     auto top_data = p.outputs[0];
@@ -71,7 +86,6 @@ LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
           }
         }
         // e^x
-        std::vector<float> ex_arr(channel * inner_dim);
         bf16_lut_slope(sub_arr.data(), ex_arr.data(), sub_arr.size(),
                        p.inputs[1], p.inputs[2], -15, 15);
         // sum of (e^x)
@@ -86,7 +100,7 @@ LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
         // convert to bf16
         BF16(sum_arr.data(), sum_arr.data(), sum_arr.size());
 
-        std::string mehod = getLog() ? "log" : "mantissa";
+        std::string mehod = do_log ? "log" : "mantissa";
         bf16_lut_mantissa(sum_arr.data(), sum_arr.data(), sum_arr.size(),
                           p.inputs[3], p.inputs[4], mehod);
 
@@ -94,7 +108,7 @@ LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
         for (int j = 0; j < channel; ++j, c_offset += inner_dim) {
           for (int k = 0; k < inner_dim; k++) {
             auto idx = j * inner_dim + k;
-            if (getLog()) {
+            if (do_log) {
               top_data[c_offset + k] = sub_arr[idx] - sum_arr[k];
             } else {
               top_data[c_offset + k] = ex_arr[idx] * sum_arr[k];
@@ -117,7 +131,7 @@ LogicalResult tpu::SoftmaxOp::inference(InferenceParameter &p) {
         for (int j = 0; j < channel; ++j, c_offset += inner_dim) {
           for (int k = 0; k < inner_dim; k++) {
             top_data[c_offset + k] /= sum_arr[k];
-            if (getLog()) {
+            if (do_log) {
               top_data[c_offset + k] = std::log(top_data[c_offset + k]);
             }
           }
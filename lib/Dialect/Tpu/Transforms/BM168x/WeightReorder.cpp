@@ -19,14 +19,16 @@ using namespace mlir;
 namespace tpu_mlir {
 namespace bm1684x {
 
-void populateWeightReorderPatterns(RewritePatternSet *patterns) {
+void populateWeightReorderPatterns(RewritePatternSet *patterns,
+                                   conv_int8_prepared_t *prepared) {
+  patterns->add<WeightReorder<tpu::Conv2DOp, int8_t>>(patterns->getContext(),
+                                                      prepared);
   // clang-format off
   patterns->add<
     WeightReorder<tpu::Conv1DOp, int8_t>,
     WeightReorder<tpu::Conv1DOp, BFloat16Type>,
     WeightReorder<tpu::Conv1DOp, Float16Type>,
     WeightReorder<tpu::Conv1DOp, Float32Type>,
-    WeightReorder<tpu::Conv2DOp, int8_t>,
     WeightReorder<tpu::Conv2DOp, BFloat16Type>,
     WeightReorder<tpu::Conv2DOp, Float16Type>,
     WeightReorder<tpu::Conv2DOp, Float32Type>,
@@ -16,6 +16,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
+#include "omp.h"
 #include <elf.h>
 #include <fstream>
 #include <map>
@@ -214,7 +215,6 @@ CviTpuRoutine::CviTpuRoutine(flatbuffers::FlatBufferBuilder &fbb,
                              func::CallOp &call, int *layer_id,
                              std::string chip)
     : CviRoutine(fbb, true, chip) {
-  this->layer_id = layer_id;
   auto func = module::getFuncOp(call.getCallee());
   name = func.getName().str();
   func.walk([&](Operation *op) {
@@ -223,10 +223,13 @@ CviTpuRoutine::CviTpuRoutine(flatbuffers::FlatBufferBuilder &fbb,
     }
   });
   module::getInputsOutputs(call, inputs, outputs);
-  codeGen();
+  // reserve the layer ids of this routine, commands are generated later
+  layer_id_start = *layer_id;
+  *layer_id = codegen_ops(layer_id_start, true);
 }
 
-void CviTpuRoutine::codegen_for_group(GroupOp gOp) {
+void CviTpuRoutine::codegen_for_group(GroupOp gOp, int &layer_id,
+                                      bool dry_run) {
   auto nsecs = gOp.getNsecs();
   auto hsecs = gOp.getHsecs();
   auto swpipl_stage_num = gOp.getSwpiplStageNum();
@@ -269,7 +272,9 @@ void CviTpuRoutine::codegen_for_group(GroupOp gOp) {
     /* add for software pipeline */
     timestep_swpipl.write_swloop_buffer(nstep, hstep, swpipl_stage_num);
     for (uint32_t ts = 0; ts < timestep_num; ++ts) {
-      CV18xx::parallel_enable();
+      if (!dry_run) {
+        CV18xx::parallel_enable();
+      }
       auto cur_op_ids = timestep_table[ts];
       for (auto id : cur_op_ids) {
         auto lgOp = cast<LocalGenInterface>(group_ops[id]);
@@ -286,13 +291,17 @@ void CviTpuRoutine::codegen_for_group(GroupOp gOp) {
         // add prefix to each cmd in profile.txt
         std::string prefix = module::getName(group_ops[id]).str();
         if (ginfo.overstepped == false) {
-          CV18xx::set_layer_id(*layer_id);
-          lgOp.codegen_local_cv18xx(tensor_step->nstep, tensor_step->hstep,
-                                    *layer_id);
-          ++(*layer_id);
+          if (!dry_run) {
+            CV18xx::set_layer_id(layer_id);
+            lgOp.codegen_local_cv18xx(tensor_step->nstep, tensor_step->hstep,
+                                      layer_id);
+          }
+          ++layer_id;
         }
       } // ops, include Load/Store op
-      CV18xx::parallel_disable();
+      if (!dry_run) {
+        CV18xx::parallel_disable();
+      }
     } // timestep
 
     if (!draining_period) {
@@ -315,19 +324,26 @@ void CviTpuRoutine::codegen_for_group(GroupOp gOp) {
   }
 }
 
-void CviTpuRoutine::codeGen() {
+int CviTpuRoutine::codegen_ops(int layer_id, bool dry_run) {
   for (auto op : ops) {
     if (auto castOp = dyn_cast<GroupOp>(op)) {
-      codegen_for_group(castOp);
+      codegen_for_group(castOp, layer_id, dry_run);
     } else if (module::isOpInGroup(op)) {
       continue;
     } else if (auto castOp = dyn_cast<GlobalGenInterface>(op)) {
-      CV18xx::set_layer_id(*layer_id);
-      castOp.codegen_global_cv18xx(*layer_id);
-      ++(*layer_id);
+      if (!dry_run) {
+        CV18xx::set_layer_id(layer_id);
+        castOp.codegen_global_cv18xx(layer_id);
+      }
+      ++layer_id;
     }
     // sotre neuron
   }
+  return layer_id;
+}
+
+void CviTpuRoutine::codeGen() {
+  codegen_ops(layer_id_start, false);
   CV18xx::submit();
   CV18xx::read_cmdbuf(cmdbuf);
 }
@@ -356,6 +372,37 @@ CviModelBuilder::CviModelBuilder(ModuleOp &module) : fbb_(1024) {
     func.walk([&](top::WeightOp op) { weights.push_back(op); });
   }
   module::getInputsOutputs(inputs, outputs);
+  codegenRoutines(module);
+}
+
+void CviModelBuilder::codegenRoutines(ModuleOp &module) {
+  std::vector<CviTpuRoutine *> tpu_routines;
+  for (auto rt : routines_) {
+    if (rt->isTpuRoutine) {
+      tpu_routines.push_back((CviTpuRoutine *)rt);
+    }
+  }
+  if (tpu_routines.size() <= 1) {
+    for (auto rt : tpu_routines) {
+      rt->codeGen();
+    }
+    return;
+  }
+  // codegen of some ops compresses weights, load them before going parallel
+  auto dialect = module->getContext()->getLoadedDialect("top");
+  auto top_dialect = llvm::cast<top::TopDialect>(dialect);
+  if (top_dialect->wFile == nullptr) {
+    top_dialect->loadWeightFile(module::getWeightFile());
+  }
+  // each routine has its own cmdbuf and layer ids, so they are generated
+  // into separate cvikernel contexts, one per thread
+  int num_threads = std::min(omp_get_max_threads(), (int)tpu_routines.size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (int i = 0; i < (int)tpu_routines.size(); i++) {
+    CV18xx::ScopedContext scope;
+    tpu_routines[i]->codeGen();
+  }
+  CV18xx::release_idle_contexts();
 }
 
 void CviModelBuilder::addRoutine(func::CallOp &call, int *layer_id) {
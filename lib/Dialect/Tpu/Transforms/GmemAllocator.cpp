@@ -11,6 +11,7 @@
 #include "tpu_mlir/Support/Module.h"
 #include "tpu_mlir/Support/MathUtils.h"
 
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -67,6 +68,8 @@ void GmemAllocator::registerAllMethod() {
   registerMethod("FitFirstAssign", true);
   registerMethod("FitFirstAssign", false);
   registerMethod("OpSizeOrderAssign", true);
+  registerMethod("BestFitAssign", true);
+  registerMethod("GreedyByBreadthAssign", true);
 }
 
 int64_t GmemAllocator::assignGaddr(std::vector<ValueInfo> &ops,
@@ -106,16 +109,30 @@ int64_t GmemAllocator::assignGaddr(std::vector<ValueInfo> &ops,
     }
   }
 
+  // methods are independent, each works on its own copy of ops and liveRange
+  int64_t method_num = alloc_methods.size();
+  std::vector<int64_t> gmem_sizes(method_num, 0);
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t i = 0; i < method_num; ++i) {
+    auto method_ops = ops;
+    auto method_live = liveRange;
+    gmem_sizes[i] = alloc_methods[i]->assignGaddr(
+        method_ops, method_live, neuronMemoryReuse, baseGaddr);
+  }
+
   int64_t min_gmem_size = 0;
   int idx = 0;
   for (uint32_t i = 0; i < alloc_methods.size(); ++i) {
-    int64_t gmem_size = alloc_methods[i]->assignGaddr(
-        ops, liveRange, neuronMemoryReuse, baseGaddr);
-    if (gmem_size < min_gmem_size || min_gmem_size == 0) {
-      min_gmem_size = gmem_size;
+    alloc_methods[i]->printGmemUsedStatistic();
+    if (!alloc_methods[i]->verifyGaddr(ops, liveRange)) {
+      llvm::report_fatal_error("GmemAllocator assigned overlapped addresses");
+    }
+    if (gmem_sizes[i] < min_gmem_size || min_gmem_size == 0) {
+      min_gmem_size = gmem_sizes[i];
       idx = i;
     }
   }
+  alloc_methods[idx]->printGaddr(ops, liveRange, baseGaddr);
   llvm::errs() << "GmemAllocator use " << alloc_methods[idx]->getName() << "\n";
   gaddrMap_.swap(alloc_methods[idx]->gaddrMap_);
   return min_gmem_size;
@@ -9,7 +9,10 @@
 
 #include "tpu_mlir/Dialect/Tpu/Transforms/GmemAllocatorMethod.h"
 #include <limits>
+#include <numeric>
+#include <queue>
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/MathExtras.h>
 
 #define DEBUG_TYPE "gmem-allocator"
 using namespace tpu_mlir::tpu;
@@ -149,16 +152,101 @@ int64_t GmemAllocatorMethod::updateGmemUsedStatistic(
     totalNeuronSize += sz_i;
   }
 
+  totalGmemUsed_ = totalGmemUsed;
+  totalNeuronSize_ = totalNeuronSize;
+  return totalGmemUsed;
+}
+
+void GmemAllocatorMethod::printGmemUsedStatistic() {
   int32_t reuseRate = 0;
-  if (totalNeuronSize) {
-    reuseRate =
-        (int32_t)((totalNeuronSize - totalGmemUsed) * 100 / totalNeuronSize);
+  if (totalNeuronSize_) {
+    reuseRate = (int32_t)((totalNeuronSize_ - totalGmemUsed_) * 100 /
+                          totalNeuronSize_);
   }
 
   llvm::errs() << "GmemAllocMethod:" << name_.c_str()
-               << "  Gmem Used: " << totalGmemUsed << "/" << totalNeuronSize
+               << "  Gmem Used: " << totalGmemUsed_ << "/" << totalNeuronSize_
                << ", gmem reused rate:" << reuseRate << "%\n";
-  return totalGmemUsed;
+}
+
+void GmemAllocatorMethod::printGaddr(std::vector<ValueInfo> &ops,
+                                     std::map<ValueInfo, TensorLive> &liveRange,
+                                     int64_t baseGaddr) {
+  for (auto op : ops) {
+    auto out_index = liveRange[op].out_index;
+    auto tensor_size = liveRange[op].tensor_size;
+    auto real_op = (Operation *)(op.op);
+    llvm::errs() << "op:" << real_op->getName()
+                 << ", name:" << module::getName(real_op->getResult(out_index))
+                 << ", addr:" << gaddrMap_[op] << ", baseGaddr:" << baseGaddr
+                 << ", size:" << tensor_size
+                 << ", end:" << gaddrMap_[op] + tensor_size
+                 << ", range:" << liveRange[op].start << " ~ "
+                 << liveRange[op].end << "\n";
+  }
+}
+
+bool GmemAllocatorMethod::verifyGaddr(
+    std::vector<ValueInfo> &ops, std::map<ValueInfo, TensorLive> &liveRange) {
+  // sweep live positions, keeping the tensors alive at the current position
+  // ordered by address, a new tensor only has to be checked against its
+  // neighbours there
+  std::vector<ValueInfo> order;
+  order.reserve(ops.size());
+  for (auto &op : ops) {
+    auto &live = liveRange.at(op);
+    if (live.start < live.end && live.tensor_size > 0) {
+      order.push_back(op);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const ValueInfo &a, const ValueInfo &b) {
+                     return liveRange[a].start < liveRange[b].start;
+                   });
+  using Alive = std::pair<int64_t, ValueInfo>;
+  auto by_end = [&](const ValueInfo &a, const ValueInfo &b) {
+    return liveRange[a].end > liveRange[b].end;
+  };
+  std::priority_queue<ValueInfo, std::vector<ValueInfo>, decltype(by_end)>
+      ending(by_end);
+  std::set<Alive> alive;
+  auto dump = [&](const ValueInfo &v) {
+    auto &live = liveRange[v];
+    auto real_op = (Operation *)(v.op);
+    llvm::errs() << "  " << module::getName(real_op->getResult(live.out_index))
+                 << ", addr:" << gaddrMap_[v] << ", size:" << live.tensor_size
+                 << ", range:" << live.start << " ~ " << live.end << "\n";
+  };
+  bool valid = true;
+  for (auto &v : order) {
+    auto &live = liveRange[v];
+    while (!ending.empty() && liveRange[ending.top()].end <= live.start) {
+      alive.erase({gaddrMap_[ending.top()], ending.top()});
+      ending.pop();
+    }
+    int64_t addr = gaddrMap_[v];
+    auto next = alive.lower_bound({addr, ValueInfo()});
+    std::vector<ValueInfo> conflicts;
+    if (next != alive.end() && next->first < addr + live.tensor_size) {
+      conflicts.push_back(next->second);
+    }
+    if (next != alive.begin()) {
+      auto &prev = std::prev(next)->second;
+      if (gaddrMap_[prev] + liveRange[prev].tensor_size > addr) {
+        conflicts.push_back(prev);
+      }
+    }
+    for (auto &c : conflicts) {
+      llvm::errs() << "GmemAllocMethod:" << name_.c_str()
+                   << " overlapped tensors:\n";
+      dump(c);
+      dump(v);
+      valid = false;
+    }
+    alive.insert({addr, v});
+    ending.push(v);
+  }
+  return valid;
 }
 
 GmemAllocFitFirst::GmemAllocFitFirst(std::map<ValueInfo, int64_t> &gaddrMap,
@@ -207,18 +295,6 @@ GmemAllocFitFirst::assignGaddr(std::vector<ValueInfo> &ops,
     gaddrMap_[op] += baseGaddr;
   }
 
-  for (auto op : ops) {
-    auto out_index = liveRange[op].out_index;
-    auto tensor_size = liveRange[op].tensor_size;
-    auto real_op = (Operation *)(op.op);
-    llvm::errs() << "op:" << real_op->getName()
-                 << ", name:" << module::getName(real_op->getResult(out_index))
-                 << ", addr:" << gaddrMap_[op] << ", baseGaddr:" << baseGaddr
-                 << ", size:" << tensor_size
-                 << ", end:" << gaddrMap_[op] + tensor_size
-                 << ", range:" << liveRange[op].start << " ~ "
-                 << liveRange[op].end << "\n";
-  }
   return totalGmemUsed;
 }
 
@@ -289,34 +365,220 @@ GmemAllocOpSizeOrder::assignGaddr(std::vector<ValueInfo> &ops,
     totalNeuronSize += op_addr->size;
   }
 
-  int32_t reuseRate = 0;
-  if (totalNeuronSize) {
-    reuseRate = (int32_t)((totalNeuronSize - total_consumption) * 100 /
-                          totalNeuronSize);
-  }
-
-  llvm::errs() << "GmemAllocMethod:" << name_.c_str()
-               << "  Gmem Used: " << total_consumption << "/" << totalNeuronSize
-               << ", gmem reused rate:" << reuseRate << "%\n";
+  totalGmemUsed_ = total_consumption;
+  totalNeuronSize_ = totalNeuronSize;
 
   for (auto &op_addr : allocated_op_list) {
     // update gaddr map by adding base gaddr.
     gaddrMap_[op_addr->op] += baseGaddr;
   }
 
-  for (auto op : ops) {
-    auto out_index = liveRange[op].out_index;
-    auto tensor_size = liveRange[op].tensor_size;
-    auto real_op = (Operation *)(op.op);
-    llvm::errs() << "op:" << real_op->getName()
-                 << ", name:" << module::getName(real_op->getResult(out_index))
-                 << ", addr:" << gaddrMap_[op] << ", baseGaddr:" << baseGaddr
-                 << ", size:" << tensor_size
-                 << ", end:" << gaddrMap_[op] + tensor_size
-                 << ", range:" << liveRange[op].start << " ~ "
-                 << liveRange[op].end << "\n";
+  return total_consumption;
+}
+
+namespace {
+// Segment tree over compressed live positions. Every interval is stored in
+// `covered` of the O(log N) nodes it decomposes into, and in `touched` of
+// those nodes and all their ancestors, so the intervals overlapping a query
+// are exactly `touched` of the query nodes plus `covered` of their ancestors.
+class LiveIntervalIndex {
+public:
+  explicit LiveIntervalIndex(int num_pos)
+      : num_pos_(std::max(num_pos, 1)), covered_(4 * num_pos_),
+        touched_(4 * num_pos_) {}
+
+  void insert(int lo, int hi, int id) {
+    if (lo < hi) {
+      insert(1, 0, num_pos_, lo, hi, id);
+    }
+  }
+
+  // ids of inserted intervals overlapping [lo, hi), may be duplicated
+  void query(int lo, int hi, std::vector<int> &ids) {
+    if (lo < hi) {
+      query(1, 0, num_pos_, lo, hi, ids);
+    }
+  }
+
+private:
+  void insert(int node, int l, int r, int lo, int hi, int id) {
+    touched_[node].push_back(id);
+    if (lo <= l && r <= hi) {
+      covered_[node].push_back(id);
+      return;
+    }
+    int m = (l + r) / 2;
+    if (lo < m) {
+      insert(2 * node, l, m, lo, hi, id);
+    }
+    if (hi > m) {
+      insert(2 * node + 1, m, r, lo, hi, id);
+    }
+  }
+
+  void query(int node, int l, int r, int lo, int hi, std::vector<int> &ids) {
+    if (lo <= l && r <= hi) {
+      ids.insert(ids.end(), touched_[node].begin(), touched_[node].end());
+      return;
+    }
+    ids.insert(ids.end(), covered_[node].begin(), covered_[node].end());
+    int m = (l + r) / 2;
+    if (lo < m) {
+      query(2 * node, l, m, lo, hi, ids);
+    }
+    if (hi > m) {
+      query(2 * node + 1, m, r, lo, hi, ids);
+    }
+  }
+
+  int num_pos_;
+  std::vector<std::vector<int>> covered_;
+  std::vector<std::vector<int>> touched_;
+};
+} // namespace
+
+GmemAllocBestFit::GmemAllocBestFit(std::map<ValueInfo, int64_t> &gaddrMap,
+                                   uint32_t aligment)
+    : GmemAllocatorMethod(gaddrMap, aligment) {
+  name_ = "BestFitAssign";
+}
+
+std::vector<int> GmemAllocBestFit::placeOrder(const std::vector<int> &lo,
+                                              const std::vector<int> &hi,
+                                              const std::vector<int64_t> &size,
+                                              int num_pos) {
+  std::vector<int> order(lo.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return lo[a] < lo[b] || (lo[a] == lo[b] && size[a] > size[b]);
+  });
+  return order;
+}
+
+int64_t GmemAllocBestFit::assignGaddr(std::vector<ValueInfo> &ops,
+                                      std::map<ValueInfo, TensorLive> &liveRange,
+                                      bool neuronMemoryReuse,
+                                      int64_t baseGaddr) {
+  assert(neuronMemoryReuse);
+  int num = ops.size();
+  // compress live positions, live range is [start, end)
+  std::vector<uint32_t> pos;
+  pos.reserve(2 * num);
+  for (auto &op : ops) {
+    auto &live = liveRange.at(op);
+    pos.push_back(live.start);
+    pos.push_back(live.end);
+  }
+  std::sort(pos.begin(), pos.end());
+  pos.erase(std::unique(pos.begin(), pos.end()), pos.end());
+  auto pos_idx = [&pos](uint32_t p) {
+    return (int)(std::lower_bound(pos.begin(), pos.end(), p) - pos.begin());
+  };
+  int num_pos = std::max((int)pos.size() - 1, 1);
+
+  std::vector<int> lo(num), hi(num);
+  std::vector<int64_t> size(num), offset(num, 0);
+  for (int i = 0; i < num; ++i) {
+    auto &live = liveRange.at(ops[i]);
+    lo[i] = pos_idx(live.start);
+    hi[i] = pos_idx(live.end);
+    size[i] = live.tensor_size;
+  }
+
+  LiveIntervalIndex index(num_pos);
+  std::vector<int> overlaps;
+  std::vector<int> visited(num, -1);
+  std::vector<std::pair<int64_t, int64_t>> blocks;
+  int64_t total_consumption = 0;
+  int64_t totalNeuronSize = 0;
+  for (int i : placeOrder(lo, hi, size, num_pos)) {
+    overlaps.clear();
+    blocks.clear();
+    index.query(lo[i], hi[i], overlaps);
+    for (int j : overlaps) {
+      if (visited[j] != i) {
+        visited[j] = i;
+        blocks.emplace_back(offset[j], offset[j] + size[j]);
+      }
+    }
+    std::sort(blocks.begin(), blocks.end());
+    int64_t prev_offset = 0;
+    int64_t best_offset = -1;
+    int64_t smallest_gap = std::numeric_limits<int64_t>::max();
+    for (auto &blk : blocks) {
+      int64_t gap = blk.first - prev_offset;
+      if (gap >= size[i] && gap < smallest_gap) {
+        smallest_gap = gap;
+        best_offset = prev_offset;
+      }
+      prev_offset = std::max(prev_offset, blk.second);
+    }
+    if (best_offset == -1) {
+      best_offset = prev_offset;
+    }
+    offset[i] = best_offset;
+    index.insert(lo[i], hi[i], i);
+    total_consumption = std::max(total_consumption, best_offset + size[i]);
+    totalNeuronSize += size[i];
+  }
+
+  totalGmemUsed_ = total_consumption;
+  totalNeuronSize_ = totalNeuronSize;
+  // update gaddr map by adding base gaddr.
+  for (int i = 0; i < num; ++i) {
+    gaddrMap_[ops[i]] = offset[i] + baseGaddr;
   }
   return total_consumption;
 }
+
+GmemAllocGreedyByBreadth::GmemAllocGreedyByBreadth(
+    std::map<ValueInfo, int64_t> &gaddrMap, uint32_t aligment)
+    : GmemAllocBestFit(gaddrMap, aligment) {
+  name_ = "GreedyByBreadthAssign";
+}
+
+std::vector<int> GmemAllocGreedyByBreadth::placeOrder(
+    const std::vector<int> &lo, const std::vector<int> &hi,
+    const std::vector<int64_t> &size, int num_pos) {
+  // breadth of each position is the total size of tensors alive there
+  std::vector<int64_t> breadth(num_pos + 1, 0);
+  for (size_t i = 0; i < lo.size(); ++i) {
+    if (lo[i] < hi[i]) {
+      breadth[lo[i]] += size[i];
+      breadth[hi[i]] -= size[i];
+    }
+  }
+  for (int p = 1; p < num_pos; ++p) {
+    breadth[p] += breadth[p - 1];
+  }
+  // sparse table for the widest position within a live range
+  std::vector<std::vector<int64_t>> table(1, breadth);
+  table[0].resize(num_pos);
+  for (int k = 1; (1 << k) <= num_pos; ++k) {
+    auto &prev = table[k - 1];
+    std::vector<int64_t> cur(num_pos - (1 << k) + 1);
+    for (size_t p = 0; p < cur.size(); ++p) {
+      cur[p] = std::max(prev[p], prev[p + (1 << (k - 1))]);
+    }
+    table.emplace_back(std::move(cur));
+  }
+  std::vector<int64_t> priority(lo.size(), 0);
+  for (size_t i = 0; i < lo.size(); ++i) {
+    if (lo[i] < hi[i]) {
+      int k = llvm::Log2_32(hi[i] - lo[i]);
+      priority[i] = std::max(table[k][lo[i]], table[k][hi[i] - (1 << k)]);
+    }
+  }
+
+  std::vector<int> order(lo.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    if (priority[a] != priority[b]) {
+      return priority[a] > priority[b];
+    }
+    return size[a] > size[b];
+  });
+  return order;
+}
 } // namespace tpu
 } // namespace tpu_mlir
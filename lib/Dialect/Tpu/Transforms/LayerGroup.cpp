@@ -84,8 +84,14 @@ public:
     RewritePatternSet patterns(ctx);
     patterns.add<OpReorderPattern>(ctx);
     applyPatternsAndFoldGreedily(func, std::move(patterns));
+    if (!cycle_cache.empty()) {
+      CycleCalculator::loadCycleCache(cycle_cache);
+    }
     GroupOps gOps(func);
     gOps.process(opt);
+    if (!cycle_cache.empty()) {
+      CycleCalculator::saveCycleCache(cycle_cache);
+    }
   }
 };
 
@@ -11,11 +11,150 @@
 #include "tpu_mlir/Backend/BM168x/BM168x.h"
 #include "tpu_mlir/Dialect/Tpu/Transforms/LayerGroup/LayerGroupUtil.h"
 #include "tpu_mlir/Support/Module.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <fstream>
+#include <mutex>
 
 using namespace tpu_mlir::backend;
 namespace tpu_mlir {
 namespace tpu {
 
+// signature of backend query => cycle
+class CycleCache {
+public:
+  static CycleCache &instance() {
+    static CycleCache cache;
+    return cache;
+  }
+
+  bool find(const std::string &key, int64_t &cycle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = cycles_.find(key);
+    if (iter == cycles_.end()) {
+      return false;
+    }
+    cycle = iter->second;
+    return true;
+  }
+
+  void insert(const std::string &key, int64_t cycle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cycles_.try_emplace(key, cycle).second) {
+      dirty_ = true;
+    }
+  }
+
+  // header line, then one "cycle signature" per line; a file with another
+  // header is ignored, and replaced on save
+  void load(const std::string &filename, const std::string &header) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    header_ = header;
+    if (!loaded_.insert(filename).second) {
+      return;
+    }
+    std::ifstream fin(filename);
+    std::string line;
+    if (!std::getline(fin, line)) {
+      return;
+    }
+    if (line != header) {
+      llvm::errs() << "cycle cache " << filename
+                   << " is for another chip, backend or build, ignored\n";
+      return;
+    }
+    while (std::getline(fin, line)) {
+      auto pair = llvm::StringRef(line).split(' ');
+      int64_t cycle;
+      if (pair.second.empty() || pair.first.getAsInteger(10, cycle)) {
+        continue;
+      }
+      cycles_.try_emplace(pair.second, cycle);
+    }
+  }
+
+  void save(const std::string &filename) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_) {
+      return;
+    }
+    auto tmp_file = filename + ".tmp";
+    std::ofstream fout(tmp_file, std::ios::trunc);
+    fout << header_ << "\n";
+    for (auto &iter : cycles_) {
+      fout << iter.second << " " << iter.first().str() << "\n";
+    }
+    fout.close();
+    if (fout.fail() ||
+        llvm::sys::fs::rename(tmp_file, filename) != std::error_code()) {
+      llvm::errs() << "failed to save cycle cache " << filename << "\n";
+      return;
+    }
+    dirty_ = false;
+  }
+
+private:
+  std::mutex mutex_;
+  llvm::StringMap<int64_t> cycles_;
+  std::set<std::string> loaded_;
+  std::string header_;
+  bool dirty_ = false;
+};
+
+// The BM168x backend keeps a single command buffer and profile, so backend
+// queries from the parallel group search take turns here. This is the only
+// lock around them; cached cycles do not need it.
+static std::mutex &backend_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+#ifndef MLIR_VERSION
+#define MLIR_VERSION "version unknown"
+#endif
+
+// bump when the line format or the signature changes
+static const int CYCLE_CACHE_FORMAT = 1;
+
+// cycles are only reused with the same chip, backend library and build
+static std::string cycle_cache_header() {
+  std::string header;
+  llvm::raw_string_ostream os(header);
+  os << "#cycle_cache format=" << CYCLE_CACHE_FORMAT
+     << " chip=" << module::stringifyChip(module::getChip())
+     << " backend=" << Arch::LIB_NAME << ":" << Arch::get_lib_md5()
+     << " build=" << MLIR_VERSION;
+  return os.str();
+}
+
+void CycleCalculator::loadCycleCache(const std::string &filename) {
+  CycleCache::instance().load(filename, cycle_cache_header());
+}
+
+void CycleCalculator::saveCycleCache(const std::string &filename) {
+  CycleCache::instance().save(filename);
+}
+
+// the op is identified by its name, attributes and operand/result types,
+// which carry shape, dtype and address; no newline in the signature
+static void print_op_signature(llvm::raw_ostream &os, Operation *op) {
+  std::string sig;
+  llvm::raw_string_ostream ss(sig);
+  ss << module::stringifyChip(module::getChip()) << "|" << op->getName()
+     << "|" << op->getAttrDictionary() << "|";
+  for (auto v : op->getOperands()) {
+    ss << v.getType() << ",";
+  }
+  ss << "|";
+  for (auto v : op->getResults()) {
+    ss << v.getType() << ",";
+  }
+  ss.flush();
+  std::replace(sig.begin(), sig.end(), '\n', ' ');
+  os << sig;
+}
+
 struct layer_cycle_info_t {
   int64_t stage;
   int64_t cycle;
@@ -47,7 +186,7 @@ void CycleCalculator::set_local_sec_info(local_sec_info_t &sec_info,
     auto &si = iter->second.slice_info;
     sec_info.n_slice = si.n[0].second;
     sec_info.h_slice = si.h[0].second;
-    sec_info.w_slice = W;
+    sec_info.w_slice = si.w.empty() ? W : si.w[0].second;
     has_input = true;
   }
 
@@ -58,11 +197,11 @@ void CycleCalculator::set_local_sec_info(local_sec_info_t &sec_info,
     auto &si = iter->second.slice_info;
     sec_info.out_n_slice = si.n[0].second;
     sec_info.out_h_slice = si.h[0].second;
-    sec_info.out_w_slice = W;
+    sec_info.out_w_slice = si.w.empty() ? W : si.w[0].second;
     if (!has_input) {
       sec_info.n_slice = si.n[0].second;
       sec_info.h_slice = si.h[0].second;
-      sec_info.w_slice = W;
+      sec_info.w_slice = sec_info.out_w_slice;
     }
   }
 }
@@ -70,7 +209,7 @@ void CycleCalculator::set_local_sec_info(local_sec_info_t &sec_info,
 int64_t CycleCalculator::getGroupCycle(BasicTimeStepPtr &time_step,
                                        shape_secs_t &shape_secs,
                                        group_type_t group_type) {
-  int64_t loop_num = shape_secs.nsecs * shape_secs.hsecs;
+  int64_t loop_num = shape_secs.nsecs * shape_secs.hsecs * shape_secs.wsecs;
   std::vector<layer_cycle_info_t> layer_cycle;
   std::vector<gdma_cycle_info_t> gdma_cycle;
 
@@ -170,6 +309,17 @@ int64_t CycleCalculator::getGroupCycle(BasicTimeStepPtr &time_step,
 }
 
 int64_t Bm168xCycleCalculator::getGlobalLayerCycle(Operation *op) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << "G|";
+  print_op_signature(os, op);
+  os.flush();
+  int64_t cycle = 0;
+  if (CycleCache::instance().find(key, cycle)) {
+    return cycle;
+  }
+
+  std::lock_guard<std::mutex> lock(backend_mutex());
   auto bm168x = BM168x::instance();
   bm168x->set_command_issue_flag(false);
   bm168x->reset_cmd_id_node();
@@ -178,8 +328,9 @@ int64_t Bm168xCycleCalculator::getGlobalLayerCycle(Operation *op) {
   auto castOp = dyn_cast<GlobalGenInterface>(op);
   castOp.codegen_global_bm168x();
 
-  int64_t cycle = bm168x->get_cmd_cycle();
+  cycle = bm168x->get_cmd_cycle();
   bm168x->dl_sg_stas_reset();
+  CycleCache::instance().insert(key, cycle);
   return cycle;
 }
 
@@ -187,13 +338,27 @@ int64_t Bm168xCycleCalculator::getLocalLayerCycle(Operation *op,
                                                   TensorInfo &tensor_infos,
                                                   group_type_t group_type,
                                                   bool calc_bdc_slack) {
-  auto bm168x = BM168x::instance();
   int64_t cycle = 0;
   local_sec_info_t sec_info;
   set_local_sec_info(sec_info, op, tensor_infos, group_type);
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << "L|" << group_type << "|" << calc_bdc_slack << "|";
+  auto sec_data = (const int32_t *)&sec_info;
+  for (size_t i = 0; i < sizeof(sec_info) / sizeof(int32_t); ++i) {
+    os << sec_data[i] << ",";
+  }
+  os << "|";
+  print_op_signature(os, op);
+  os.flush();
+  if (CycleCache::instance().find(key, cycle)) {
+    return cycle;
+  }
+
+  auto bm168x = BM168x::instance();
   auto lgOp = dyn_cast<LocalGenInterface>(op);
-  // #pragma omp critical
   {
+    std::lock_guard<std::mutex> lock(backend_mutex());
     bm168x->set_command_issue_flag(false);
     bm168x->reset_cmd_id_node();
 
@@ -209,24 +374,47 @@ int64_t Bm168xCycleCalculator::getLocalLayerCycle(Operation *op,
     }
     bm168x->dl_sg_stas_reset();
   }
+  CycleCache::instance().insert(key, cycle);
   return cycle;
 }
 
 int64_t Bm168xCycleCalculator::getGdmaCycle(Value v,
                                             const tensor_info_t &tensor_info,
                                             group_type_t group_type) {
+  int64_t n_slice, h_slice, w_slice;
+  get_max_slice_nhw(tensor_info.slice_info, n_slice, h_slice, w_slice);
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << "D|" << module::stringifyChip(module::getChip()) << "|"
+     << tensor_info.mode << "|" << group_type << "|" << n_slice << ","
+     << h_slice << "," << w_slice << "," << tensor_info.use_3ic_opt << ","
+     << tensor_info.eu_align << "," << tensor_info.need_bcast << "|"
+     << v.getType();
+  if (tensor_info.use_3ic_opt > 0 && tensor_info.use_3ic_opt < 4) {
+    // depends on the kernel of conv using it
+    os << "|";
+    print_op_signature(os, *v.getUsers().begin());
+  }
+  os.flush();
+  std::replace(key.begin(), key.end(), '\n', ' ');
+  int64_t cycle = 0;
+  if (CycleCache::instance().find(key, cycle)) {
+    return cycle;
+  }
+
+  std::lock_guard<std::mutex> lock(backend_mutex());
   auto bm168x = BM168x::instance();
   bm168x->set_command_issue_flag(false);
   bm168x->reset_cmd_id_node();
 
   // because LoadOp/StoreOp are not created during LayerGroup
-  int64_t cycle = 0;
   if (tensor_info.mode == TIMESTEP_LOAD) {
     cycle = getLoadCycle(v, tensor_info, group_type);
   } else {
     cycle = getStoreCycle(v, tensor_info, group_type);
   }
   bm168x->dl_sg_stas_reset();
+  CycleCache::instance().insert(key, cycle);
   return cycle;
 }
 
@@ -237,9 +425,9 @@ int64_t Bm168xCycleCalculator::getLoadCycle(Value v,
   // - n_slice, h_slice, eu_align, g_addr, l_addr
   // - need_bcast, use_3ic
   auto bm168x = BM168x::instance();
-  int64_t n_slice, h_slice;
+  int64_t n_slice, h_slice, w_slice;
   auto &si = tensor_info.slice_info;
-  get_max_slice_nh(si, n_slice, h_slice);
+  get_max_slice_nhw(si, n_slice, h_slice, w_slice);
   int64_t use_3ic = tensor_info.use_3ic_opt;
   bool need_bcast = tensor_info.need_bcast;
   bool eu_align = tensor_info.eu_align;
@@ -265,8 +453,9 @@ int64_t Bm168xCycleCalculator::getLoadCycle(Value v,
     g_stride.C = 0;
     g_stride.H = 0;
   }
-  auto l_stride =
-      bm168x->getLocalStride(n_slice, C, h_slice, W, fmt_bytes, eu_align);
+  w_slice = std::min(w_slice, W);
+  auto l_stride = bm168x->getLocalStride(n_slice, C, h_slice, w_slice,
+                                         fmt_bytes, eu_align);
   auto g_addr = module::getAddress(v);
   auto l_addr = 0;
   if (use_3ic < 4 && use_3ic > 0) {
@@ -285,9 +474,9 @@ int64_t Bm168xCycleCalculator::getLoadCycle(Value v,
     }
   } else {
     bm168x->dl_tensor_stride_move_gen_cmd(
-        l_addr, 0, g_addr, n_slice, C, h_slice, W, g_stride.N, g_stride.C,
-        g_stride.H, g_stride.W, l_stride.N, l_stride.C, l_stride.H, l_stride.W,
-        gdma_format, GDMA_VALUE_DIR_S2L, 0, pid_node);
+        l_addr, 0, g_addr, n_slice, C, h_slice, w_slice, g_stride.N,
+        g_stride.C, g_stride.H, g_stride.W, l_stride.N, l_stride.C, l_stride.H,
+        l_stride.W, gdma_format, GDMA_VALUE_DIR_S2L, 0, pid_node);
   }
   int64_t gdma_cycle = bm168x->dl_get_cmd_id_cycle(pid_node);
   bm168x->dl_destroy_cmd_id_node(pid_node);
@@ -300,9 +489,9 @@ int64_t Bm168xCycleCalculator::getStoreCycle(Value v,
   // need_info:
   // - n_slice, h_slice, eu_align, g_addr, l_addr
   auto bm168x = BM168x::instance();
-  int64_t n_slice, h_slice;
+  int64_t n_slice, h_slice, w_slice;
   auto &si = tensor_info.slice_info;
-  get_max_slice_nh(si, n_slice, h_slice);
+  get_max_slice_nhw(si, n_slice, h_slice, w_slice);
   bool eu_align = tensor_info.eu_align;
   auto pid_node = (CMD_ID_NODE *)bm168x->dl_create_cmd_id_node();
   bm168x->dl_reset_cmd_id(pid_node);
@@ -312,13 +501,13 @@ int64_t Bm168xCycleCalculator::getStoreCycle(Value v,
   int64_t N, C, H, W;
   module::getNCHW(v, N, C, H, W, group_type);
   auto g_stride = bm168x->getGlobalStride(N, C, H, W);
-  auto l_stride =
-      bm168x->getLocalStride(n_slice, C, h_slice, W, fmt_bytes, eu_align);
+  auto l_stride = bm168x->getLocalStride(n_slice, C, h_slice, w_slice,
+                                         fmt_bytes, eu_align);
   auto g_addr = module::getAddress(v);
   int64_t l_addr = 0;
 
   bm168x->dl_tensor_stride_move_gen_cmd(
-      l_addr, 0, g_addr, n_slice, C, h_slice, W, l_stride.N, l_stride.C,
+      l_addr, 0, g_addr, n_slice, C, h_slice, w_slice, l_stride.N, l_stride.C,
       l_stride.H, l_stride.W, g_stride.N, g_stride.C, g_stride.H, g_stride.W,
       gdma_format, GDMA_VALUE_DIR_L2S, 0, pid_node);
 
@@ -194,8 +194,6 @@ bool GroupMethod::is_layer_group_valid(LgInfo &lg_info, bool calc_cost,
   }
 
   if (calc_cost) {
-// remove it after pid_node is extractedb
-#pragma omp critical(get_cycle)
     *group_cost =
         cycle_calculator_->getGroupCycle(time_step, shape_secs, lg_info.type);
   }
@@ -204,6 +202,22 @@ bool GroupMethod::is_layer_group_valid(LgInfo &lg_info, bool calc_cost,
   return status;
 }
 
+bool GroupMethod::is_layer_group_valid_cached(LgInfo &lg_info,
+                                              int64_t *group_cost) {
+  auto key =
+      std::make_pair(lg_info.group_ops.front(), lg_info.group_ops.back());
+  auto iter = group_cost_cache_.find(key);
+  if (iter == group_cost_cache_.end()) {
+    int64_t cost = MAX_COST;
+    bool valid = is_layer_group_valid(lg_info, true, &cost);
+    iter = group_cost_cache_.try_emplace(key, valid, cost).first;
+  }
+  if (iter->second.first) {
+    *group_cost = iter->second.second;
+  }
+  return iter->second.first;
+}
+
 void GroupMethod::get_layer_cut_result(
     std::vector<int64_t> &cut_result,
     const std::vector<std::pair<int64_t, int64_t>> &clusters,
@@ -236,7 +250,7 @@ void GroupMethod::get_group_clusters(
 
       int64_t temp_cost = 0;
       get_layer_group(sub_group, base_group, start_idx, end_idx);
-      bool is_valid = is_layer_group_valid(sub_group, true, &temp_cost);
+      bool is_valid = is_layer_group_valid_cached(sub_group, &temp_cost);
       if (is_valid) {
         if (pre_cost <= temp_cost) {
           is_valid = false;
@@ -302,6 +316,7 @@ void GroupMethod::dynamic_programming_layer_group_with_cluster(
                << "***** Dynamic Programming layer group with cluster ****\n"
                << "=======================================================\n";
   cut_results_.clear();
+  group_cost_cache_.clear();
   LgInfo sub_group;
   std::vector<std::vector<Operation *>> base_groups;
   get_base_groups(base_groups, subnet_ops);
@@ -323,7 +338,9 @@ void GroupMethod::dynamic_programming_layer_group_with_cluster(
         int64_t start_idx = clusters[j].first;
         int64_t end_idx = start_idx + clusters[j].second - 1;
         get_layer_group(sub_group, base_groups[i], start_idx, end_idx);
-        assert(is_layer_group_valid(sub_group, true, &cost_table[j][j]));
+        bool valid = is_layer_group_valid_cached(sub_group, &cost_table[j][j]);
+        assert(valid);
+        (void)valid;
         cut_points[j][j] = j;
       }
       llvm::errs() << "Searching best group slices...\n";
@@ -331,17 +348,31 @@ void GroupMethod::dynamic_programming_layer_group_with_cluster(
       for (size_t len = 2; len <= cluster_num; ++len) {
         bar.update();
         // llvm::errs() << llvm::format("process cluster len = %d\n", len);
-        // #pragma omp parallel for private(sub_group)
-        for (int64_t start = 0; start <= cluster_num - len; ++start) {
+        // groups of the same len are independent, only the cycle
+        // calculation through backend is serialized
+        int64_t group_num = cluster_num - len + 1;
+        std::vector<int64_t> group_costs(group_num, MAX_COST);
+        std::vector<char> group_valids(group_num, 0);
+#pragma omp parallel for private(sub_group) schedule(dynamic)
+        for (int64_t start = 0; start < group_num; ++start) {
           int64_t end = start + len - 1;
-          // llvm::errs() << "start = " << start << ", end = " << end << "\n";
           int64_t start_idx = clusters[start].first;
           int64_t end_idx = clusters[end].first + clusters[end].second - 1;
           get_layer_group(sub_group, base_groups[i], start_idx, end_idx);
+          group_valids[start] =
+              is_layer_group_valid(sub_group, true, &group_costs[start]);
+        }
+        for (int64_t start = 0; start < group_num; ++start) {
+          int64_t end = start + len - 1;
+          // llvm::errs() << "start = " << start << ", end = " << end << "\n";
+          int64_t start_idx = clusters[start].first;
+          int64_t end_idx = clusters[end].first + clusters[end].second - 1;
+          group_cost_cache_.try_emplace(
+              std::make_pair(base_groups[i][start_idx],
+                             base_groups[i][end_idx]),
+              group_valids[start] != 0, group_costs[start]);
 
-          int64_t group_cost = MAX_COST;
-          is_layer_group_valid(sub_group, true, &group_cost);
-
+          int64_t group_cost = group_costs[start];
           int64_t optimal_point = end;
           // sweep_for_min_cost(&group_cost, &optimal_point, start, end,
           //                    cost_table);
@@ -425,6 +456,7 @@ bool GroupMethod::update_sequence_group_cost(
     if (group_one_layer_proc(*groups[i], true, &group_costs[i])) {
       shape_secs[i].nsecs = 1;
       shape_secs[i].hsecs = 1;
+      shape_secs[i].wsecs = 1;
       continue;
     }
 
@@ -555,17 +587,18 @@ bool GroupMethod::merge_cut_idx_to_reduce_gdma_cost(
         // get left sub_group
         if (left_group_cost == 0) {
           get_layer_group(sub_group, base_group, start_cut_idx, cut_idx);
-          lg_valid = is_layer_group_valid(sub_group, true, &left_group_cost);
+          lg_valid = is_layer_group_valid_cached(sub_group, &left_group_cost);
           assert(lg_valid);
         }
         // get right sub_group
         get_layer_group(sub_group, base_group, cut_idx + 1, end_cut_idx);
-        lg_valid = is_layer_group_valid(sub_group, true, &right_group_cost);
+        lg_valid = is_layer_group_valid_cached(sub_group, &right_group_cost);
         assert(lg_valid);
 
         // get combine group
         get_layer_group(sub_group, base_group, start_cut_idx, end_cut_idx);
-        lg_valid = is_layer_group_valid(sub_group, true, &combine_group_cost);
+        lg_valid =
+            is_layer_group_valid_cached(sub_group, &combine_group_cost);
         if (lg_valid) {
           if (combine_group_cost < left_group_cost + right_group_cost) {
             cut_result.erase(cut_result.begin() + j);
@@ -99,7 +99,8 @@ void GroupOps::buildGroupOp(const LgInfo &lg_info,
   auto &tensor_infos = time_step->get_tensor_infos();
 
   int64_t nsecs = shape_secs.nsecs;
-  int64_t hsecs = shape_secs.hsecs;
+  // w steps are flattened into h steps, see getLgParam
+  int64_t hsecs = shape_secs.hsecs * shape_secs.wsecs;
   for (auto in : lg_info.group_ins) {
     in_types.push_back(in.getType());
     //in_locs.push_back(module::getLoc(in));
@@ -313,9 +314,23 @@ LayerGroupAttr GroupOps::getLgParam(tensor_info_t &tensor_info, int64_t id,
   std::vector<int64_t> h_slices;
   std::vector<int64_t> n_idxs;
   std::vector<int64_t> n_slices;
-  for (auto &h : si.h) {
-    h_idxs.push_back(h.first);
-    h_slices.push_back(h.second);
+  std::vector<int64_t> w_idxs;
+  std::vector<int64_t> w_slices;
+  if (si.w.size() > 1) {
+    // h_step = h_sec * wsecs + w_sec
+    for (auto &h : si.h) {
+      for (auto &w : si.w) {
+        h_idxs.push_back(h.first);
+        h_slices.push_back(h.second);
+        w_idxs.push_back(w.first);
+        w_slices.push_back(w.second);
+      }
+    }
+  } else {
+    for (auto &h : si.h) {
+      h_idxs.push_back(h.first);
+      h_slices.push_back(h.second);
+    }
   }
   for (auto &n : si.n) {
     n_idxs.push_back(n.first);
@@ -329,7 +344,12 @@ LayerGroupAttr GroupOps::getLgParam(tensor_info_t &tensor_info, int64_t id,
       builder.getDenseI64ArrayAttr(h_idxs),
       builder.getDenseI64ArrayAttr(h_slices),
       builder.getDenseI64ArrayAttr(n_idxs),
-      builder.getDenseI64ArrayAttr(n_slices), id, tensor_info.stage);
+      builder.getDenseI64ArrayAttr(n_slices),
+      w_idxs.empty() ? DenseI64ArrayAttr()
+                     : builder.getDenseI64ArrayAttr(w_idxs),
+      w_slices.empty() ? DenseI64ArrayAttr()
+                       : builder.getDenseI64ArrayAttr(w_slices),
+      id, tensor_info.stage);
 }
 
 /*
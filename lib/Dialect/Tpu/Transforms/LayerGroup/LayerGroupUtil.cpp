@@ -17,12 +17,71 @@ using namespace tpu_mlir::backend;
 namespace tpu_mlir {
 namespace tpu {
 
+// ops whose local kernels take a w window through sec_info
+static bool is_w_split_op(Operation *op) {
+  for (auto v : op->getOperands()) {
+    if (module::isNone(v) || module::isWeight(v)) {
+      continue;
+    }
+    if (module::getShape(v).size() != 4 ||
+        module::getStorageType(v).isInteger(4)) {
+      return false;
+    }
+  }
+  if (auto conv_op = dyn_cast<tpu::Conv2DOp>(op)) {
+    auto attr = conv_op.parseParam();
+    return conv_op.getUse_3icOptimize() == 0 && attr.ins_h == 0 &&
+           attr.ins_w == 0;
+  }
+  if (auto pool_op = dyn_cast<tpu::Pool2DOp>(op)) {
+    return !pool_op.parseParam().is_global;
+  }
+  if (isa<tpu::AddOp, tpu::SubOp, tpu::MulOp, tpu::MaxOp, tpu::MinOp>(op)) {
+    if (auto add_op = dyn_cast<tpu::AddOp>(op)) {
+      auto do_early_stride = add_op.getDoEarlyStride();
+      if (do_early_stride.has_value() && do_early_stride.value()) {
+        return false;
+      }
+    }
+    // no broadcast along w
+    auto out_shape = module::getShape(op->getResult(0));
+    for (auto in : op->getOperands()) {
+      if (module::getShape(in) != out_shape) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return isa<tpu::ActiveOp, tpu::ReluOp, tpu::LeakyReluOp, tpu::CastOp,
+             tpu::AddConstOp, tpu::MulConstOp, tpu::LutOp, tpu::RequantIntOp,
+             tpu::RequantFpOp, tpu::PReluOp, tpu::ScaleOp>(op);
+}
+
+// w is split only on BM1684X static subnets, and only when every op in the
+// group supports it
+static bool allow_w_split(const LgInfo &lg_info) {
+  if (!module::isBM1684XFamily() || lg_info.type != GROUP_NORMAL) {
+    return false;
+  }
+  auto func = lg_info.group_ops[0]->getParentOfType<FuncOp>();
+  if (getRunMode(func) != RunMode::TPU_STATIC) {
+    return false;
+  }
+  for (auto op : lg_info.group_ops) {
+    if (!is_w_split_op(op)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 shape_secs_t get_group_max_secs(const LgInfo &lg_info) {
   int64_t n, c, h, w;
   module::getNCHW(lg_info.group_ops[0]->getOperand(0), n, c, h, w,
                   lg_info.type);
   int64_t max_nsecs = n;
   int64_t max_hsecs = llvm::maxIntN(64);
+  int64_t max_wsecs = allow_w_split(lg_info) ? llvm::maxIntN(64) : 1;
   // Need consider n_align if backend is BM1684
   int64_t n_align = 1;
   for (auto op : lg_info.group_ops) {
@@ -39,14 +98,16 @@ shape_secs_t get_group_max_secs(const LgInfo &lg_info) {
       } else {
         max_hsecs = 1;
       }
+      max_wsecs = std::min(max_wsecs, w);
     }
   }
 
-  return shape_secs_t{.nsecs = max_nsecs, .hsecs = max_hsecs};
+  return shape_secs_t{
+      .nsecs = max_nsecs, .hsecs = max_hsecs, .wsecs = max_wsecs};
 }
 
 shape_secs_t init_group_data_secs(const LgInfo &lg_info) {
-  shape_secs_t shape_secs = {1, 1};
+  shape_secs_t shape_secs = {1, 1, 1};
   if (lg_info.group_ops.size() == 1) {
     return shape_secs;
   }
@@ -142,8 +203,10 @@ void update_tensor_infos(const LgInfo &lg_info, TensorInfo &tensor_infos) {
         module::getNCHW(in, n, c, h, w, lg_info.type);
         ti.slice_info.n.clear();
         ti.slice_info.h.clear();
+        ti.slice_info.w.clear();
         ti.slice_info.n.push_back(std::make_pair((int64_t)0, (int64_t)n));
         ti.slice_info.h.push_back(std::make_pair((int64_t)0, (int64_t)h));
+        ti.slice_info.w.push_back(std::make_pair((int64_t)0, (int64_t)w));
         tensor_infos[in] = ti;
       }
     }
@@ -154,11 +217,14 @@ bool update_data_split(BasicTimeStepPtr time_step, const LgInfo &lg_info,
                        shape_secs_t &shape_secs) {
   shape_secs.nsecs = 1;
   shape_secs.hsecs = 1;
+  shape_secs.wsecs = 1;
   bool status = false;
   auto &tensor_infos = time_step->get_tensor_infos();
   shape_secs_t max_shape_secs = get_group_max_secs(lg_info);
   for (int64_t nsec = 1; nsec <= max_shape_secs.nsecs; ++nsec) {
     shape_secs.nsecs = nsec;
+    shape_secs.hsecs = 1;
+    shape_secs.wsecs = 1;
     tensor_infos.clear();
     if (stripe_mine_max_slice(lg_info, shape_secs, tensor_infos) == false) {
       return false;
@@ -169,7 +235,15 @@ bool update_data_split(BasicTimeStepPtr time_step, const LgInfo &lg_info,
     shape_secs.nsecs =
         std::max(shape_secs.nsecs, std::min(max_shape_secs.nsecs, total_secs));
     shape_secs.hsecs = ceiling_func(total_secs, shape_secs.nsecs);
-    if (shape_secs.hsecs <= max_shape_secs.hsecs) {
+    if (shape_secs.hsecs > max_shape_secs.hsecs &&
+        max_shape_secs.wsecs > 1) {
+      // h cannot be split any further, move the rest to w
+      shape_secs.wsecs =
+          ceiling_func(shape_secs.hsecs, max_shape_secs.hsecs);
+      shape_secs.hsecs = max_shape_secs.hsecs;
+    }
+    if (shape_secs.hsecs <= max_shape_secs.hsecs &&
+        shape_secs.wsecs <= max_shape_secs.wsecs) {
       status = true;
       break;
     }
@@ -206,7 +280,8 @@ inline bool is_same_slice(const slice_pair_t &a, const slice_pair_t &b) {
 }
 
 bool is_same_slice_info(const slice_info_t &si0, const slice_info_t &si1) {
-  if (si0.n.size() != si1.n.size() || si0.h.size() != si1.h.size()) {
+  if (si0.n.size() != si1.n.size() || si0.h.size() != si1.h.size() ||
+      si0.w.size() != si1.w.size()) {
     return false;
   }
   // check n
@@ -220,6 +295,11 @@ bool is_same_slice_info(const slice_info_t &si0, const slice_info_t &si1) {
       return false;
     }
   }
+  for (size_t i = 0; i < si0.w.size(); ++i) {
+    if (false == is_same_slice(si0.w[i], si1.w[i])) {
+      return false;
+    }
+  }
   // for (auto it : llvm::zip(si0.n, si1.n)) {
   //   if (false == is_same_slice(std::get<0>(it), std::get<1>(it))) {
   //     return false;
@@ -235,7 +315,7 @@ bool is_same_slice_info(const slice_info_t &si0, const slice_info_t &si1) {
 }
 
 slice_info_t get_out_slice_info(const shape_secs_t &shape_secs, int64_t n,
-                                int64_t h) {
+                                int64_t h, int64_t w) {
   slice_info_t slice_info;
   int64_t secs, idx, slice, step;
   // n slice info
@@ -256,6 +336,14 @@ slice_info_t get_out_slice_info(const shape_secs_t &shape_secs, int64_t n,
     // assert(idx < h);
     slice_info.h.emplace_back(slice_pair_t(idx, slice));
   }
+  // w slice_info
+  secs = shape_secs.wsecs;
+  for (int64_t i = 0; i < secs; ++i) {
+    step = w / secs + (w % secs > i);
+    idx = w / secs * i + (w % secs > i ? i : w % secs);
+    slice = (w - idx) > step ? step : (w - idx);
+    slice_info.w.emplace_back(slice_pair_t(idx, slice));
+  }
 
   return slice_info;
 }
@@ -297,6 +385,23 @@ bool get_backward_slice_info(slice_info_t &in_si, const slice_info_t &out_si,
       in_si.h.emplace_back(slice_pair_t(idx, slice));
     }
   }
+
+  pre_end_idx = 0;
+  idx = slice = 0;
+  if (shape_secs.wsecs == 1) {
+    in_si.w.emplace_back(slice_pair_t(0, w));
+  } else {
+    for (int i = 0; i < out_si.w.size(); i++) {
+      auto &s = out_si.w[i];
+      auto ret = lg_op.BackwardW(idx, slice, s.first, s.second);
+      bool end_reached = idx + slice == pre_end_idx;
+      if (failed(ret) || slice == 0 || (idx == 0 && i > 0) || end_reached) {
+        return false;
+      }
+      pre_end_idx = idx + slice;
+      in_si.w.emplace_back(slice_pair_t(idx, slice));
+    }
+  }
   return true;
 }
 
@@ -311,6 +416,13 @@ bool check_hsecs(Value value, slice_info_t &si, group_type_t group_type) {
   if (total_h * 2 > h * 3) { // h increase 1.5 times
     return false;
   }
+  int64_t total_w = 0;
+  for (auto &it : si.w) {
+    total_w += it.second;
+  }
+  if (si.w.size() > 1 && total_w * 2 > w * 3) { // w increase 1.5 times
+    return false;
+  }
   return true;
 }
 
@@ -366,7 +478,7 @@ bool stripe_mine_max_slice(const LgInfo &lg_info,
   tensor_infos.clear();
 
   int64_t n, c, h, w;
-  int64_t max_nslice = 0, max_hslice = 0;
+  int64_t max_nslice = 0, max_hslice = 0, max_wslice = 0;
   std::list<Value> tensor_branchs;
   std::multiset<Operation *> op_set;
   std::set<Value, value_compare> out_tensor_set;
@@ -380,10 +492,13 @@ bool stripe_mine_max_slice(const LgInfo &lg_info,
       max_nslice = align_up(max_nslice, align_n);
     }
     max_hslice = (h + shape_secs.hsecs - 1) / shape_secs.hsecs;
+    max_wslice = (w + shape_secs.wsecs - 1) / shape_secs.wsecs;
     si.n.clear();
     si.h.clear();
+    si.w.clear();
     si.n.emplace_back(slice_pair_t(0, max_nslice));
     si.h.emplace_back(slice_pair_t(0, max_hslice));
+    si.w.emplace_back(slice_pair_t(0, max_wslice));
     tensor_infos[out] = tensor_info_t(si);
 
     out_tensor_set.insert(out);
@@ -424,7 +539,7 @@ bool stripe_mine_idx_slice(const LgInfo &lg_info,
   std::set<Value, value_compare> out_tensor_set;
   for (auto out : lg_info.group_outs) {
     module::getNCHW(out, n, c, h, w, lg_info.type);
-    auto si = get_out_slice_info(shape_secs, n, h);
+    auto si = get_out_slice_info(shape_secs, n, h, w);
 
     tensor_infos[out] = tensor_info_t(si);
     out_tensor_set.insert(out);
@@ -459,6 +574,15 @@ void get_max_slice_nh(const slice_info_t &slice_info, int64_t &max_nslice,
   }
 }
 
+void get_max_slice_nhw(const slice_info_t &slice_info, int64_t &max_nslice,
+                       int64_t &max_hslice, int64_t &max_wslice) {
+  get_max_slice_nh(slice_info, max_nslice, max_hslice);
+  max_wslice = 0;
+  for (auto &slice : slice_info.w) {
+    max_wslice = std::max(max_wslice, slice.second);
+  }
+}
+
 int64_t get_buffer_size(Value v, const tensor_info_t &ti,
                         group_type_t group_type) {
   int64_t buf_size = 0;
@@ -471,11 +595,11 @@ int64_t get_buffer_size(Value v, const tensor_info_t &ti,
       buf_size = Arch::get_weight_lmem_bytes(v, ti.eu_align);
     }
   } else {
-    int64_t nslice, hslice;
+    int64_t nslice, hslice, wslice;
     auto &si = ti.slice_info;
-    get_max_slice_nh(si, nslice, hslice);
+    get_max_slice_nhw(si, nslice, hslice, wslice);
     buf_size =
-        Arch::get_tensor_lmem_bytes(v, nslice, c, hslice, w, ti.eu_align);
+        Arch::get_tensor_lmem_bytes(v, nslice, c, hslice, wslice, ti.eu_align);
   }
   return buf_size;
 }
@@ -488,7 +612,8 @@ void set_fake_local_layer_param(Operation *op, int64_t nidx, int64_t nslice,
       ctx, 0, 0, 0, 0, true, builder.getDenseI64ArrayAttr({hidx}),
       builder.getDenseI64ArrayAttr({hslice}),
       builder.getDenseI64ArrayAttr({nidx}),
-      builder.getDenseI64ArrayAttr({nslice}), 0, 0);
+      builder.getDenseI64ArrayAttr({nslice}), DenseI64ArrayAttr(),
+      DenseI64ArrayAttr(), 0, 0);
   op->setAttr(LocalGenInterface::kLayerGroupAttrName, lg_attr);
 }
 
@@ -142,8 +142,11 @@ static inline void update_shape_secs(shape_secs_t &shape_secs,
                                      const shape_secs_t &max_shape_secs) {
   if (shape_secs.nsecs < max_shape_secs.nsecs) {
     shape_secs.nsecs = increase_nsecs(shape_secs.nsecs, max_shape_secs.nsecs);
-  } else {
+  } else if (shape_secs.hsecs < max_shape_secs.hsecs ||
+             max_shape_secs.wsecs == 1) {
     ++(shape_secs.hsecs);
+  } else {
+    ++(shape_secs.wsecs);
   }
 }
 
@@ -534,7 +537,8 @@ bool LmemAllocator::assignLmemAddr(const LgInfo &lg_info,
                                    BasicTimeStepPtr &time_step,
                                    const shape_secs_t &shape_secs) {
   time_step->update_all_mem_buffer_size(lg_info);
-  bool one_loop = (shape_secs.nsecs == 1 && shape_secs.hsecs == 1);
+  bool one_loop = (shape_secs.nsecs == 1 && shape_secs.hsecs == 1 &&
+                   shape_secs.wsecs == 1);
 
   std::list<MemBufSortStd> membuf_list;
   init_membuf_list(membuf_list, time_step, one_loop);
@@ -621,7 +625,8 @@ bool LmemAllocator::assignLmemAddrWithSecs(const LgInfo &lg_info,
   bool status = false;
   const int64_t MAX_TRY_NUM = 20;
   while (shape_secs.nsecs <= max_shape_secs.nsecs &&
-         shape_secs.hsecs <= max_shape_secs.hsecs) {
+         shape_secs.hsecs <= max_shape_secs.hsecs &&
+         shape_secs.wsecs <= max_shape_secs.wsecs) {
     // reassign time step
     status = time_step->assignTimeStep(lg_info, shape_secs, true);
     if (status == false) {
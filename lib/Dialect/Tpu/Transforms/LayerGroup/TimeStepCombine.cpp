@@ -22,7 +22,8 @@ static void update_cycle_info(std::vector<int64_t> &total_gdma_cycle_v,
                               std::vector<int64_t> &total_layer_cycle_v,
                               const BasicTimeStepPtr &time_step,
                               const shape_secs_t &shape_secs) {
-  bool one_loop = (shape_secs.nsecs * shape_secs.hsecs == 1);
+  bool one_loop =
+      (shape_secs.nsecs * shape_secs.hsecs * shape_secs.wsecs == 1);
   int64_t ts_num = time_step->get_timestep_num();
   total_gdma_cycle_v.clear();
   total_layer_cycle_v.clear();
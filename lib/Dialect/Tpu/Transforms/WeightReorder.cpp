@@ -40,10 +40,13 @@ public:
       llvm_unreachable("module should be tpu quantized");
     }
     RewritePatternSet patterns(mOp.getContext());
+    // coeffs computed ahead of the patterns, consumed by them
+    bm1684x::conv_int8_prepared_t conv_int8_prepared;
     if (module::isBM1684Family()) {
       bm1684::populateWeightReorderPatterns(&patterns);
     } else if (module::isBM1684XFamily()) {
-      bm1684x::populateWeightReorderPatterns(&patterns);
+      bm1684x::prepareWeightReorder(mOp, conv_int8_prepared);
+      bm1684x::populateWeightReorderPatterns(&patterns, &conv_int8_prepared);
     } else if (module::isCV18xx()) {
       cv18xx::populateWeightReorderPatterns(&patterns);
     }
@@ -27,6 +27,17 @@ void LocalGenInterface::fixSlice(int64_t &in_idx, int64_t &in_slice,
   in_slice = end_idx - in_idx;
 }
 
+// width of the op result as the layer group sees it
+static int64_t getGroupWidth(mlir::Operation *op) {
+  auto group_type = GROUP_NORMAL;
+  if (auto gOp = op->getParentOfType<tpu::GroupOp>()) {
+    group_type = static_cast<group_type_t>(gOp.getGroupType());
+  }
+  int64_t n, c, h, w;
+  module::getNCHW(op->getResult(0), n, c, h, w, group_type);
+  return w;
+}
+
 group_info_t LocalGenInterface::getGroupInfo(mlir::Value v, int64_t n_step,
                                              int64_t h_step) {
   auto op = v.getDefiningOp();
@@ -42,8 +53,11 @@ group_info_t LocalGenInterface::getGroupInfo(mlir::Value v, int64_t n_step,
                        .cast<tpu::LayerGroupAttr>();
     int64_t nslice = g_param.getNSlice()[0];
     int64_t hslice = g_param.getHSlice()[0];
+    auto w_slice_v = g_param.getWSlice();
+    int64_t wslice = w_slice_v ? w_slice_v[0] : getGroupWidth(dst_op);
     dst_lg_op.BackwardN(ginfo.n_idx, ginfo.n_slice, 0, nslice);
     dst_lg_op.BackwardH(ginfo.h_idx, ginfo.h_slice, 0, hslice);
+    dst_lg_op.BackwardW(ginfo.w_idx, ginfo.w_slice, 0, wslice);
     return ginfo;
   }
   return getGroupInfo(op, n_step, h_step);
@@ -70,12 +84,16 @@ group_info_t LocalGenInterface::getGroupInfo(mlir::Operation *op,
   auto n_slice_v = g_param.getNSlice();
   auto h_idx_v = g_param.getHIdx();
   auto h_slice_v = g_param.getHSlice();
+  // w slices are flattened into h steps, absent when w is not split
+  auto w_idx_v = g_param.getWIdx();
+  auto w_slice_v = g_param.getWSlice();
   if (n_idx_v.empty() && h_idx_v.empty()) {
     int64_t n, c, h, w;
     ginfo.overstepped = !(n_step == 0 && h_step == 0);
     module::getNCHW(op->getResult(0), n, c, h, w);
     ginfo.n_slice = n;
     ginfo.h_slice = h;
+    ginfo.w_slice = getGroupWidth(op);
   } else {
     if (n_step >= (int64_t)n_idx_v.size() ||
         h_step >= (int64_t)h_idx_v.size()) {
@@ -85,6 +103,12 @@ group_info_t LocalGenInterface::getGroupInfo(mlir::Operation *op,
       ginfo.n_slice = n_slice_v[n_step];
       ginfo.h_idx = h_idx_v[h_step];
       ginfo.h_slice = h_slice_v[h_step];
+      if (w_idx_v && !w_idx_v.empty()) {
+        ginfo.w_idx = w_idx_v[h_step];
+        ginfo.w_slice = w_slice_v[h_step];
+      } else {
+        ginfo.w_slice = getGroupWidth(op);
+      }
       ginfo.overstepped = false;
     }
   }
@@ -9,14 +9,12 @@
 
 #include "tpu_mlir/Support/Dnnl/Binary.h"
 #include "oneapi/dnnl/dnnl.hpp"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 
 using namespace dnnl;
 
 namespace tpu_mlir {
-Binary::Binary() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  engine_stream = dnnl::stream(eng);
-}
+Binary::Binary() { eng = dnnl_engine(); }
 
 void Binary::setup() {
   // memory description with primitive description
@@ -26,6 +24,8 @@ void Binary::setup() {
   using pd_t = binary::primitive_desc;
 
   auto pd = pd_t();
+  dnnl::primitive_attr attr;
+  attr.set_scratchpad_mode(scratchpad_mode::user);
   if (do_relu_) {
     dnnl::post_ops ops_eltwise;
     // https://oneapi-src.github.io/oneDNN/dev_guide_eltwise.html
@@ -34,20 +34,20 @@ void Binary::setup() {
                                  relu_limit_);
     else
       ops_eltwise.append_eltwise(1.0f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
-    dnnl::primitive_attr attr_po_eltwise;
-    attr_po_eltwise.set_post_ops(ops_eltwise);
-    pd = pd_t(op_desc, attr_po_eltwise, eng);
-  } else {
-    pd = pd_t(op_desc, eng);
+    attr.set_post_ops(ops_eltwise);
   }
-  binary_prim = binary(pd);
+  binary_prim = dnnl_primitive<binary>(
+      dnnl_cache_key(op_desc) + dnnl_cache_key(attr),
+      [&]() { return pd_t(op_desc, attr, eng); }, &pd);
+  scratchpad_mem = memory(pd.scratchpad_desc(), eng);
 }
 
 void Binary::run() {
-  binary_prim.execute(engine_stream, {{DNNL_ARG_SRC_0, lhs_mem},
+  binary_prim.execute(dnnl_stream(), {{DNNL_ARG_SRC_0, lhs_mem},
                                       {DNNL_ARG_SRC_1, rhs_mem},
-                                      {DNNL_ARG_DST, dst_mem}});
-  engine_stream.wait();
+                                      {DNNL_ARG_DST, dst_mem},
+                                      {DNNL_ARG_SCRATCHPAD, scratchpad_mem}});
+  dnnl_stream().wait();
 }
 
 } // namespace tpu_mlir
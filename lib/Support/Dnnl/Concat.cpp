@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/Dnnl/Concat.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 
 using namespace dnnl;
 using tag = memory::format_tag;
@@ -16,10 +17,7 @@ using dt = memory::data_type;
 
 namespace tpu_mlir {
 
-Concat::Concat() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
-}
+Concat::Concat() { eng = dnnl_engine(); }
 
 void Concat::setup(std::vector<float *> inputs, float *output,
                    concat_attr_t &attr) {
@@ -29,6 +27,11 @@ void Concat::setup(std::vector<float *> inputs, float *output,
 
   std::vector<memory::desc> src_mds;
   std::vector<memory> src_mems;
+  primitive_attr concat_attr;
+  concat_attr.set_scratchpad_mode(scratchpad_mode::user);
+  // concat has no operation desc, key on the axis and the sources
+  std::string key =
+      std::to_string(attr_.axis) + ";" + dnnl_cache_key(concat_attr);
 
   for (uint64_t i = 0; i < attr_.num_src; i++) {
     auto src_shape = attr_.src_shapes[i];
@@ -37,15 +40,23 @@ void Concat::setup(std::vector<float *> inputs, float *output,
 
     src_mds.push_back(src_md);
     src_mems.push_back(src_mem);
+    key += dnnl_cache_key(src_md);
   }
 
-  auto concat_pd = concat::primitive_desc(attr_.axis, src_mds, eng);
+  concat::primitive_desc concat_pd;
+  concat_prim = dnnl_primitive<concat>(
+      key,
+      [&]() {
+        return concat::primitive_desc(attr_.axis, src_mds, eng, concat_attr);
+      },
+      &concat_pd);
   auto dst_mem = memory(concat_pd.dst_desc(), eng, p_output);
-  concat_prim = concat(concat_pd);
 
   for (int n = 0; n < attr_.num_src; ++n)
     concat_args.insert({DNNL_ARG_MULTIPLE_SRC + n, src_mems[n]});
   concat_args.insert({DNNL_ARG_DST, dst_mem});
+  concat_args.insert(
+      {DNNL_ARG_SCRATCHPAD, memory(concat_pd.scratchpad_desc(), eng)});
 
   // // Primitive execution: concatenation.
   // concat_prim.execute(eng_stream, concat_args);
@@ -55,8 +66,8 @@ void Concat::setup(std::vector<float *> inputs, float *output,
 }
 
 void Concat::run() {
-  concat_prim.execute(eng_stream, concat_args);
-  eng_stream.wait();
+  concat_prim.execute(dnnl_stream(), concat_args);
+  dnnl_stream().wait();
 }
 
 } // namespace tpu_mlir
@@ -15,8 +15,7 @@
 using namespace dnnl;
 using namespace tpu_mlir;
 Conv::Conv() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
+  eng = dnnl_engine();
   memset(&_attr, 0, sizeof(conv_attr_t));
 }
 
@@ -55,7 +54,8 @@ void Conv::filter_init(float *weight, conv_attr_t &attr) {
 }
 
 void Conv::setup(float *input, float *weight, float *bias, float *output,
-                 conv_attr_t attr) {
+                 conv_attr_t attr, bool weight_is_coeff,
+                 memory::data_type src_dt) {
   pad_init(input, attr);
   filter_init(weight, attr);
   dst_shape = {attr.n, attr.oc, attr.od, attr.oh, attr.ow};
@@ -77,10 +77,11 @@ void Conv::setup(float *input, float *weight, float *bias, float *output,
 
   net.clear();
   net_args.clear();
-  auto src_md = memory::desc({src_shape}, memory::data_type::f32,
-                             memory::format_tag::any);
-  auto filter_md = memory::desc({filter_shape}, memory::data_type::f32,
-                                memory::format_tag::any);
+  auto filter_dt = src_dt == memory::data_type::f32 ? memory::data_type::f32
+                                                   : memory::data_type::s8;
+  auto src_md = memory::desc({src_shape}, src_dt, memory::format_tag::any);
+  auto filter_md =
+      memory::desc({filter_shape}, filter_dt, memory::format_tag::any);
   auto bias_md = memory::desc({bias_shape}, memory::data_type::f32,
                               memory::format_tag::any);
   auto dst_md = memory::desc({dst_shape}, memory::data_type::f32,
@@ -97,10 +98,15 @@ void Conv::setup(float *input, float *weight, float *bias, float *output,
 
   // post_ops ops;
   primitive_attr conv_attr;
+  conv_attr.set_scratchpad_mode(scratchpad_mode::user);
   post_relu(conv_attr, attr.do_relu, attr.relu_limit);
 
-  conv_prim_desc =
-      convolution_forward::primitive_desc(conv_desc, conv_attr, eng);
+  auto conv_prim = dnnl_primitive<convolution_forward>(
+      dnnl_cache_key(conv_desc) + dnnl_cache_key(conv_attr),
+      [&]() {
+        return convolution_forward::primitive_desc(conv_desc, conv_attr, eng);
+      },
+      &conv_prim_desc);
 
   // set mkldnn memory
   auto filter_tag = (attr.groups != 1) ? memory::format_tag::goidhw
@@ -110,9 +116,17 @@ void Conv::setup(float *input, float *weight, float *bias, float *output,
   prim_filter_memory = filter_memory;
   if (conv_prim_desc.weights_desc() != filter_memory.get_desc()) {
     prim_filter_memory = memory(conv_prim_desc.weights_desc(), eng);
-    net.push_back(reorder(filter_memory, prim_filter_memory));
-    net_args.push_back(
-        {{DNNL_ARG_FROM, filter_memory}, {DNNL_ARG_TO, prim_filter_memory}});
+    if (weight_is_coeff) {
+      reorder(filter_memory, prim_filter_memory)
+          .execute(dnnl_stream(), filter_memory, prim_filter_memory);
+      dnnl_stream().wait();
+      // the packed filter is kept, the zero point adjusted copy is not used
+      weight_after_zp.reset();
+    } else {
+      net.push_back(reorder(filter_memory, prim_filter_memory));
+      net_args.push_back(
+          {{DNNL_ARG_FROM, filter_memory}, {DNNL_ARG_TO, prim_filter_memory}});
+    }
   }
 
   auto prim_bias_memory = memory();
@@ -123,9 +137,15 @@ void Conv::setup(float *input, float *weight, float *bias, float *output,
     prim_bias_memory = bias_memory;
     if (conv_prim_desc.bias_desc() != bias_memory.get_desc()) {
       prim_bias_memory = memory(conv_prim_desc.bias_desc(), eng);
-      net.push_back(reorder(bias_memory, prim_bias_memory));
-      net_args.push_back(
-          {{DNNL_ARG_FROM, bias_memory}, {DNNL_ARG_TO, prim_bias_memory}});
+      if (weight_is_coeff) {
+        reorder(bias_memory, prim_bias_memory)
+            .execute(dnnl_stream(), bias_memory, prim_bias_memory);
+        dnnl_stream().wait();
+      } else {
+        net.push_back(reorder(bias_memory, prim_bias_memory));
+        net_args.push_back(
+            {{DNNL_ARG_FROM, bias_memory}, {DNNL_ARG_TO, prim_bias_memory}});
+      }
     }
   }
 
@@ -141,16 +161,19 @@ void Conv::setup(float *input, float *weight, float *bias, float *output,
   }
 
   auto prim_dst_memory = memory(conv_prim_desc.dst_desc(), eng);
-  net.push_back(convolution_forward(conv_prim_desc));
+  auto scratchpad_memory = memory(conv_prim_desc.scratchpad_desc(), eng);
+  net.push_back(conv_prim);
   if (bias != nullptr) {
     net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                         {DNNL_ARG_WEIGHTS, prim_filter_memory},
                         {DNNL_ARG_BIAS, prim_bias_memory},
-                        {DNNL_ARG_DST, prim_dst_memory}});
+                        {DNNL_ARG_DST, prim_dst_memory},
+                        {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
   } else {
     net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                         {DNNL_ARG_WEIGHTS, prim_filter_memory},
-                        {DNNL_ARG_DST, prim_dst_memory}});
+                        {DNNL_ARG_DST, prim_dst_memory},
+                        {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
   }
   // reorder or copy the output
   auto dst_memory =
@@ -170,6 +193,7 @@ void Conv::run() {
                _attr.phb, _attr.pwl, _attr.pwr, _attr.pad_value);
   }
 
+  auto &eng_stream = dnnl_stream();
   for (size_t i = 0; i < net.size(); ++i)
     net.at(i).execute(eng_stream, net_args.at(i));
   eng_stream.wait();
@@ -8,14 +8,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/Dnnl/Deconv.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 #include "tpu_mlir/Support/MathUtils.h"
 #include <string.h>
 
 using namespace dnnl;
 using namespace tpu_mlir;
 Deconv::Deconv() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
+  eng = dnnl_engine();
   memset(&_attrs, 0, sizeof(deconv_attr_t));
   _izp = 0;
 }
@@ -73,6 +73,7 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
 
   net.clear();
   net_args.clear();
+  auto &eng_stream = dnnl_stream();
   auto src_md = memory::desc({src_shape}, memory::data_type::f32,
                              memory::format_tag::any);
   auto filter_md = memory::desc({filter_shape}, memory::data_type::f32,
@@ -93,6 +94,7 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
 
     post_ops ops;
     primitive_attr conv_attr;
+    conv_attr.set_scratchpad_mode(scratchpad_mode::user);
 
     if (attr.do_relu) {
       const float ops_scale = 1.f;
@@ -103,8 +105,13 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
       conv_attr.set_post_ops(ops);
     }
 
-    conv_prim_desc =
-        convolution_forward::primitive_desc(conv_desc, conv_attr, eng);
+    auto conv_prim = dnnl_primitive<convolution_forward>(
+        dnnl_cache_key(conv_desc) + dnnl_cache_key(conv_attr),
+        [&]() {
+          return convolution_forward::primitive_desc(conv_desc, conv_attr,
+                                                     eng);
+        },
+        &conv_prim_desc);
 
     // set mkldnn memory
     auto filter_tag =
@@ -128,6 +135,7 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
       prim_filter_memory = memory(conv_prim_desc.weights_desc(), eng);
       reorder(filter_memory, prim_filter_memory)
           .execute(eng_stream, filter_memory, prim_filter_memory);
+      eng_stream.wait();
     }
 
     auto prim_bias_memory = memory();
@@ -156,16 +164,19 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
     }
 
     auto prim_dst_memory = memory(conv_prim_desc.dst_desc(), eng);
-    net.push_back(convolution_forward(conv_prim_desc));
+    auto scratchpad_memory = memory(conv_prim_desc.scratchpad_desc(), eng);
+    net.push_back(conv_prim);
     if (bias != nullptr) {
       net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                           {DNNL_ARG_WEIGHTS, prim_filter_memory},
                           {DNNL_ARG_BIAS, prim_bias_memory},
-                          {DNNL_ARG_DST, prim_dst_memory}});
+                          {DNNL_ARG_DST, prim_dst_memory},
+                          {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
     } else {
       net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                           {DNNL_ARG_WEIGHTS, prim_filter_memory},
-                          {DNNL_ARG_DST, prim_dst_memory}});
+                          {DNNL_ARG_DST, prim_dst_memory},
+                          {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
     }
     // reorder or copy the output
     auto dst_memory =
@@ -188,6 +199,7 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
 
     post_ops ops;
     primitive_attr deconv_attr;
+    deconv_attr.set_scratchpad_mode(scratchpad_mode::user);
 
     if (attr.do_relu) {
       const float ops_scale = 1.f;
@@ -204,8 +216,13 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
       deconv_attr.set_post_ops(ops);
     }
 
-    deconv_prim_desc =
-        deconvolution_forward::primitive_desc(deconv_desc, deconv_attr, eng);
+    auto deconv_prim = dnnl_primitive<deconvolution_forward>(
+        dnnl_cache_key(deconv_desc) + dnnl_cache_key(deconv_attr),
+        [&]() {
+          return deconvolution_forward::primitive_desc(deconv_desc,
+                                                       deconv_attr, eng);
+        },
+        &deconv_prim_desc);
 
     // set mkldnn memory
     auto filter_tag =
@@ -217,6 +234,7 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
       prim_filter_memory = memory(deconv_prim_desc.weights_desc(), eng);
       reorder(filter_memory, prim_filter_memory)
           .execute(eng_stream, filter_memory, prim_filter_memory);
+      eng_stream.wait();
     }
 
     auto prim_bias_memory = memory();
@@ -245,16 +263,19 @@ void Deconv::setup(float *input, float *weight, float *bias, float *output,
     }
 
     auto prim_dst_memory = memory(deconv_prim_desc.dst_desc(), eng);
-    net.push_back(deconvolution_forward(deconv_prim_desc));
+    auto scratchpad_memory = memory(deconv_prim_desc.scratchpad_desc(), eng);
+    net.push_back(deconv_prim);
     if (bias != nullptr) {
       net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                           {DNNL_ARG_WEIGHTS, prim_filter_memory},
                           {DNNL_ARG_BIAS, prim_bias_memory},
-                          {DNNL_ARG_DST, prim_dst_memory}});
+                          {DNNL_ARG_DST, prim_dst_memory},
+                          {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
     } else {
       net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
                           {DNNL_ARG_WEIGHTS, prim_filter_memory},
-                          {DNNL_ARG_DST, prim_dst_memory}});
+                          {DNNL_ARG_DST, prim_dst_memory},
+                          {DNNL_ARG_SCRATCHPAD, scratchpad_memory}});
     }
     // reorder or copy the output
     auto dst_memory =
@@ -277,6 +298,7 @@ void Deconv::run() {
                           _attrs.pad_d_after, _attrs.pad_h, _attrs.pad_h_after,
                           _attrs.pad_w, _attrs.pad_w_after, _izp);
   }
+  auto &eng_stream = dnnl_stream();
   for (size_t i = 0; i < net.size(); ++i) {
     net.at(i).execute(eng_stream, net_args.at(i));
   }
@@ -32,4 +32,57 @@ memory::data_type getDnnlType(mlir::Value v) {
   type.dump();
   return memory::data_type::f32;
 }
+
+static bool has_vnni() {
+  static bool vnni = []() {
+    auto isa = static_cast<unsigned>(get_effective_cpu_isa());
+    auto core_vnni = static_cast<unsigned>(cpu_isa::avx512_core_vnni);
+    auto avx2_vnni = static_cast<unsigned>(cpu_isa::avx2_vnni);
+    return (isa & core_vnni) == core_vnni || (isa & avx2_vnni) == avx2_vnni;
+  }();
+  return vnni;
+}
+
+// max |v| of a constant weight, or -1 when v is not a weight
+static double max_abs_weight(mlir::Value v) {
+  auto op = v.getDefiningOp<top::WeightOp>();
+  if (!op) {
+    return -1;
+  }
+  auto data = op.read_as_float();
+  double max_abs = 0;
+  for (auto d : *data) {
+    max_abs = std::max(max_abs, (double)std::abs(d));
+  }
+  return max_abs;
+}
+
+memory::data_type getDnnlInt8Type(mlir::Value input, mlir::Value weight,
+                                  int64_t K, mlir::Value bias) {
+  // without VNNI, oneDNN may drop s8 weights to 7 bits to avoid the
+  // saturation of u8*s8 pairs, then the result is not exact any more
+  if (!has_vnni()) {
+    return memory::data_type::f32;
+  }
+  auto in_type = module::getStorageType(input);
+  auto w_type = module::getStorageType(weight);
+  if (!in_type.isInteger(8) || !w_type.isInteger(8) ||
+      w_type.isUnsignedInteger()) {
+    return memory::data_type::f32;
+  }
+  // the f32 path is only exact while every partial sum stays within 2^24
+  double max_x = in_type.isUnsignedInteger() ? 255 : 128;
+  double max_w = module::isWeight(weight) ? max_abs_weight(weight) : 128;
+  double max_b = 0;
+  if (bias && !module::isNone(bias)) {
+    max_b = max_abs_weight(bias);
+    if (max_b < 0) {
+      return memory::data_type::f32;
+    }
+  }
+  if (K * max_x * max_w + max_b >= (double)(1 << 24)) {
+    return memory::data_type::f32;
+  }
+  return getDnnlType(input);
+}
 } // namespace tpu_mlir
@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
+#include <atomic>
 using namespace dnnl;
 namespace tpu_mlir {
 
@@ -28,4 +29,47 @@ void post_relu(primitive_attr &attr, bool &do_relu, double &relu_limit)
     attr.set_post_ops(ops);
   }
 }
+
+engine &dnnl_engine() {
+  static engine eng(engine::kind::cpu, 0);
+  return eng;
+}
+
+stream &dnnl_stream() {
+  static thread_local stream s(dnnl_engine());
+  return s;
+}
+
+std::string dnnl_cache_key(const void *data, size_t size) {
+  return std::string((const char *)data, size);
+}
+
+std::string dnnl_cache_key(const primitive_attr &attr) {
+  // only eltwise post-ops are used by the wrappers
+  std::string key = std::to_string((int)attr.get_scratchpad_mode()) + ";";
+  auto ops = attr.get_post_ops();
+  for (int i = 0; i < ops.len(); i++) {
+    key += std::to_string((int)ops.kind(i));
+    if (ops.kind(i) == primitive::kind::eltwise) {
+      float scale, alpha, beta;
+      algorithm alg;
+      ops.get_params_eltwise(i, scale, alg, alpha, beta);
+      float params[] = {scale, alpha, beta};
+      key += ":" + std::to_string((int)alg) + ":" +
+             dnnl_cache_key(params, sizeof(params));
+    }
+    key += ";";
+  }
+  return key;
+}
+
+static std::atomic<int64_t> cache_hit(0);
+static std::atomic<int64_t> cache_miss(0);
+
+void dnnl_cache_record(bool hit) { hit ? cache_hit++ : cache_miss++; }
+
+void dnnl_cache_stat(int64_t &hit, int64_t &miss) {
+  hit = cache_hit;
+  miss = cache_miss;
+}
 } // namespace tpu_mlir
@@ -9,14 +9,12 @@
 
 #include "tpu_mlir/Support/Dnnl/LRN.h"
 #include "oneapi/dnnl/dnnl.hpp"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 
 using namespace dnnl;
 
 namespace tpu_mlir {
-LRN::LRN() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  engine_stream = dnnl::stream(eng);
-}
+LRN::LRN() { eng = dnnl_engine(); }
 
 void LRN::setup() {
   // memory description with primitive description
@@ -24,14 +22,20 @@ void LRN::setup() {
       lrn_forward::desc(prop_kind::forward_inference, algorithm_,
                         src_mem.get_desc(), size_, alpha_, beta_, bias_);
   // define a primitive
-  auto pd = lrn_forward::primitive_desc(op_desc, eng);
-  lrn_prim = lrn_forward(pd);
+  primitive_attr attr;
+  attr.set_scratchpad_mode(scratchpad_mode::user);
+  lrn_forward::primitive_desc pd;
+  lrn_prim = dnnl_primitive<lrn_forward>(
+      dnnl_cache_key(op_desc) + dnnl_cache_key(attr),
+      [&]() { return lrn_forward::primitive_desc(op_desc, attr, eng); }, &pd);
+  scratchpad_mem = memory(pd.scratchpad_desc(), eng);
 }
 
 void LRN::run() {
-  lrn_prim.execute(engine_stream,
-                   {{DNNL_ARG_SRC, src_mem}, {DNNL_ARG_DST, dst_mem}});
-  engine_stream.wait();
+  lrn_prim.execute(dnnl_stream(), {{DNNL_ARG_SRC, src_mem},
+                                  {DNNL_ARG_DST, dst_mem},
+                                  {DNNL_ARG_SCRATCHPAD, scratchpad_mem}});
+  dnnl_stream().wait();
 }
 
 } // namespace tpu_mlir
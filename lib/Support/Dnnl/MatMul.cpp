@@ -16,10 +16,7 @@ using tag = memory::format_tag;
 using dt = memory::data_type;
 
 namespace tpu_mlir {
-MatMul::MatMul() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  engine_stream = dnnl::stream(eng);
-}
+MatMul::MatMul() { eng = dnnl_engine(); }
 
 void MatMul::right_init(float *right, int64_t right_zp, int64_t batch,
                         int64_t K, int64_t N, bool right_transpose) {
@@ -50,7 +47,8 @@ void MatMul::input_init(float *input, int64_t input_zp, int64_t batch,
 void MatMul::setup(float *left, float *right, float *bias, float *output,
                    int64_t batch, int64_t M, int64_t K, int64_t N,
                    bool do_relu, double relu_limit, int64_t right_zp,
-                   bool right_transpose, int64_t input_zp) {
+                   bool right_transpose, int64_t input_zp,
+                   bool right_is_coeff, memory::data_type left_dt) {
   // printf("MatMul ldt:%ld, rdt:%ld, bdt:%ld, odt:%ld, rshift:%ld\n", ldt, rdt,
   // bdt, odt, rshift);
   memory::dims src_dims = {batch, M, K};
@@ -65,21 +63,32 @@ void MatMul::setup(float *left, float *right, float *bias, float *output,
   K_ = K;
   right_zp_ = right_zp;
   input_zp_ = input_zp;
+  if (right_is_coeff) {
+    // done once, run() skips them
+    right_prepare();
+    right_has_zp_ = has_transpose_ = false;
+  }
   net.clear();
   net_args.clear();
-  auto src_md = memory::desc(src_dims, memory::data_type::f32, tag::abc);
-  auto weights_md =
-      memory::desc(weights_dims, memory::data_type::f32, tag::abc);
+  auto right_dt = left_dt == dt::f32 ? dt::f32 : dt::s8;
+  auto src_md = memory::desc(src_dims, left_dt, tag::abc);
+  // int8 lets the primitive choose a packed layout for right
+  auto weights_md = memory::desc(weights_dims, right_dt,
+                                 right_dt == dt::f32 ? tag::abc : tag::any);
   auto bias_md = memory::desc(bias_dims, memory::data_type::f32, tag::abc);
   auto dst_md = memory::desc(dst_dims, memory::data_type::f32, tag::abc);
   auto matmul_d = matmul::desc(src_md, weights_md, bias_md, dst_md);
   post_ops ops;
   matmul::primitive_desc matmul_pd;
   primitive_attr matmul_attr;
+  matmul_attr.set_scratchpad_mode(scratchpad_mode::user);
 
   post_relu(matmul_attr, do_relu, relu_limit);
 
-  matmul_pd = matmul::primitive_desc(matmul_d, matmul_attr, eng);
+  auto matmul_prim = dnnl_primitive<matmul>(
+      dnnl_cache_key(matmul_d) + dnnl_cache_key(matmul_attr),
+      [&]() { return matmul::primitive_desc(matmul_d, matmul_attr, eng); },
+      &matmul_pd);
 
   auto src_float_memory = memory(
       {{src_dims}, memory::data_type::f32, memory::format_tag::abc}, eng, p_input);
@@ -97,9 +106,17 @@ void MatMul::setup(float *left, float *right, float *bias, float *output,
   auto prim_weights_memory = weights_float_memory;
   if (matmul_pd.weights_desc() != weights_float_memory.get_desc()) {
     prim_weights_memory = memory(matmul_pd.weights_desc(), eng);
-    net.push_back(reorder(weights_float_memory, prim_weights_memory));
-    net_args.push_back({{DNNL_ARG_FROM, weights_float_memory},
-                        {DNNL_ARG_TO, prim_weights_memory}});
+    if (right_is_coeff) {
+      reorder(weights_float_memory, prim_weights_memory)
+          .execute(dnnl_stream(), weights_float_memory, prim_weights_memory);
+      dnnl_stream().wait();
+      // only the packed weights are kept
+      right_after_init.reset();
+    } else {
+      net.push_back(reorder(weights_float_memory, prim_weights_memory));
+      net_args.push_back({{DNNL_ARG_FROM, weights_float_memory},
+                          {DNNL_ARG_TO, prim_weights_memory}});
+    }
   }
 
   auto prim_bias_memory = memory();
@@ -110,17 +127,25 @@ void MatMul::setup(float *left, float *right, float *bias, float *output,
   prim_bias_memory = bias_float_memory;
   if (matmul_pd.bias_desc() != bias_float_memory.get_desc()) {
     prim_bias_memory = memory(matmul_pd.bias_desc(), eng);
-    net.push_back(reorder(bias_float_memory, prim_bias_memory));
-    net_args.push_back({{DNNL_ARG_FROM, bias_float_memory},
-                        {DNNL_ARG_TO, prim_bias_memory}});
+    if (right_is_coeff) {
+      reorder(bias_float_memory, prim_bias_memory)
+          .execute(dnnl_stream(), bias_float_memory, prim_bias_memory);
+      dnnl_stream().wait();
+    } else {
+      net.push_back(reorder(bias_float_memory, prim_bias_memory));
+      net_args.push_back({{DNNL_ARG_FROM, bias_float_memory},
+                          {DNNL_ARG_TO, prim_bias_memory}});
+    }
   }
 
   auto prim_dst_memory = memory(matmul_pd.dst_desc(), eng);
-  net.push_back(matmul(matmul_pd));
-  net_args.push_back({{DNNL_ARG_SRC, prim_src_memory},
-                      {DNNL_ARG_WEIGHTS, prim_weights_memory},
-                      {DNNL_ARG_BIAS, prim_bias_memory},
-                      {DNNL_ARG_DST, prim_dst_memory}});
+  net.push_back(matmul_prim);
+  net_args.push_back(
+      {{DNNL_ARG_SRC, prim_src_memory},
+       {DNNL_ARG_WEIGHTS, prim_weights_memory},
+       {DNNL_ARG_BIAS, prim_bias_memory},
+       {DNNL_ARG_DST, prim_dst_memory},
+       {DNNL_ARG_SCRATCHPAD, memory(matmul_pd.scratchpad_desc(), eng)}});
 
   // reorder or copy the output
   auto dst_memory =
@@ -133,7 +158,7 @@ void MatMul::setup(float *left, float *right, float *bias, float *output,
   }
 }
 
-void MatMul::run() {
+void MatMul::right_prepare() {
   float* p_input_after = origin_right;
   if (has_transpose_) {
     tensor_hw_transpose(right_after_init->data(), origin_right, 1, batch_, N_, K_);
@@ -143,10 +168,15 @@ void MatMul::run() {
     int64_t weight_len = batch_ * K_ * N_;
     tensor_sub_zp(right_after_init->data(), p_input_after, weight_len, right_zp_);
   }
+}
+
+void MatMul::run() {
+  right_prepare();
   if (input_has_zp_) {
     int64_t input_len = batch_ * K_ * M_;
     tensor_sub_zp(input_after_init->data(), origin_input, input_len, input_zp_);
   }
+  auto &engine_stream = dnnl_stream();
   for (size_t i = 0; i < net.size(); ++i)
     net.at(i).execute(engine_stream, net_args.at(i));
   engine_stream.wait();
@@ -9,28 +9,33 @@
 
 #include "tpu_mlir/Support/Dnnl/PRelu.h"
 #include "oneapi/dnnl/dnnl.hpp"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 #include <string.h>
 using namespace dnnl;
 
 namespace tpu_mlir {
-PRelu::PRelu() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
-}
+PRelu::PRelu() { eng = dnnl_engine(); }
 
 void PRelu::setup(/*float *input, float *output, prelu_attr_t &attr*/) {
   //auto src_md = memory::desc(src_shape, memory::data_type::f32, memory::format_tag::nchw);
   //auto weights_md = memory::desc(weights_shape, memory::data_type::f32, memory::format_tag::nchw);
   auto  prelu_d = prelu_forward::desc(
                  prop_kind::forward_inference, src_mem.get_desc(), weights_mem.get_desc());
-  auto prelu_pd = prelu_forward::primitive_desc(prelu_d, eng);
-  prelu_prim = prelu_forward(prelu_pd);
+  primitive_attr attr;
+  attr.set_scratchpad_mode(scratchpad_mode::user);
+  prelu_forward::primitive_desc prelu_pd;
+  prelu_prim = dnnl_primitive<prelu_forward>(
+      dnnl_cache_key(prelu_d) + dnnl_cache_key(attr),
+      [&]() { return prelu_forward::primitive_desc(prelu_d, attr, eng); },
+      &prelu_pd);
+  scratchpad_mem = memory(prelu_pd.scratchpad_desc(), eng);
 }
 void PRelu::run() {
-    prelu_prim.execute(eng_stream, {{DNNL_ARG_SRC, src_mem},
-                                    {DNNL_ARG_WEIGHTS, weights_mem},
-                                    {DNNL_ARG_DST, dst_mem}});
-    eng_stream.wait();
+    prelu_prim.execute(dnnl_stream(), {{DNNL_ARG_SRC, src_mem},
+                                       {DNNL_ARG_WEIGHTS, weights_mem},
+                                       {DNNL_ARG_DST, dst_mem},
+                                       {DNNL_ARG_SCRATCHPAD, scratchpad_mem}});
+    dnnl_stream().wait();
 }
   /*
 Binary::Binary() {
@@ -8,14 +8,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/Dnnl/Pool.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 #include "tpu_mlir/Support/MathUtils.h"
 
 using namespace dnnl;
 using namespace tpu_mlir;
 
 Pooling::Pooling() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
+  eng = dnnl_engine();
   memset(&_attrs, 0, sizeof(pool_attr_t));
   _izp = 0;
 }
@@ -44,7 +44,7 @@ void Pooling::pad_init(float *input, pool_attr_t &attr, int izp) {
 }
 
 void Pooling::setup(float *input, float *output, pool_attr_t attr, bool is_avg,
-                    int izp) {
+                    int izp, memory::data_type dt) {
   this->kd = attr.kd;
   this->kh = attr.kh;
   this->kw = attr.kw;
@@ -55,10 +55,8 @@ void Pooling::setup(float *input, float *output, pool_attr_t attr, bool is_avg,
   memory::dims padding_tl = {attr.pad_d, attr.pad_h, attr.pad_w};
   memory::dims padding_br = {attr.pad_d_after, attr.pad_h_after,
                              attr.pad_w_after};
-  auto src_md = memory::desc({src_shape}, memory::data_type::f32,
-                             memory::format_tag::ncdhw);
-  auto dst_md = memory::desc({dst_shape}, memory::data_type::f32,
-                             memory::format_tag::ncdhw);
+  auto src_md = memory::desc({src_shape}, dt, memory::format_tag::ncdhw);
+  auto dst_md = memory::desc({dst_shape}, dt, memory::format_tag::ncdhw);
   auto pool_avg_algo = attr.count_include_pad
                            ? algorithm::pooling_avg_include_padding
                            : algorithm::pooling_avg_exclude_padding;
@@ -68,7 +66,14 @@ void Pooling::setup(float *input, float *output, pool_attr_t attr, bool is_avg,
       is_avg ? pool_avg_algo : algorithm::pooling_max, src_md, dst_md, strides,
       kernel, padding_tl, padding_br);
 
-  prim_desc = pooling_forward::primitive_desc(pool_desc, eng);
+  primitive_attr pool_attr;
+  pool_attr.set_scratchpad_mode(scratchpad_mode::user);
+  auto pool_prim = dnnl_primitive<pooling_forward>(
+      dnnl_cache_key(pool_desc) + dnnl_cache_key(pool_attr),
+      [&]() {
+        return pooling_forward::primitive_desc(pool_desc, pool_attr, eng);
+      },
+      &prim_desc);
   memory src_memory =
       memory({{src_shape}, memory::data_type::f32, memory::format_tag::ncdhw},
              eng, p_input);
@@ -85,9 +90,11 @@ void Pooling::setup(float *input, float *output, pool_attr_t attr, bool is_avg,
         {{DNNL_ARG_FROM, src_memory}, {DNNL_ARG_TO, prim_src_memory}});
   }
   auto prim_dst_memory = memory(prim_desc.dst_desc(), eng);
-  net.push_back(pooling_forward(prim_desc));
+  net.push_back(pool_prim);
   net_args.push_back(
-      {{DNNL_ARG_SRC, prim_src_memory}, {DNNL_ARG_DST, prim_dst_memory}});
+      {{DNNL_ARG_SRC, prim_src_memory},
+       {DNNL_ARG_DST, prim_dst_memory},
+       {DNNL_ARG_SCRATCHPAD, memory(prim_desc.scratchpad_desc(), eng)}});
   if (prim_dst_memory != dst_memory) {
     net.push_back(reorder(prim_dst_memory, dst_memory));
     net_args.push_back(
@@ -102,6 +109,7 @@ void Pooling::run() {
                _attrs.pad_d_after, _attrs.pad_h, _attrs.pad_h_after,
                _attrs.pad_w, _attrs.pad_w_after, _izp);
   }
+  auto &eng_stream = dnnl_stream();
   for (size_t i = 0; i < net.size(); ++i)
     net.at(i).execute(eng_stream, net_args.at(i));
   eng_stream.wait();
@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/Dnnl/Softmax.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 
 using namespace dnnl;
 using tag = memory::format_tag;
@@ -16,10 +17,7 @@ using dt = memory::data_type;
 
 namespace tpu_mlir {
 
-Softmax::Softmax() {
-  eng = dnnl::engine(engine::kind::cpu, 0);
-  eng_stream = dnnl::stream(eng);
-}
+Softmax::Softmax() { eng = dnnl_engine(); }
 
 void Softmax::setup(float *input, float *output, softmax_attr_t &attr) {
   this->attr_ = std::move(attr);
@@ -32,25 +30,42 @@ void Softmax::setup(float *input, float *output, softmax_attr_t &attr) {
   auto dst_md = memory::desc(attr_.dst_shape, dt::f32, tag::ncw);
   auto dst_mem = memory(dst_md, eng, p_output);
 
+  primitive_attr softmax_attr;
+  softmax_attr.set_scratchpad_mode(scratchpad_mode::user);
+  memory::desc scratchpad_md;
   if (attr.log == false) {
     auto softmax_d =
         softmax_forward::desc(prop_kind::forward_inference, src_md, attr_.axis);
-    auto softmax_pd = softmax_forward::primitive_desc(softmax_d, eng);
-    softmax_prim = softmax_forward(softmax_pd);
+    softmax_forward::primitive_desc softmax_pd;
+    softmax_prim = dnnl_primitive<softmax_forward>(
+        dnnl_cache_key(softmax_d) + dnnl_cache_key(softmax_attr),
+        [&]() {
+          return softmax_forward::primitive_desc(softmax_d, softmax_attr, eng);
+        },
+        &softmax_pd);
+    scratchpad_md = softmax_pd.scratchpad_desc();
   } else {
     auto softmax_d = logsoftmax_forward::desc(prop_kind::forward_inference,
                                               src_md, attr_.axis);
-    auto softmax_pd = logsoftmax_forward::primitive_desc(softmax_d, eng);
-    softmax_prim = logsoftmax_forward(softmax_pd);
+    logsoftmax_forward::primitive_desc softmax_pd;
+    softmax_prim = dnnl_primitive<logsoftmax_forward>(
+        dnnl_cache_key(softmax_d) + dnnl_cache_key(softmax_attr),
+        [&]() {
+          return logsoftmax_forward::primitive_desc(softmax_d, softmax_attr,
+                                                    eng);
+        },
+        &softmax_pd);
+    scratchpad_md = softmax_pd.scratchpad_desc();
   }
 
   softmax_args.insert({DNNL_ARG_SRC, src_mem});
   softmax_args.insert({DNNL_ARG_DST, dst_mem});
+  softmax_args.insert({DNNL_ARG_SCRATCHPAD, memory(scratchpad_md, eng)});
 }
 
 void Softmax::run() {
-  softmax_prim.execute(eng_stream, softmax_args);
-  eng_stream.wait();
+  softmax_prim.execute(dnnl_stream(), softmax_args);
+  dnnl_stream().wait();
 }
 
 } // namespace tpu_mlir
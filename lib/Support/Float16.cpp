@@ -10,7 +10,11 @@
 #include "bitcasts.h"
 #include "tpu_mlir/Support/MathUtils.h"
 #include "tpu_mlir/Support/Module.h"
+#include <algorithm>
 #include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 
 namespace tpu_mlir {
@@ -821,20 +825,6 @@ float bf16_to_f32(uint16_t src) {
   return *((float *)&tmp);
 }
 
-void BF16(float *p_src, float *p_dst, int num, bool is_tpu) {
-#pragma omp parallel for schedule(static, omp_schedule(num))
-  for (int i = 0; i < num; i++) {
-    p_dst[i] = BF16(p_src[i], is_tpu);
-  }
-}
-
-void F16(float *p_src, float *p_dst, int num) {
-#pragma omp parallel for schedule(static, omp_schedule(num))
-  for (int i = 0; i < num; i++) {
-    p_dst[i] = F16(p_src[i]);
-  }
-}
-
 float F16(float src) {
   uint16_t tmp = f32_to_f16(src);
   return f16_to_f32(tmp);
@@ -844,4 +834,319 @@ float BF16(float src, bool is_tpu) {
   auto u16_val = f32_to_bf16(src, is_tpu);
   return bf16_to_f32(u16_val);
 }
+
+//===----------------------------------------------------------------------===//
+// bulk conversion
+//
+// The kernels below give the same bits as the scalar functions above, lane by
+// lane. bf16 rounding is done with integer ops: the native bf16 convert flushes
+// the 0x007f8000 denorm pattern and quiets NaN, which differs from the chip.
+//===----------------------------------------------------------------------===//
+
+enum bf16_mode_t { BF16_BM = 0, BF16_CVI_RNE = 1, BF16_CVI_TRUNC = 2 };
+
+static bf16_mode_t get_bf16_mode(bool is_tpu) {
+  if (module::isCV18xx()) {
+    return is_tpu ? BF16_CVI_RNE : BF16_CVI_TRUNC;
+  }
+  return BF16_BM;
+}
+
+// return bf16 in the high 16 bits
+template <int MODE> static inline uint32_t bf16_round_bits(uint32_t u) {
+  if (MODE == BF16_CVI_TRUNC) {
+    return u & 0xFFFF0000;
+  }
+  uint32_t r = (u + 0x7FFF + ((u >> 16) & 1)) & 0xFFFF0000;
+  if (MODE == BF16_CVI_RNE) {
+    return (r & 0x7F800000) == 0x7F800000 ? 0x7F7F0000 : r;
+  }
+  uint32_t exp = u & 0x7F800000;
+  if (exp == 0x7F800000) {
+    return (u & 0x7FFFFF) ? 0x7FFF0000 : u;
+  }
+  if (exp == 0) {
+    return (u & 0x80000000) | ((u & 0x7F8000) == 0x7F8000 ? 0x800000 : 0);
+  }
+  return r;
+}
+
+template <int MODE>
+static void bf16_kernel_ref(const uint32_t *src, uint32_t *dst, int64_t num,
+                            bool to_u16) {
+  for (int64_t i = 0; i < num; i++) {
+    uint32_t r = bf16_round_bits<MODE>(src[i]);
+    if (to_u16) {
+      ((uint16_t *)dst)[i] = r >> 16;
+    } else {
+      dst[i] = r;
+    }
+  }
+}
+
+static void f16_kernel_ref(const uint32_t *src, uint32_t *dst, int64_t num,
+                           bool to_u16) {
+  for (int64_t i = 0; i < num; i++) {
+    float f = fp32_from_bits(src[i]);
+    if (to_u16) {
+      ((uint16_t *)dst)[i] = f32_to_f16(f);
+    } else {
+      dst[i] = fp32_to_bits(F16(f));
+    }
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AVX2_TARGET __attribute__((target("avx2,f16c")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+template <int MODE> AVX2_TARGET static inline __m256i bf16_avx2(__m256i u) {
+  if (MODE == BF16_CVI_TRUNC) {
+    return _mm256_and_si256(u, _mm256_set1_epi32(0xFFFF0000));
+  }
+  const __m256i lsb =
+      _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+  __m256i r = _mm256_add_epi32(_mm256_add_epi32(u, _mm256_set1_epi32(0x7FFF)),
+                               lsb);
+  r = _mm256_and_si256(r, _mm256_set1_epi32(0xFFFF0000));
+  const __m256i exp_mask = _mm256_set1_epi32(0x7F800000);
+  if (MODE == BF16_CVI_RNE) {
+    __m256i inf = _mm256_cmpeq_epi32(_mm256_and_si256(r, exp_mask), exp_mask);
+    return _mm256_blendv_epi8(r, _mm256_set1_epi32(0x7F7F0000), inf);
+  }
+  const __m256i exp = _mm256_and_si256(u, exp_mask);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i frac_zero = _mm256_cmpeq_epi32(
+      _mm256_and_si256(u, _mm256_set1_epi32(0x7FFFFF)), zero);
+  const __m256i special =
+      _mm256_blendv_epi8(_mm256_set1_epi32(0x7FFF0000), u, frac_zero);
+  const __m256i denorm_pat = _mm256_set1_epi32(0x7F8000);
+  const __m256i denorm_up =
+      _mm256_cmpeq_epi32(_mm256_and_si256(u, denorm_pat), denorm_pat);
+  const __m256i denorm = _mm256_or_si256(
+      _mm256_and_si256(u, _mm256_set1_epi32(0x80000000)),
+      _mm256_and_si256(denorm_up, _mm256_set1_epi32(0x800000)));
+  r = _mm256_blendv_epi8(r, denorm, _mm256_cmpeq_epi32(exp, zero));
+  return _mm256_blendv_epi8(r, special, _mm256_cmpeq_epi32(exp, exp_mask));
+}
+
+// 8 x u32 with bf16 in the high half, to 8 x u16
+AVX2_TARGET static inline __m128i pack_high_avx2(__m256i r) {
+  r = _mm256_srli_epi32(r, 16);
+  __m128i lo = _mm256_castsi256_si128(r);
+  __m128i hi = _mm256_extracti128_si256(r, 1);
+  return _mm_packus_epi32(lo, hi);
+}
+
+template <int MODE>
+AVX2_TARGET static void bf16_kernel_avx2(const uint32_t *src, uint32_t *dst,
+                                         int64_t num, bool to_u16) {
+  int64_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256i r = bf16_avx2<MODE>(_mm256_loadu_si256((const __m256i *)(src + i)));
+    if (to_u16) {
+      _mm_storeu_si128((__m128i *)((uint16_t *)dst + i), pack_high_avx2(r));
+    } else {
+      _mm256_storeu_si256((__m256i *)(dst + i), r);
+    }
+  }
+  bf16_kernel_ref<MODE>(src + i,
+                        to_u16 ? (uint32_t *)((uint16_t *)dst + i) : dst + i,
+                        num - i, to_u16);
+}
+
+AVX2_TARGET static void f16_kernel_avx2(const uint32_t *src, uint32_t *dst,
+                                        int64_t num, bool to_u16) {
+  const int rmode = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+  int64_t i = 0;
+  for (; i + 8 <= num; i += 8) {
+    __m256 x = _mm256_loadu_ps((const float *)(src + i));
+    __m256 nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+    __m128i h = _mm256_cvtps_ph(x, rmode);
+    if (to_u16) {
+      __m256i nan_i = _mm256_castps_si256(nan);
+      __m128i nan16 = _mm_packs_epi32(_mm256_castsi256_si128(nan_i),
+                                      _mm256_extracti128_si256(nan_i, 1));
+      h = _mm_blendv_epi8(h, _mm_set1_epi16(0x7FFF), nan16);
+      _mm_storeu_si128((__m128i *)((uint16_t *)dst + i), h);
+    } else {
+      __m256 y = _mm256_cvtph_ps(h);
+      y = _mm256_blendv_ps(y, _mm256_castsi256_ps(_mm256_set1_epi32(0xFFC00000)),
+                           nan);
+      _mm256_storeu_ps((float *)(dst + i), y);
+    }
+  }
+  f16_kernel_ref(src + i, to_u16 ? (uint32_t *)((uint16_t *)dst + i) : dst + i,
+                 num - i, to_u16);
+}
+
+template <int MODE>
+AVX512_TARGET static inline __m512i bf16_avx512(__m512i u) {
+  if (MODE == BF16_CVI_TRUNC) {
+    return _mm512_and_si512(u, _mm512_set1_epi32(0xFFFF0000));
+  }
+  const __m512i lsb =
+      _mm512_and_si512(_mm512_srli_epi32(u, 16), _mm512_set1_epi32(1));
+  __m512i r = _mm512_add_epi32(_mm512_add_epi32(u, _mm512_set1_epi32(0x7FFF)),
+                               lsb);
+  r = _mm512_and_si512(r, _mm512_set1_epi32(0xFFFF0000));
+  const __m512i exp_mask = _mm512_set1_epi32(0x7F800000);
+  if (MODE == BF16_CVI_RNE) {
+    __mmask16 inf =
+        _mm512_cmpeq_epi32_mask(_mm512_and_si512(r, exp_mask), exp_mask);
+    return _mm512_mask_blend_epi32(inf, r, _mm512_set1_epi32(0x7F7F0000));
+  }
+  const __m512i exp = _mm512_and_si512(u, exp_mask);
+  const __m512i zero = _mm512_setzero_si512();
+  __mmask16 frac_zero = _mm512_cmpeq_epi32_mask(
+      _mm512_and_si512(u, _mm512_set1_epi32(0x7FFFFF)), zero);
+  const __m512i special =
+      _mm512_mask_blend_epi32(frac_zero, _mm512_set1_epi32(0x7FFF0000), u);
+  const __m512i denorm_pat = _mm512_set1_epi32(0x7F8000);
+  __mmask16 denorm_up =
+      _mm512_cmpeq_epi32_mask(_mm512_and_si512(u, denorm_pat), denorm_pat);
+  __m512i denorm = _mm512_and_si512(u, _mm512_set1_epi32(0x80000000));
+  denorm = _mm512_mask_or_epi32(denorm, denorm_up, denorm,
+                                _mm512_set1_epi32(0x800000));
+  r = _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(exp, zero), r, denorm);
+  return _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(exp, exp_mask), r,
+                                 special);
+}
+
+template <int MODE>
+AVX512_TARGET static void bf16_kernel_avx512(const uint32_t *src,
+                                             uint32_t *dst, int64_t num,
+                                             bool to_u16) {
+  int64_t i = 0;
+  for (; i + 16 <= num; i += 16) {
+    __m512i r = bf16_avx512<MODE>(_mm512_loadu_si512(src + i));
+    if (to_u16) {
+      _mm256_storeu_si256((__m256i *)((uint16_t *)dst + i),
+                          _mm512_cvtepi32_epi16(_mm512_srli_epi32(r, 16)));
+    } else {
+      _mm512_storeu_si512(dst + i, r);
+    }
+  }
+  bf16_kernel_ref<MODE>(src + i,
+                        to_u16 ? (uint32_t *)((uint16_t *)dst + i) : dst + i,
+                        num - i, to_u16);
+}
+
+AVX512_TARGET static void f16_kernel_avx512(const uint32_t *src,
+                                            uint32_t *dst, int64_t num,
+                                            bool to_u16) {
+  const int rmode = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+  int64_t i = 0;
+  for (; i + 16 <= num; i += 16) {
+    __m512 x = _mm512_loadu_ps(src + i);
+    __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+    __m256i h = _mm512_cvtps_ph(x, rmode);
+    if (to_u16) {
+      __m512i h32 = _mm512_cvtepu16_epi32(h);
+      h32 = _mm512_mask_blend_epi32(nan, h32, _mm512_set1_epi32(0x7FFF));
+      _mm256_storeu_si256((__m256i *)((uint16_t *)dst + i),
+                          _mm512_cvtepi32_epi16(h32));
+    } else {
+      __m512 y = _mm512_cvtph_ps(h);
+      y = _mm512_mask_blend_ps(
+          nan, y, _mm512_castsi512_ps(_mm512_set1_epi32(0xFFC00000)));
+      _mm512_storeu_ps(dst + i, y);
+    }
+  }
+  f16_kernel_ref(src + i, to_u16 ? (uint32_t *)((uint16_t *)dst + i) : dst + i,
+                 num - i, to_u16);
+}
+
+enum cvt_isa_t { ISA_REF = 0, ISA_AVX2 = 1, ISA_AVX512 = 2 };
+
+static cvt_isa_t get_cvt_isa() {
+  static const cvt_isa_t isa = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) {
+      return ISA_AVX2;
+    }
+    return ISA_REF;
+  }();
+  return isa;
+}
+#endif
+
+typedef void (*cvt_kernel_t)(const uint32_t *, uint32_t *, int64_t, bool);
+
+template <int MODE> static cvt_kernel_t get_bf16_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  switch (get_cvt_isa()) {
+  case ISA_AVX512:
+    return bf16_kernel_avx512<MODE>;
+  case ISA_AVX2:
+    return bf16_kernel_avx2<MODE>;
+  default:
+    break;
+  }
+#endif
+  return bf16_kernel_ref<MODE>;
+}
+
+static cvt_kernel_t get_bf16_kernel(bf16_mode_t mode) {
+  switch (mode) {
+  case BF16_CVI_RNE:
+    return get_bf16_kernel<BF16_CVI_RNE>();
+  case BF16_CVI_TRUNC:
+    return get_bf16_kernel<BF16_CVI_TRUNC>();
+  default:
+    return get_bf16_kernel<BF16_BM>();
+  }
+}
+
+static cvt_kernel_t get_f16_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  switch (get_cvt_isa()) {
+  case ISA_AVX512:
+    return f16_kernel_avx512;
+  case ISA_AVX2:
+    return f16_kernel_avx2;
+  default:
+    break;
+  }
+#endif
+  return f16_kernel_ref;
+}
+
+// split into blocks and run kernel on omp threads
+static void cvt_parallel(cvt_kernel_t kernel, const float *p_src, void *p_dst,
+                         int64_t num, bool to_u16) {
+  const int64_t block = 16384;
+  int64_t num_blocks = ceiling_func(num, block);
+  auto src = (const uint32_t *)p_src;
+#pragma omp parallel for schedule(static, omp_schedule(num_blocks))
+  for (int64_t b = 0; b < num_blocks; b++) {
+    int64_t offset = b * block;
+    int64_t len = std::min(block, num - offset);
+    auto dst = to_u16 ? (uint32_t *)((uint16_t *)p_dst + offset)
+                      : (uint32_t *)p_dst + offset;
+    kernel(src + offset, dst, len, to_u16);
+  }
+}
+
+void f32_to_f16(const float *p_src, uint16_t *p_dst, int64_t num) {
+  cvt_parallel(get_f16_kernel(), p_src, p_dst, num, true);
+}
+
+void f32_to_bf16(const float *p_src, uint16_t *p_dst, int64_t num,
+                 bool is_tpu) {
+  cvt_parallel(get_bf16_kernel(get_bf16_mode(is_tpu)), p_src, p_dst, num,
+               true);
+}
+
+void BF16(float *p_src, float *p_dst, int num, bool is_tpu) {
+  cvt_parallel(get_bf16_kernel(get_bf16_mode(is_tpu)), p_src, p_dst, num,
+               false);
+}
+
+void F16(float *p_src, float *p_dst, int num) {
+  cvt_parallel(get_f16_kernel(), p_src, p_dst, num, false);
+}
 } // namespace tpu_mlir
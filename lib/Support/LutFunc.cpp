@@ -273,6 +273,11 @@ void bf16_gen_exponent_mantissa_table(const std::string &name, float *exp_table,
 
 void bf16_lut_mantissa(float *input, float *output, int size, float *exp_table,
                        float *mantissa_table, const std::string &method) {
+  bool is_log = method == "log";
+  if (!is_log && method != "mantissa") {
+    llvm::errs() << "unsupported lookup table func:" << method << "\n";
+    llvm_unreachable("Error");
+  }
   for (int i = 0; i < size; i++) {
     float val = input[i];
     uint16_t bf16_val = f32_to_bf16(val, false);
@@ -288,14 +293,10 @@ void bf16_lut_mantissa(float *input, float *output, int size, float *exp_table,
     }
     float exponent = exp_table[exponentIndex];
     float mantissa = mantissa_table[bf16_val & 0xff];
-    if (method == "mantissa")
-      output[i] = BF16(exponent * mantissa);
-    else if (method == "log")
+    if (is_log)
       output[i] = BF16(exponent + mantissa);
-    else {
-      llvm::errs() << "unsupported lookup table func:" << method << "\n";
-      llvm_unreachable("Error");
-    }
+    else
+      output[i] = BF16(exponent * mantissa);
   }
 }
 
@@ -12,11 +12,14 @@
 #include "mlir/IR/PatternMatch.h"
 #include "omp.h"
 #include "tpu_mlir/Support/Dnnl/Dnnl.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 #include "llvm/Support/Debug.h"
 #include <algorithm>
+#include <cstring>
 #include <map>
 #include <numeric>
 #include <queue>
+#include <tuple>
 
 #define DEBUG_TYPE "math_utils"
 namespace tpu_mlir {
@@ -514,6 +517,105 @@ int64_t applyMultiplierAndRShift(int64_t v, int64_t multiplier, int64_t rshift,
   return 0;
 }
 
+// RightShiftRound(src * multiplier, rshift, ROUNDING_HALF_UP) written without
+// branches; half is 1 when rshift is 0, so that nothing is rounded up
+__attribute__((always_inline)) static inline void
+requant_int8_kernel(float *data, int64_t num, float bias, int64_t multiplier,
+                    int64_t rshift, int64_t zero_point, int64_t qmin,
+                    int64_t qmax) {
+  int64_t mask = (1ll << rshift) - 1;
+  int64_t half = rshift > 0 ? 1ll << (rshift - 1) : 1;
+#pragma omp simd
+  for (int64_t i = 0; i < num; i++) {
+    int64_t src = (int64_t)(data[i] + bias) * multiplier;
+    int64_t v = (src >> rshift) + ((src & mask) >= half ? 1 : 0) + zero_point;
+    v = v < qmin ? qmin : v;
+    v = v > qmax ? qmax : v;
+    data[i] = (float)v;
+  }
+}
+
+typedef void (*requant_kernel_t)(float *, int64_t, float, int64_t, int64_t,
+                                 int64_t, int64_t, int64_t);
+
+static void requant_int8_ref(float *data, int64_t num, float bias,
+                             int64_t multiplier, int64_t rshift,
+                             int64_t zero_point, int64_t qmin, int64_t qmax) {
+  requant_int8_kernel(data, num, bias, multiplier, rshift, zero_point, qmin,
+                      qmax);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) static void
+requant_int8_avx2(float *data, int64_t num, float bias, int64_t multiplier,
+                  int64_t rshift, int64_t zero_point, int64_t qmin,
+                  int64_t qmax) {
+  requant_int8_kernel(data, num, bias, multiplier, rshift, zero_point, qmin,
+                      qmax);
+}
+
+// avx512dq has the int64 multiply and the f32 <-> int64 conversions
+__attribute__((target("avx512f,avx512dq"))) static void
+requant_int8_avx512(float *data, int64_t num, float bias, int64_t multiplier,
+                    int64_t rshift, int64_t zero_point, int64_t qmin,
+                    int64_t qmax) {
+  requant_int8_kernel(data, num, bias, multiplier, rshift, zero_point, qmin,
+                      qmax);
+}
+#endif
+
+static requant_kernel_t get_requant_kernel() {
+  static const requant_kernel_t kernel = []() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512dq")) {
+      return requant_int8_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return requant_int8_avx2;
+    }
+#endif
+    return requant_int8_ref;
+  }();
+  return kernel;
+}
+
+void requant_int8(float *data, int64_t num, int32_t bias, int64_t multiplier,
+                  int64_t rshift, int64_t zero_point, bool do_relu,
+                  mlir::Type out_type, tpu::RequantMode qmode,
+                  RoundingMode rmode) {
+  auto itype = out_type.dyn_cast<mlir::IntegerType>();
+  bool fast = itype && itype.getWidth() <= 32 && !module::isCV18xx() &&
+              rmode == ROUNDING_HALF_UP && rshift >= 0 && rshift < 63 &&
+              (qmode == tpu::RequantMode::MultiplierShift ||
+               qmode == tpu::RequantMode::OnlyShift);
+  if (!fast) {
+    for (int64_t i = 0; i < num; i++) {
+      int64_t v = applyMultiplierAndRShift(data[i] + bias, multiplier, rshift,
+                                           qmode, rmode) +
+                  zero_point;
+      if (do_relu && v < 0) {
+        v = 0;
+      }
+      data[i] = saturate(v, out_type);
+    }
+    return;
+  }
+  auto N = itype.getWidth();
+  int64_t qmax = itype.isUnsigned() ? llvm::maxUIntN(N) : llvm::maxIntN(N);
+  int64_t qmin = itype.isUnsigned() ? 0 : llvm::minIntN(N);
+  // relu then saturate is the same as clamping at max(qmin, 0)
+  if (do_relu && qmin < 0) {
+    qmin = 0;
+  }
+  if (qmode == tpu::RequantMode::OnlyShift) {
+    multiplier = 1;
+  }
+  get_requant_kernel()(data, num, bias, multiplier, rshift, zero_point, qmin,
+                       qmax);
+}
+
 void pad_tensor(float *p_after_pad, float *src, int n, int c, int h, int w,
                 int pt, int pb, int pl, int pr, float pad_value) {
   int nc = n * c;
@@ -602,17 +704,7 @@ void tensor_sub_zp(float *tensor_after_zp, float *src, int64_t length,
 
 void tensor_hw_transpose(float *dst, float *src, int64_t N, int64_t C,
                          int64_t H, int64_t W) {
-#pragma omp parallel for schedule(static, omp_schedule(N *C))
-  for (int64_t nc = 0; nc < N * C; ++nc) {
-    int64_t nc_offset = nc * H * W;
-    for (int w = 0; w < W; ++w) {
-      for (int h = 0; h < H; ++h) {
-        int64_t d_offset = nc_offset + w * H + h;
-        int64_t s_offset = nc_offset + h * W + w;
-        dst[d_offset] = src[s_offset];
-      }
-    }
-  }
+  function_permute(src, dst, {N * C, H, W}, {0, 2, 1});
 }
 
 void tensor_split(float *src_data, std::vector<std::vector<float>> &dst_data,
@@ -674,11 +766,6 @@ void function_relu(float *src, float *dst, int64_t size, float relu_limit,
 
 int dnnl_mm(float *input, float *weight, float *bias, float *output, int m,
             int k, int n, bool transpose) {
-  if (!bias) {
-    auto zero_bias = new std::vector<float>(n, 0.0f);
-    bias = zero_bias->data();
-  }
-
 #ifdef DUMP_FLAG
   static int dump_idx = 0;
   std::string prefix = std::string("ip") + std::to_string(dump_idx);
@@ -691,76 +778,47 @@ int dnnl_mm(float *input, float *weight, float *bias, float *output, int m,
   using tag = memory::format_tag;
   using dt = memory::data_type;
 
-  engine eng(engine::kind::cpu, 0);
-  stream s(eng);
-
-  std::vector<primitive> net;
-  std::vector<std::unordered_map<int, memory>> net_args;
+  // recurrent ops call this several times per timestep with the same shapes,
+  // so primitives are kept per thread and reused. Memory is described in
+  // plain layouts, then no reorder depends on the pointers.
+  auto &eng = dnnl_engine();
+  auto &s = dnnl_stream();
+  static thread_local std::map<std::tuple<int, int, int, bool>,
+                               inner_product_forward>
+      fc_cache;
 
   memory::dims src_tz = {m, k};
   memory::dims weights_tz = {n, k};
   memory::dims bias_tz = {n};
   memory::dims dst_tz = {m, n};
 
-  if (!bias) {
-    auto zero_bias = new std::vector<float>(n, 0.0f);
-    bias = zero_bias->data();
-  }
-
-  // memory
-  auto user_src_memory = memory({{src_tz}, dt::f32, tag::nc}, eng, input);
-  auto user_weights_memory =
-      memory({{weights_tz}, dt::f32, tag::oi}, eng, weight);
-  auto user_bias_memory = memory({{bias_tz}, dt::f32, tag::x}, eng, bias);
-  auto user_dst_memory = memory({{dst_tz}, dt::f32, tag::nc}, eng, output);
+  auto src_md = memory::desc({src_tz}, dt::f32, tag::nc);
+  auto weights_md = memory::desc({weights_tz}, dt::f32, tag::oi);
+  auto bias_md = memory::desc({bias_tz}, dt::f32, tag::x);
+  auto dst_md = memory::desc({dst_tz}, dt::f32, tag::nc);
 
-  // md
-  auto src_md = memory::desc({src_tz}, dt::f32, tag::any);
-  auto weights_md = memory::desc({weights_tz}, dt::f32, tag::any);
-  auto bias_md = memory::desc({bias_tz}, dt::f32, tag::any);
-  auto dst_md = memory::desc({dst_tz}, dt::f32, tag::any);
-
-  // fc desc
-  auto fc_desc = inner_product_forward::desc(
-      prop_kind::forward_inference, src_md, weights_md, bias_md, dst_md);
-  auto fc_prim_desc = inner_product_forward::primitive_desc(fc_desc, eng);
-
-  // do reorder if needed
-  auto src_memory = user_src_memory;
-  if (fc_prim_desc.src_desc() != user_src_memory.get_desc()) {
-    src_memory = memory(fc_prim_desc.src_desc(), eng);
-    net.push_back(reorder(user_src_memory, src_memory));
-    net_args.push_back(
-        {{DNNL_ARG_FROM, user_src_memory}, {DNNL_ARG_TO, src_memory}});
+  auto key = std::make_tuple(m, k, n, bias != nullptr);
+  auto iter = fc_cache.find(key);
+  if (iter == fc_cache.end()) {
+    auto fc_desc =
+        bias ? inner_product_forward::desc(prop_kind::forward_inference,
+                                           src_md, weights_md, bias_md, dst_md)
+             : inner_product_forward::desc(prop_kind::forward_inference,
+                                           src_md, weights_md, dst_md);
+    auto fc_prim_desc = inner_product_forward::primitive_desc(fc_desc, eng);
+    iter = fc_cache.emplace(key, inner_product_forward(fc_prim_desc)).first;
   }
-  auto weights_memory = user_weights_memory;
-  if (fc_prim_desc.weights_desc() != user_weights_memory.get_desc()) {
-    weights_memory = memory(fc_prim_desc.weights_desc(), eng);
-    reorder(user_weights_memory, weights_memory)
-        .execute(s, user_weights_memory, weights_memory);
-  }
-  auto bias_memory = user_bias_memory;
-
-  auto dst_memory = memory(fc_prim_desc.dst_desc(), eng);
 
-  net.push_back(inner_product_forward(fc_prim_desc));
-  net_args.push_back({{DNNL_ARG_SRC, src_memory},
-                      {DNNL_ARG_WEIGHTS, weights_memory},
-                      {DNNL_ARG_BIAS, bias_memory},
-                      {DNNL_ARG_DST, dst_memory}});
-
-  // reorder or copy the output
-  if (dst_memory != user_dst_memory) {
-    net.push_back(reorder(dst_memory, user_dst_memory));
-    net_args.push_back(
-        {{DNNL_ARG_FROM, dst_memory}, {DNNL_ARG_TO, user_dst_memory}});
+  std::unordered_map<int, memory> args = {
+      {DNNL_ARG_SRC, memory(src_md, eng, input)},
+      {DNNL_ARG_WEIGHTS, memory(weights_md, eng, weight)},
+      {DNNL_ARG_DST, memory(dst_md, eng, output)}};
+  if (bias) {
+    args.insert({DNNL_ARG_BIAS, memory(bias_md, eng, bias)});
   }
 
   // run
-  assert(net.size() == net_args.size() && "something is missing");
-  for (size_t i = 0; i < net.size(); ++i)
-    net.at(i).execute(s, net_args.at(i));
-
+  iter->second.execute(s, args);
   s.wait();
 
 #ifdef DUMP_FLAG
@@ -1053,45 +1111,172 @@ bool permute_reset(const std::vector<int64_t> &shape,
   return true;
 }
 
+// Drop unit dims, then fuse runs of input dims that stay adjacent in the
+// output, so every permute is reduced to the fewest dims possible.
+static void permute_simplify(const std::vector<int64_t> &shape,
+                             const std::vector<int64_t> &order,
+                             std::vector<int64_t> &new_shape,
+                             std::vector<int64_t> &new_order) {
+  int num_dims = shape.size();
+  std::vector<int64_t> kept(num_dims, -1);
+  std::vector<int64_t> s;
+  for (int i = 0; i < num_dims; i++) {
+    if (shape[i] != 1) {
+      kept[i] = s.size();
+      s.push_back(shape[i]);
+    }
+  }
+  std::vector<int64_t> o;
+  for (auto d : order) {
+    if (kept[d] >= 0) {
+      o.push_back(kept[d]);
+    }
+  }
+  // runs of consecutive input dims, listed in output order
+  std::vector<std::pair<int64_t, int64_t>> runs; // (first dim, last dim)
+  for (auto d : o) {
+    if (!runs.empty() && runs.back().second + 1 == d) {
+      runs.back().second = d;
+    } else {
+      runs.emplace_back(d, d);
+    }
+  }
+  std::vector<int64_t> by_input(runs.size());
+  std::iota(by_input.begin(), by_input.end(), 0);
+  std::sort(by_input.begin(), by_input.end(), [&](int64_t a, int64_t b) {
+    return runs[a].first < runs[b].first;
+  });
+  new_shape.assign(runs.size(), 1);
+  new_order.assign(runs.size(), 0);
+  for (size_t i = 0; i < by_input.size(); i++) {
+    auto &r = runs[by_input[i]];
+    for (auto d = r.first; d <= r.second; d++) {
+      new_shape[i] *= s[d];
+    }
+    new_order[by_input[i]] = i;
+  }
+}
+
 template <typename T>
-void function_permute(T *from, T *to, const std::vector<int64_t> &shape_5,
-                      const std::vector<int64_t> &order_5) {
-  int64_t in = shape_5[0];
-  int64_t ic = shape_5[1];
-  int64_t id = shape_5[2];
-  int64_t ih = shape_5[3];
-  int64_t iw = shape_5[4];
-  int64_t o0 = order_5[0];
-  int64_t o1 = order_5[1];
-  int64_t o2 = order_5[2];
-  int64_t o3 = order_5[3];
-  int64_t o4 = order_5[4];
-  // clang-format on
-  for (int n = 0; n < in; n++) {
-    for (int c = 0; c < ic; c++) {
-      for (int d = 0; d < id; d++) {
-        for (int h = 0; h < ih; h++) {
-          for (int w = 0; w < iw; w++) {
-            int cur[5] = {n, c, d, h, w};
-            int in_idx = w + h * iw + d * iw * ih + c * id * ih * iw +
-                         n * ic * id * ih * iw;
-            int out_idx =
-                cur[o4] + cur[o3] * shape_5[o4] +
-                cur[o2] * shape_5[o4] * shape_5[o3] +
-                cur[o1] * shape_5[o4] * shape_5[o3] * shape_5[o2] +
-                cur[o0] * shape_5[o4] * shape_5[o3] * shape_5[o2] * shape_5[o1];
-            to[out_idx] = from[in_idx];
-          }
-        }
+static void permute_impl(const T *from, T *to,
+                         const std::vector<int64_t> &shape,
+                         const std::vector<int64_t> &order) {
+  int64_t total = std::accumulate(shape.begin(), shape.end(), (int64_t)1,
+                                  std::multiplies<int64_t>());
+  // nothing to move, and the tile counts below would divide by 0
+  if (total == 0) {
+    return;
+  }
+  std::vector<int64_t> s, o;
+  permute_simplify(shape, order, s, o);
+  int num_dims = s.size();
+  if (num_dims <= 1) {
+    std::memcpy(to, from, total * sizeof(T));
+    return;
+  }
+  std::vector<int64_t> in_stride(num_dims, 1), out_stride(num_dims, 1);
+  for (int i = num_dims - 2; i >= 0; i--) {
+    in_stride[i] = in_stride[i + 1] * s[i + 1];
+  }
+  for (int i = num_dims - 2; i >= 0; i--) {
+    out_stride[o[i]] = out_stride[o[i + 1]] * s[o[i + 1]];
+  }
+
+  int64_t a = num_dims - 1; // innermost input dim
+  int64_t b = o.back();     // innermost output dim
+  if (a == b) {
+    // innermost dim is kept, move contiguous rows
+    int64_t inner = s[a];
+    int64_t rows = total / inner;
+#pragma omp parallel for schedule(static, omp_schedule(rows))
+    for (int64_t r = 0; r < rows; r++) {
+      int64_t idx = r, in_off = 0;
+      for (int i = num_dims - 2; i >= 0; i--) {
+        in_off += (idx % s[o[i]]) * in_stride[o[i]];
+        idx /= s[o[i]];
+      }
+      std::memcpy(to + r * inner, from + in_off, inner * sizeof(T));
+    }
+    return;
+  }
+
+  // 2D transpose of dims (b, a) in cache-sized tiles, for every index of
+  // the other dims
+  constexpr int64_t TILE = sizeof(T) >= 8 ? 8 : 64 / sizeof(T);
+  int64_t sa = s[a], sb = s[b];
+  int64_t a_tiles = ceiling_func(sa, TILE);
+  int64_t b_tiles = ceiling_func(sb, TILE);
+  int64_t outer = total / (sa * sb);
+  int64_t jobs = outer * b_tiles * a_tiles;
+  int64_t out_stride_a = out_stride[a];
+  int64_t in_stride_b = in_stride[b];
+#pragma omp parallel for schedule(static, omp_schedule(jobs))
+  for (int64_t job = 0; job < jobs; job++) {
+    int64_t ta = job % a_tiles;
+    int64_t tb = (job / a_tiles) % b_tiles;
+    int64_t idx = job / (a_tiles * b_tiles);
+    int64_t in_off = 0, out_off = 0;
+    for (int i = num_dims - 1; i >= 0; i--) {
+      if (i == a || i == b) {
+        continue;
+      }
+      int64_t cur = idx % s[i];
+      idx /= s[i];
+      in_off += cur * in_stride[i];
+      out_off += cur * out_stride[i];
+    }
+    int64_t a_begin = ta * TILE, a_end = std::min(a_begin + TILE, sa);
+    int64_t b_begin = tb * TILE, b_end = std::min(b_begin + TILE, sb);
+    for (int64_t ia = a_begin; ia < a_end; ia++) {
+      const T *src = from + in_off + ia;
+      T *dst = to + out_off + ia * out_stride_a;
+#pragma omp simd
+      for (int64_t ib = b_begin; ib < b_end; ib++) {
+        dst[ib] = src[ib * in_stride_b];
       }
     }
   }
-  // clang-format off
 }
 
-template
-void function_permute(float *from, float *to, const std::vector<int64_t> &shape_5,
-                      const std::vector<int64_t> &order_5);
+// permute any rank; only the element size matters, so all types share the
+// 1/2/4/8 bytes kernels
+template <typename T>
+void function_permute(T *from, T *to, const std::vector<int64_t> &shape,
+                      const std::vector<int64_t> &order) {
+  assert(shape.size() == order.size());
+  switch (sizeof(T)) {
+  case 1:
+    permute_impl((const uint8_t *)from, (uint8_t *)to, shape, order);
+    break;
+  case 2:
+    permute_impl((const uint16_t *)from, (uint16_t *)to, shape, order);
+    break;
+  case 4:
+    permute_impl((const uint32_t *)from, (uint32_t *)to, shape, order);
+    break;
+  case 8:
+    permute_impl((const uint64_t *)from, (uint64_t *)to, shape, order);
+    break;
+  default:
+    llvm_unreachable("unsupported permute element size");
+  }
+}
+
+template void function_permute(float *from, float *to,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &order);
+template void function_permute(int8_t *from, int8_t *to,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &order);
+template void function_permute(uint8_t *from, uint8_t *to,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &order);
+template void function_permute(uint16_t *from, uint16_t *to,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &order);
+template void function_permute(int32_t *from, int32_t *to,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &order);
 
 bool compare(float a, float b, llvm::StringRef mode) {
   if (mode == "Equal") {
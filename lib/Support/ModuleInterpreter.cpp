@@ -10,19 +10,25 @@
 #include "tpu_mlir/Support/ModuleInterpreter.h"
 #include "tpu_mlir/Dialect/Top/IR/TopOps.h"
 #include "tpu_mlir/Dialect/Tpu/IR/TpuOps.h"
+#include "tpu_mlir/Support/Dnnl/DnnlUtils.h"
 #include "tpu_mlir/Support/MathUtils.h"
 #include "tpu_mlir/Support/Module.h"
 #include <llvm/Support/Debug.h>
+#include "omp.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <numeric>
 
 #define DEBUG_TYPE "interpreter"
 
 namespace tpu_mlir {
-ModuleInterpreter::ModuleInterpreter(ModuleOp module) : module(module) {
+ModuleInterpreter::ModuleInterpreter(ModuleOp module)
+    : module(module), mem_mode(mem_mode_t::ALL_TENSOR_IN_MEM),
+      inter_op_threads(1) {
   module::init(module);
   if (!module::isState(module::State::TOP_F32) &&
       !module::isState(module::State::TPU_LOWERED)) {
@@ -41,14 +47,28 @@ ModuleInterpreter::~ModuleInterpreter() {
   }
 }
 
-void ModuleInterpreter::allocate_resources() {
+void ModuleInterpreter::allocate_resources(mem_mode_t mode,
+                                           const std::vector<std::string> &pinned) {
   all_tensor_names.clear();
   value_map.clear();
   mem_map.clear();
+  arena_map.clear();
+  arena.clear();
+  mem_mode = mode;
+  // activation name => element count, for tensors that go into arena
+  std::map<std::string, int64_t> counts;
+  // top-level op => position in its block, tensors live in
+  // [def step, last use step]; ops nested in regions take the step of
+  // their top-level parent
+  llvm::DenseMap<Operation *, int64_t> op_step;
+  int64_t step = 0;
   for (auto func : module.getOps<FuncOp>()) {
     // if (func.getName() != "main") {
     //   continue;
     // }
+    for (auto &op : func.getBody().front()) {
+      op_step[&op] = step++;
+    }
     // alloce buffer for all value
     func.walk([&](Operation *op) {
       if (op == func.getOperation() || isa<top::NoneOp>(op)) {
@@ -71,7 +91,11 @@ void ModuleInterpreter::allocate_resources() {
             mem_map[name] = wOp.read_as_float();
             all_weight_names.push_back(name);
           } else {
-            mem_map[name] = std::make_shared<std::vector<float>>(count);
+            if (mode == mem_mode_t::ALL_TENSOR_IN_MEM || isa<top::InputOp>(op)) {
+              mem_map[name] = std::make_shared<std::vector<float>>(count);
+            } else {
+              counts[name] = count;
+            }
             all_tensor_names.push_back(name);
           }
           if (isa<top::InputOp>(op)) {
@@ -87,18 +111,60 @@ void ModuleInterpreter::allocate_resources() {
         all_tensor_names.push_back(name);
       }
     }
+  }
+
+  if (mode == mem_mode_t::PLANNED_ARENA) {
+    // outputs and requested tensors keep their own buffer
+    std::vector<std::string> keep(output_names);
+    keep.insert(keep.end(), pinned.begin(), pinned.end());
+    for (auto &name : keep) {
+      auto it = counts.find(name);
+      if (it != counts.end()) {
+        mem_map[name] = std::make_shared<std::vector<float>>(it->second);
+        counts.erase(it);
+      }
+    }
+    auto step_of = [&](Operation *op) -> int64_t {
+      for (; op != nullptr; op = op->getParentOp()) {
+        auto iter = op_step.find(op);
+        if (iter != op_step.end()) {
+          return iter->second;
+        }
+      }
+      return -1;
+    };
+    std::map<std::string, std::pair<int64_t, int64_t>> live_range;
+    for (auto &it : counts) {
+      auto v = value_map.at(it.first);
+      auto start = step_of(v.getDefiningOp());
+      auto end = start;
+      for (auto user : v.getUsers()) {
+        auto user_step = step_of(user);
+        if (user_step < 0) {
+          // used out of the functions, keep it alive to the end
+          end = step;
+          break;
+        }
+        end = std::max(end, user_step);
+      }
+      live_range[it.first] = {start, end};
+    }
+    plan_arena(counts, live_range);
+  }
 
+  for (auto func : module.getOps<FuncOp>()) {
     // input output buffers for all ops
     func.walk([&](Operation *op) {
       if (auto infer_op = llvm::dyn_cast<InferenceInterface>(op)) {
         auto name = module::getName(op).str();
         auto param = std::make_shared<InferenceParameter>();
+        int64_t count;
         for (auto result : op->getResults()) {
           if (result.getType().isa<NoneType>()) {
             param->outputs.push_back(nullptr);
           } else {
             auto o_name = module::getName(result).str();
-            param->outputs.push_back(mem_map[o_name]->data());
+            param->outputs.push_back(getTensorPtr(o_name, count));
           }
         }
         for (auto input : op->getOperands()) {
@@ -107,11 +173,12 @@ void ModuleInterpreter::allocate_resources() {
             continue;
           }
           auto input_name = module::getName(input).str();
-          if (mem_map.find(input_name) == mem_map.end()) {
+          if (mem_map.find(input_name) == mem_map.end() &&
+              arena_map.find(input_name) == arena_map.end()) {
             input.dump();
             llvm_unreachable("input operands not allocated");
           } else {
-            param->inputs.push_back(mem_map[input_name]->data());
+            param->inputs.push_back(getTensorPtr(input_name, count));
           }
         }
         LLVM_DEBUG(llvm::dbgs() << "init: '" << name << "'\n");
@@ -123,6 +190,86 @@ void ModuleInterpreter::allocate_resources() {
       }
     });
   }
+  int64_t cache_hit, cache_miss;
+  dnnl_cache_stat(cache_hit, cache_miss);
+  LLVM_DEBUG(llvm::dbgs() << "dnnl primitive cache: " << cache_hit
+                          << " hits, " << cache_miss << " misses\n");
+}
+
+void ModuleInterpreter::plan_arena(
+    const std::map<std::string, int64_t> &counts,
+    const std::map<std::string, std::pair<int64_t, int64_t>> &live_range) {
+  // keep every tensor 64 bytes aligned in arena
+  const int64_t align = 16;
+  struct TensorAddr {
+    std::string name;
+    int64_t size;
+    int64_t start_step;
+    int64_t end_step;
+    int64_t offset;
+  };
+  std::vector<TensorAddr> tensors;
+  for (auto &it : counts) {
+    auto &range = live_range.at(it.first);
+    tensors.push_back(
+        {it.first, align_up(it.second, align), range.first, range.second, 0});
+  }
+  // same policy as OpSizeOrderAssign of GmemAllocator: place larger tensors
+  // first, each in the smallest gap left by tensors alive at the same time
+  std::stable_sort(tensors.begin(), tensors.end(),
+                   [](const TensorAddr &a, const TensorAddr &b) {
+                     return a.size > b.size;
+                   });
+  std::vector<TensorAddr *> allocated; // sorted by offset
+  int64_t arena_size = 0;
+  int64_t total_size = 0;
+  for (auto &t : tensors) {
+    int64_t prev_offset = 0;
+    int64_t best_offset = -1;
+    int64_t smallest_gap = std::numeric_limits<int64_t>::max();
+    for (auto a : allocated) {
+      // live ranges are inclusive: an op input can't share with its output
+      if (std::max(t.start_step, a->start_step) >
+          std::min(t.end_step, a->end_step)) {
+        continue;
+      }
+      int64_t gap = a->offset - prev_offset;
+      if (gap >= t.size && gap < smallest_gap) {
+        smallest_gap = gap;
+        best_offset = prev_offset;
+      }
+      prev_offset = std::max(prev_offset, a->offset + a->size);
+    }
+    t.offset = best_offset == -1 ? prev_offset : best_offset;
+    auto iter = std::find_if(allocated.begin(), allocated.end(),
+                             [&t](TensorAddr *a) { return a->offset >= t.offset; });
+    allocated.insert(iter, &t);
+    arena_size = std::max(arena_size, t.offset + t.size);
+    total_size += t.size;
+  }
+  arena.resize(arena_size);
+  for (auto &t : tensors) {
+    arena_map[t.name] = {t.offset, counts.at(t.name)};
+  }
+  LLVM_DEBUG(llvm::dbgs() << "arena: " << arena_size * sizeof(float) << "/"
+                          << total_size * sizeof(float) << " bytes for "
+                          << tensors.size() << " tensors\n");
+}
+
+float *ModuleInterpreter::getTensorPtr(const std::string &name,
+                                       int64_t &count) {
+  auto it = mem_map.find(name);
+  if (it != mem_map.end()) {
+    count = it->second->size();
+    return it->second->data();
+  }
+  auto iter = arena_map.find(name);
+  if (iter == arena_map.end()) {
+    count = 0;
+    return nullptr;
+  }
+  count = iter->second.second;
+  return arena.data() + iter->second.first;
 }
 
 void ModuleInterpreter::fake_quant_weight() {
@@ -156,9 +303,77 @@ void ModuleInterpreter::fake_quant_weight() {
   }
 }
 
+void ModuleInterpreter::set_inter_op_threads(int num) {
+  inter_op_threads = std::max(num, 1);
+  if (inter_op_threads == 1) {
+    pool.reset();
+  } else {
+    pool = std::make_unique<llvm::ThreadPool>(
+        llvm::hardware_concurrency(inter_op_threads));
+  }
+}
+
+void ModuleInterpreter::invoke_parallel(FuncOp func) {
+  std::vector<Operation *> ops;
+  std::vector<InferenceParameter *> params;
+  llvm::DenseMap<Operation *, int> op_idx;
+  func.walk([&](InferenceInterface infer_op) {
+    auto op = infer_op.getOperation();
+    op_idx[op] = ops.size();
+    ops.push_back(op);
+    params.push_back(inference_map.at(module::getName(op).str()).get());
+  });
+  int num_ops = ops.size();
+  // users of each op, and how many producers each op still waits for
+  std::vector<std::vector<int>> users(num_ops);
+  std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[num_ops]);
+  for (int i = 0; i < num_ops; i++) {
+    std::set<int> producers;
+    for (auto v : ops[i]->getOperands()) {
+      auto iter = op_idx.find(v.getDefiningOp());
+      if (iter != op_idx.end()) {
+        producers.insert(iter->second);
+      }
+    }
+    pending[i] = producers.size();
+    for (auto p : producers) {
+      users[p].push_back(i);
+    }
+  }
+  int intra_op_threads = std::max(omp_get_max_threads() / inter_op_threads, 1);
+  std::function<void(int)> run = [&](int i) {
+    omp_set_num_threads(intra_op_threads);
+    auto infer_op = cast<InferenceInterface>(ops[i]);
+    LLVM_DEBUG(llvm::dbgs() << "compute: '" << module::getName(ops[i])
+                            << "'\n");
+    if (failed(infer_op.inference(*params[i]))) {
+      infer_op.dump();
+      llvm_unreachable("invoke failed!!");
+    }
+    update_stat(ops[i]);
+    for (auto u : users[i]) {
+      if (--pending[u] == 0) {
+        pool->async(run, u);
+      }
+    }
+  };
+  for (int i = 0; i < num_ops; i++) {
+    if (pending[i] == 0) {
+      pool->async(run, i);
+    }
+  }
+  pool->wait();
+}
+
 void ModuleInterpreter::invoke(bool express_type) {
   module::init(module);
+  // arena offsets are reused in walk order, so planned mode stays serial
+  bool parallel = pool && mem_mode == mem_mode_t::ALL_TENSOR_IN_MEM;
   for (auto func : module.getOps<FuncOp>()) {
+    if (parallel) {
+      invoke_parallel(func);
+      continue;
+    }
     func.walk([&](InferenceInterface infer_op) {
       auto name = module::getName(infer_op.getOperation()).str();
       LLVM_DEBUG(llvm::dbgs() << "compute: '" << name << "'\n");
@@ -166,11 +381,17 @@ void ModuleInterpreter::invoke(bool express_type) {
         infer_op.dump();
         llvm_unreachable("invoke failed!!");
       }
+      update_stat(infer_op.getOperation());
     });
   }
   if (express_type && module::isState(module::State::TPU_LOWERED)) {
     for (auto &name : all_tensor_names) {
-      auto mem = mem_map.at(name);
+      // arena tensors are overwritten during invoke, nothing to express
+      auto it = mem_map.find(name);
+      if (it == mem_map.end()) {
+        continue;
+      }
+      auto mem = it->second;
       auto value = value_map.at(name);
       if (module::isUniformQuantized(value)) {
         auto qtype = module::getUniformQuantizedType(value);
@@ -182,9 +403,97 @@ void ModuleInterpreter::invoke(bool express_type) {
   }
 }
 
+void ModuleInterpreter::calib_stat_start(int bin_num) {
+  assert(bin_num > 1);
+  stat_map.clear();
+  for (auto &name : all_tensor_names) {
+    stat_map[name].hist.assign(bin_num, 0);
+  }
+  // same bins as np.histogram(k, bins=bin_num, range=(0, bin_num - 1))
+  stat_bin_of.resize(bin_num);
+  for (int k = 0; k < bin_num; k++) {
+    stat_bin_of[k] = k == bin_num - 1 ? k : k * bin_num / (bin_num - 1);
+  }
+  stat_stage = stat_stage_t::MINMAX;
+}
+
+void ModuleInterpreter::calib_stat_histogram() {
+  assert(stat_stage != stat_stage_t::NONE);
+  int bin_num = stat_bin_of.size();
+  for (auto &it : stat_map) {
+    it.second.width = it.second.abs_max / (bin_num - 1);
+  }
+  stat_stage = stat_stage_t::HISTOGRAM;
+}
+
+void ModuleInterpreter::calib_stat_stop() { stat_stage = stat_stage_t::NONE; }
+
+void ModuleInterpreter::update_stat(Operation *op) {
+  if (stat_stage == stat_stage_t::NONE) {
+    return;
+  }
+  for (auto result : op->getResults()) {
+    if (result.getType().isa<NoneType>()) {
+      continue;
+    }
+    auto iter = stat_map.find(module::getName(result).str());
+    if (iter == stat_map.end()) {
+      continue;
+    }
+    auto &stat = iter->second;
+    int64_t count;
+    auto data = getTensorPtr(iter->first, count);
+    if (stat_stage == stat_stage_t::MINMAX) {
+      float min_v = stat.min, max_v = stat.max;
+#pragma omp parallel for schedule(static, omp_schedule(count))               \
+    reduction(min : min_v) reduction(max : max_v)
+      for (int64_t i = 0; i < count; i++) {
+        min_v = std::min(min_v, data[i]);
+        max_v = std::max(max_v, data[i]);
+      }
+      stat.min = min_v;
+      stat.max = max_v;
+      stat.abs_max = std::max(std::abs(min_v), std::abs(max_v));
+      continue;
+    }
+    if (stat.width == 0.0f) {
+      continue;
+    }
+    int bin_num = stat.hist.size();
+    float width = stat.width;
+#pragma omp parallel
+    {
+      std::vector<int64_t> local(bin_num, 0);
+#pragma omp for schedule(static)
+      for (int64_t i = 0; i < count; i++) {
+        float t = std::abs(data[i]);
+        if (t == 0.0f) {
+          continue;
+        }
+        float k = std::floor(t / width + 0.5f);
+        // out of range, as np.histogram drops them
+        if (!(k <= bin_num - 1)) {
+          continue;
+        }
+        local[stat_bin_of[(int)k]]++;
+      }
+#pragma omp critical
+      for (int j = 0; j < bin_num; j++) {
+        stat.hist[j] += local[j];
+      }
+    }
+  }
+}
+
 std::shared_ptr<std::vector<float>>
 ModuleInterpreter::invoke_at(const std::string op_name) {
   module::init(module);
+  if (mem_mode == mem_mode_t::PLANNED_ARENA) {
+    // inputs in arena may be overwritten since the last invoke
+    llvm::errs() << "invoke_at " << op_name
+                 << " needs all tensors in memory, not a planned arena\n";
+    llvm_unreachable("invoke_at mem mode error");
+  }
   if (value_map.find(op_name) == value_map.end()) {
     llvm::errs() << "Can't find op:" << op_name << "\n";
     llvm_unreachable("invoke_at op_name error");
@@ -201,12 +510,19 @@ ModuleInterpreter::invoke_at(const std::string op_name) {
     infer_op.dump();
     llvm_unreachable("infer_op.inference failed!!");
   }
+  update_stat(op);
 
   return getTensor(op_name);
 }
 
 void ModuleInterpreter::invoke_from(const std::string op_name) {
   module::init(module);
+  if (mem_mode == mem_mode_t::PLANNED_ARENA) {
+    // tensors produced before op_name are not kept alive in arena
+    llvm::errs() << "invoke_from " << op_name
+                 << " needs all tensors in memory, not a planned arena\n";
+    llvm_unreachable("invoke_from mem mode error");
+  }
   bool start_run = false;
   for (auto func : module.getOps<FuncOp>()) {
     func.walk([&](InferenceInterface infer_op) {
@@ -215,25 +531,29 @@ void ModuleInterpreter::invoke_from(const std::string op_name) {
         start_run = true;
       }
       LLVM_DEBUG(llvm::dbgs() << "invoke: '" << name << "'\n");
-      if (start_run && failed(infer_op.inference(*inference_map[name]))) {
+      if (!start_run) {
+        return;
+      }
+      if (failed(infer_op.inference(*inference_map[name]))) {
         infer_op.dump();
         llvm_unreachable("invoke failed!!");
       }
+      update_stat(infer_op.getOperation());
     });
   }
 }
 void ModuleInterpreter::setTensor(const std::string &name, const void *data,
                                   size_t size, bool is_integer) {
   module::init(module);
-  auto it = mem_map.find(name);
-  if (it == mem_map.end()) {
+  int64_t count;
+  auto act = getTensorPtr(name, count);
+  if (act == nullptr) {
     llvm::errs() << "Can't find op name: " << name << "\n";
     llvm_unreachable("Error, setTensor failed");
   }
-  auto act = it->second;
-  if (act->size() * sizeof(float) != size) {
+  if (count * sizeof(float) != size) {
     llvm::errs() << "Tensor " << name
-                 << " data need size: " << act->size() * sizeof(float)
+                 << " data need size: " << count * sizeof(float)
                  << " , but set size: " << size << "\n";
     llvm_unreachable("Error, setTensor failed");
   }
@@ -241,20 +561,21 @@ void ModuleInterpreter::setTensor(const std::string &name, const void *data,
   if (is_integer == false && module::isUniformQuantized(value)) {
     auto qtype = module::getUniformQuantizedType(value);
     float *p = (float *)data;
-    for (uint32_t i = 0; i < act->size(); i++) {
+    for (int64_t i = 0; i < count; i++) {
       float d =
           p[i] * (float)(1 / qtype.getScale()) + (float)qtype.getZeroPoint();
-      act->at(i) = qtype.isSigned() ? to_int8(d) : to_uint8(d);
+      act[i] = qtype.isSigned() ? to_int8(d) : to_uint8(d);
     }
   } else {
-    memcpy(act->data(), data, size);
+    memcpy(act, data, size);
   }
 }
 
 std::shared_ptr<std::vector<float>>
 ModuleInterpreter::getTensor(const std::string &name, bool express_type) {
-  auto it = mem_map.find(name);
-  if (it == mem_map.end()) {
+  int64_t count;
+  auto act = getTensorPtr(name, count);
+  if (act == nullptr) {
     llvm::errs() << "Can't find op name: " << name << "\n";
     llvm_unreachable("Error, getTensor failed");
   }
@@ -262,27 +583,34 @@ ModuleInterpreter::getTensor(const std::string &name, bool express_type) {
   if (express_type && module::isState(module::State::TPU_LOWERED)) {
     auto value = value_map.at(name);
     if (module::isUniformQuantized(value)) {
-      int i = 0;
-      auto mem = mem_map.at(name);
-      auto data_fp32 = std::make_shared<std::vector<float>>(it->second->size());
+      auto data_fp32 = std::make_shared<std::vector<float>>(count);
       auto qtype = module::getUniformQuantizedType(value);
-      for (auto &data : *mem) {
-        data_fp32->data()[i++] =
-            (data - (float)qtype.getZeroPoint()) * (float)qtype.getScale();
+      for (int64_t i = 0; i < count; i++) {
+        data_fp32->data()[i] =
+            (act[i] - (float)qtype.getZeroPoint()) * (float)qtype.getScale();
       }
       return std::move(data_fp32);
     }
   }
 
+  auto it = mem_map.find(name);
+  if (it == mem_map.end()) {
+    // arena memory is reused by later ops, so return a copy
+    return std::make_shared<std::vector<float>>(act, act + count);
+  }
   std::shared_ptr<std::vector<float>> tmp(it->second);
   return std::move(tmp);
 }
 
+bool ModuleInterpreter::isTensorPinned(const std::string &name) {
+  return arena_map.find(name) == arena_map.end();
+}
+
 bool ModuleInterpreter::getTensorQuantInfo(const std::string name,
                                            std::string &dtype, float &scale,
                                            int &zp) {
-  auto it = mem_map.find(name);
-  if (it == mem_map.end()) {
+  auto it = value_map.find(name);
+  if (it == value_map.end()) {
     return false;
   }
   auto value = value_map.at(name);
@@ -8,12 +8,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "tpu_mlir/Support/TPUCompressUtil.h"
+#include "tpu_mlir/Support/MathUtils.h"
 #include "llvm/Support/raw_ostream.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace tpu_mlir {
 
 #define MAX_UNARY_FIELD_SIZE 47
 #define MAX_ORDER_K 5
+// blocks encoded by one thread into its own bitstream
+#define VLC_CHUNK_BLOCKS 1024
 
 typedef struct CompressCommandInfo CommandInfo;
 
@@ -137,17 +143,35 @@ static inline void init_stream(StreamBuffer *bs, uint8_t *buf, int buf_size, boo
     memset((uint8_t *)buf, 0, sizeof(uint8_t) * buf_size);
 }
 
-static inline void write_stream(StreamBuffer *bs, uint8_t *src, int bit_len)
+static inline void write_stream(StreamBuffer *bs, const uint8_t *src,
+                                int bit_len)
 {
-  for (int bit = 0; bit < bit_len; bit++)
+  int byte_i = bs->bit_pos >> 3;
+  int shift = bs->bit_pos & 7;
+  bs->bit_pos += bit_len;
+  for (int i = 0; bit_len > 0; i++, byte_i++, bit_len -= 8)
   {
-    int src_byte_i = bit / 8;
-    int src_bit_i = bit % 8;
-    int dest_byte_i = (bs->bit_pos + bit) / 8;
-    int dest_bit_i = (bs->bit_pos + bit) % 8;
-    bs->stream[dest_byte_i] |= (get_bit_val(src, src_byte_i, src_bit_i) << dest_bit_i);
+    int n = std::min(bit_len, 8);
+    uint8_t val = src[i] & (0xFF >> (8 - n));
+    bs->stream[byte_i] |= (uint8_t)(val << shift);
+    if (shift + n > 8)
+      bs->stream[byte_i + 1] |= (val >> (8 - shift));
   }
+}
+
+static inline void read_stream(StreamBuffer *bs, uint8_t *dst, int bit_len)
+{
+  int byte_i = bs->bit_pos >> 3;
+  int shift = bs->bit_pos & 7;
   bs->bit_pos += bit_len;
+  for (int i = 0; bit_len > 0; i++, byte_i++, bit_len -= 8)
+  {
+    int n = std::min(bit_len, 8);
+    int val = bs->stream[byte_i] >> shift;
+    if (shift + n > 8)
+      val |= bs->stream[byte_i + 1] << (8 - shift);
+    dst[i] = val & (0xFF >> (8 - n));
+  }
 }
 
 static inline void move_stream_ptr(StreamBuffer *bs, int bit_len)
@@ -168,6 +192,20 @@ static inline void vlc_enc_header(StreamBuffer *bs_header, CommandInfo *cmd_info
   write_stream(bs_header, (uint8_t *)&cmd_info->zero_guard_en, 1); // bit[47] zero guard
 }
 
+static inline void vlc_dec_header(StreamBuffer *bs_header, CommandInfo *cmd_info, size_t *blk_bs_size)
+{
+  uint8_t size[sizeof(size_t)] = {0};
+  read_stream(bs_header, size, 24);                               // bit[23:0] compressed block stream size
+  *blk_bs_size = size[0] | (size[1] << 8) | (size[2] << 16);
+  move_stream_ptr(bs_header, 4);                                  // bit[27:24] reserved
+  read_stream(bs_header, &cmd_info->signedness, 1);               // bit[28] signedness
+  read_stream(bs_header, &cmd_info->is_bfloat16, 1);              // bit[29] data type
+  move_stream_ptr(bs_header, 2);                                  // bit[31:30] bit depth
+  read_stream(bs_header, &cmd_info->bias0, 8);                    // bit[39:32] bias0 for symbol remapping
+  read_stream(bs_header, &cmd_info->bias1, 7);                    // bit[46:40] bias1 for symbol remapping
+  read_stream(bs_header, &cmd_info->zero_guard_en, 1);            // bit[47] zero guard
+}
+
 // -- symbol remmaping handler --
 static inline uint8_t center_shift(uint8_t val, uint8_t bias, uint8_t zero_guard)
 {
@@ -259,20 +297,59 @@ static inline void symbol_remapping(uint8_t *blk_in, uint8_t *blk_out, uint8_t b
   }
 }
 
-static inline int vlc_estimate_block_order(uint8_t *blk_in, bool bf16_zvc_en)
+// symbol remapping of all 256 byte values, so that blocks are remapped by
+// table lookup
+static void symbol_remapping_table(uint8_t *table, uint8_t bias0, uint8_t bias1, uint8_t signedness, uint8_t is_bf16_exp, uint8_t zero_guard)
+{
+  for (int i = 0; i < 256; i += 16)
+  {
+    uint8_t blk_in[16];
+    for (int j = 0; j < 16; j++)
+      blk_in[j] = i + j;
+    symbol_remapping(blk_in, table + i, bias0, bias1, signedness, is_bf16_exp, zero_guard);
+  }
+}
+
+static void inv_symbol_remapping_table(uint8_t *table, uint8_t bias0, uint8_t bias1, uint8_t signedness, uint8_t is_bf16_exp, uint8_t zero_guard)
+{
+  for (int i = 0; i < 256; i++)
+  {
+    if (is_bf16_exp)
+      table[i] = inv_center_shift(i, bias0, zero_guard);
+    else if (signedness)
+      table[i] = inv_two_side_circular_shift(unsign_to_sign(i), bias0, bias1);
+    else
+      table[i] = i;
+  }
+}
+
+// return the best order k of a block, -1 for uncompressed, and its size in
+// bits without the bf16 fraction
+static inline int vlc_estimate_block_order(const uint8_t *blk_in, bool bf16_zvc_en, int *blk_bits)
 {
   int best_k = 0;
   int best_bs_size = 0x7FFFFFFF;
+#if defined(__SSE2__)
+  __m128i blk = _mm_loadu_si128((const __m128i *)blk_in);
+#endif
 
   for (int k = 0; k <= (int)MAX_ORDER_K; k++)
   {
     uint8_t remain_field_size = k << 4;
+#if defined(__SSE2__)
+    // sum the 16 group indexes of order k with psadbw
+    __m128i group_idx = _mm_and_si128(_mm_srl_epi16(blk, _mm_cvtsi32_si128(k)),
+                                      _mm_set1_epi8((char)(0xFF >> k)));
+    __m128i sum = _mm_sad_epu8(group_idx, _mm_setzero_si128());
+    int unary_field_len = 16 + _mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4);
+#else
     int unary_field_len = 0;
     for (int i = 0; i < 16; i++)
     {
       uint8_t group_idx = blk_in[i] >> k;
       unary_field_len += (group_idx + 1);
     }
+#endif
     int znum_bit = (bf16_zvc_en && k > 0) ? 4 : 0;
     int blk_size = (unary_field_len <= MAX_UNARY_FIELD_SIZE)
                        ? remain_field_size + unary_field_len + znum_bit
@@ -285,6 +362,7 @@ static inline int vlc_estimate_block_order(uint8_t *blk_in, bool bf16_zvc_en)
   }
 
   best_k = (best_bs_size > 128) ? -1 : best_k;
+  *blk_bits = (best_k == -1) ? 128 : best_bs_size;
   return best_k;
 }
 
@@ -306,14 +384,23 @@ static inline uint8_t vlc_gr_enc_block_data(uint8_t *blk_in, StreamBuffer *bs, i
   int sym_end_pos_accum = -1;
 
   // bit plane encode for remain field
+#if defined(__SSE2__)
+  __m128i blk = _mm_loadu_si128((const __m128i *)blk_in);
+#endif
   for (int k = 0; k < order_k; k++)
   {
+#if defined(__SSE2__)
+    // move bit k of each symbol to its sign bit and gather them
+    int bit_plane = _mm_movemask_epi8(_mm_sll_epi16(blk, _mm_cvtsi32_si128(7 - k)));
+    uint8_t bit_plane0 = bit_plane & 0xFF, bit_plane1 = bit_plane >> 8;
+#else
     uint8_t bit_plane0 = 0, bit_plane1 = 0;
     for (int i = 0; i < 8; i++)
     {
       bit_plane0 |= (get_bit_val(blk_in, i, k) << i);
       bit_plane1 |= (get_bit_val(blk_in, i + 8, k) << i);
     }
+#endif
     remain_field[k << 1] = bit_plane0;
     remain_field[(k << 1) + 1] = bit_plane1;
   }
@@ -349,6 +436,171 @@ static inline uint8_t vlc_gr_enc_block_data(uint8_t *blk_in, StreamBuffer *bs, i
   return ulen;
 }
 
+static inline void vlc_gr_dec_block_data(StreamBuffer *bs, uint8_t k_info, uint8_t *blk_out, bool bf16_zvc_en)
+{
+  // uncompressed mode
+  if (k_info == 0xE0)
+  {
+    read_stream(bs, blk_out, 128);
+    return;
+  }
+
+  int order_k = k_info >> 5;
+  int unary_field_len = (k_info & 0x1F) + 16;
+  uint8_t remain_field[16] = {0};
+  uint8_t unary_field[8] = {0};
+
+  // bit plane decode for remain field
+  read_stream(bs, remain_field, order_k << 4);
+  memset(blk_out, 0, sizeof(uint8_t) * 16);
+  for (int k = 0; k < order_k; k++)
+  {
+    for (int i = 0; i < 8; i++)
+    {
+      blk_out[i] |= get_bit_val(remain_field, k << 1, i) << k;
+      blk_out[i + 8] |= get_bit_val(remain_field, (k << 1) + 1, i) << k;
+    }
+  }
+
+  if (bf16_zvc_en && order_k > 0)
+  {
+    move_stream_ptr(bs, 4);
+  }
+
+  // unary decode for unary field
+  read_stream(bs, unary_field, unary_field_len);
+  int group_idx = 0, sym_idx = 0;
+  for (int bit = 0; bit < unary_field_len; bit++)
+  {
+    if (get_bit_val(unary_field, bit / 8, bit % 8))
+    {
+      assert(sym_idx < 16);
+      blk_out[sym_idx++] |= group_idx << order_k;
+      group_idx = 0;
+    }
+    else
+    {
+      group_idx++;
+    }
+  }
+  assert(sym_idx == 16);
+}
+
+// -- load a block of int8 data, or of bf16 data dispatched to exp and frac,
+//    zero padded, and remap its symbols --
+static inline void vlc_load_block(const uint8_t *ibuf, int isz, size_t blk_idx, bool is_bf16, const uint8_t *remap,
+                                  uint8_t *blk_data, uint8_t *blk_sr_data, uint8_t *blk_data_frac)
+{
+  if (is_bf16)
+  {
+    size_t in_num = std::min<size_t>((isz >> 1) - (blk_idx << 4), 16);
+    dispatch_bf16_data((const uint16_t *)ibuf + (blk_idx << 4), blk_data, blk_data_frac, in_num);
+  }
+  else
+  {
+    size_t in_size = std::min<size_t>(isz - (blk_idx << 4), 16);
+    memcpy(blk_data, &ibuf[blk_idx << 4], sizeof(uint8_t) * in_size);
+  }
+  for (int i = 0; i < 16; i++)
+  {
+    blk_sr_data[i] = remap[blk_data[i]];
+  }
+}
+
+// -- vlc encode all blocks to kmap and data stream --
+// The order and bit size of every block are estimated first, a prefix sum
+// of the sizes gives the bit offset of each block, then chunks of blocks are
+// encoded concurrently into buffers with the same bit alignment as their
+// place in the data stream. Adjacent chunks share at most one byte, which
+// is merged at last.
+static void vlc_enc_blocks(const uint8_t *ibuf, int isz, bool is_bf16, CommandInfo *cmd_info,
+                           StreamBuffer *bs_kmap, StreamBuffer *bs_data)
+{
+  int64_t blk_num = is_bf16 ? (isz + 31) >> 5 : (isz + 15) >> 4;
+  bool zero_guard = is_bf16 && cmd_info->zero_guard_en;
+  uint8_t remap[256];
+  symbol_remapping_table(remap, cmd_info->bias0, cmd_info->bias1, is_bf16 ? 0 : cmd_info->signedness, is_bf16,
+                         zero_guard);
+
+  std::vector<int8_t> blk_order(blk_num);
+  std::vector<int64_t> blk_offset(blk_num + 1, 0);
+#pragma omp parallel for schedule(static, omp_schedule(blk_num)) if (blk_num > VLC_CHUNK_BLOCKS)
+  for (int64_t blk_idx = 0; blk_idx < blk_num; blk_idx++)
+  {
+    uint8_t blk_data[16] = {0}, blk_sr_data[16] = {0}, blk_data_frac[16] = {0};
+    vlc_load_block(ibuf, isz, blk_idx, is_bf16, remap, blk_data, blk_sr_data, blk_data_frac);
+
+    int blk_bits = 0;
+    int k = vlc_estimate_block_order(blk_sr_data, zero_guard, &blk_bits);
+    uint8_t k_info = 0xE0;
+    if (k != -1)
+    {
+      int unary_field_len = blk_bits - (k << 4) - ((zero_guard && k > 0) ? 4 : 0);
+      k_info = (k << 5) + ((unary_field_len - 16) & 0x1F);
+    }
+    bs_kmap->stream[blk_idx] = k_info;
+
+    // frac: implicit zero compression
+    if (is_bf16)
+    {
+      for (int i = 0; i < 16; i++)
+      {
+        if (!zero_guard || blk_data[i] != 0)
+          blk_bits += 8;
+      }
+    }
+    blk_order[blk_idx] = k;
+    blk_offset[blk_idx + 1] = blk_bits;
+  }
+  for (int64_t blk_idx = 0; blk_idx < blk_num; blk_idx++)
+  {
+    blk_offset[blk_idx + 1] += blk_offset[blk_idx];
+  }
+  move_stream_ptr(bs_kmap, blk_num << 3);
+
+  int64_t chunk_num = ceiling_func(blk_num, (int64_t)VLC_CHUNK_BLOCKS);
+  std::vector<uint8_t> chunk_head(chunk_num);
+#pragma omp parallel for schedule(dynamic, 1) if (blk_num > VLC_CHUNK_BLOCKS)
+  for (int64_t chunk_idx = 0; chunk_idx < chunk_num; chunk_idx++)
+  {
+    int64_t blk_begin = chunk_idx * VLC_CHUNK_BLOCKS;
+    int64_t blk_end = std::min(blk_num, blk_begin + VLC_CHUNK_BLOCKS);
+    int64_t bit_begin = blk_offset[blk_begin];
+    int64_t bit_size = (bit_begin & 7) + blk_offset[blk_end] - bit_begin;
+    std::vector<uint8_t> chunk_buf((bit_size + 7) >> 3);
+    StreamBuffer bs_chunk;
+    init_stream(&bs_chunk, chunk_buf.data(), chunk_buf.size(), false);
+    move_stream_ptr(&bs_chunk, bit_begin & 7);
+
+    for (int64_t blk_idx = blk_begin; blk_idx < blk_end; blk_idx++)
+    {
+      uint8_t blk_data[16] = {0}, blk_sr_data[16] = {0}, blk_data_frac[16] = {0};
+      vlc_load_block(ibuf, isz, blk_idx, is_bf16, remap, blk_data, blk_sr_data, blk_data_frac);
+
+      // exp or int8: BGR encode
+      vlc_gr_enc_block_data(blk_sr_data, &bs_chunk, blk_order[blk_idx], zero_guard);
+
+      // frac: implicit zero compression
+      if (is_bf16)
+      {
+        for (int i = 0; i < 16; i++)
+        {
+          if (!zero_guard || blk_data[i] != 0)
+            write_stream(&bs_chunk, &blk_data_frac[i], 8);
+        }
+      }
+    }
+    assert(bs_chunk.bit_pos == bit_size);
+    chunk_head[chunk_idx] = chunk_buf[0];
+    std::copy(chunk_buf.begin() + 1, chunk_buf.end(), bs_data->stream + (bit_begin >> 3) + 1);
+  }
+  for (int64_t chunk_idx = 0; chunk_idx < chunk_num; chunk_idx++)
+  {
+    bs_data->stream[blk_offset[chunk_idx * VLC_CHUNK_BLOCKS] >> 3] |= chunk_head[chunk_idx];
+  }
+  move_stream_ptr(bs_data, blk_offset[blk_num]);
+}
+
 // -- vlc encode int8 entry funtion --
 void compressInt8Data(
     const uint8_t *ibuf, int isz, uint8_t *obuf, int *osz,
@@ -364,20 +616,7 @@ void compressInt8Data(
   // block encode
   init_stream(&bs_kmap, bsbuf + header_size, kmap_size, false);
   init_stream(&bs_data, bsbuf + header_size + kmap_size, blk_num << 4, false);
-
-  for (size_t blk_idx = 0; blk_idx < blk_num; blk_idx++)
-  {
-    uint8_t blk_data[16] = {0}, blk_sr_data[16] = {0};
-    size_t in_size = (blk_idx == (blk_num - 1)) ? isz - (blk_idx << 4) : 16;
-    memcpy(blk_data, &ibuf[blk_idx << 4], sizeof(uint8_t) * in_size);
-
-    symbol_remapping(blk_data, blk_sr_data, cmd_info->bias0, cmd_info->bias1, cmd_info->signedness, false, false);
-
-    int k = vlc_estimate_block_order(blk_sr_data, false);
-    uint8_t ulen = vlc_gr_enc_block_data(blk_sr_data, &bs_data, k, false);
-    uint8_t k_info = (k == -1) ? 0xE0 : (k << 5) + ulen;
-    write_stream(&bs_kmap, &k_info, 8);
-  }
+  vlc_enc_blocks(ibuf, isz, false, cmd_info, &bs_kmap, &bs_data);
 
   int blk_bs_size = llvm::divideCeil(((bs_data.bit_pos + 7) >> 3), 16) << 4; // 16 byte align
   *osz = header_size + kmap_size + blk_bs_size;
@@ -395,7 +634,6 @@ void compressBf16Data(
     const uint8_t *ibuf, int isz, uint8_t *obuf, int *osz,
     CommandInfo *cmd_info)
 {
-  const uint16_t *ibuf16 = (const uint16_t *)ibuf;
   StreamBuffer bs_header, bs_kmap, bs_data;
   size_t blk_num = (isz + 31) >> 5; // 32 bytes per blok
   size_t header_size = 16;
@@ -406,40 +644,94 @@ void compressBf16Data(
   // block encode
   init_stream(&bs_kmap, bsbuf + header_size, kmap_size, false);
   init_stream(&bs_data, bsbuf + header_size + kmap_size, blk_num << 5, false);
+  vlc_enc_blocks(ibuf, isz, true, cmd_info, &bs_kmap, &bs_data);
+
+  int blk_bs_size = llvm::divideCeil(((bs_data.bit_pos + 7) >> 3), 16) << 4; // 16 byte align
+  *osz = header_size + kmap_size + blk_bs_size;
+
+  // write header
+  init_stream(&bs_header, bsbuf, header_size, false);
+  vlc_enc_header(&bs_header, cmd_info, blk_bs_size);
+
+  memcpy(obuf, bsbuf, (*osz) * sizeof(uint8_t));
+  free(bsbuf);
+}
 
+// -- vlc decode int8 entry function --
+void decompressInt8Data(
+    const uint8_t *ibuf, int isz, uint8_t *obuf, int osz,
+    CompressCommandInfo *cmd_info)
+{
+  StreamBuffer bs_header, bs_kmap, bs_data;
+  size_t blk_num = (osz + 15) >> 4;
+  size_t header_size = 16;
+  size_t kmap_size = llvm::divideCeil(blk_num, 16) << 4;
+  size_t blk_bs_size = 0;
+
+  init_stream(&bs_header, (uint8_t *)ibuf, header_size, true);
+  vlc_dec_header(&bs_header, cmd_info, &blk_bs_size);
+  assert(!cmd_info->is_bfloat16);
+  assert(header_size + kmap_size + blk_bs_size <= (size_t)isz);
+  uint8_t inv_remap[256];
+  inv_symbol_remapping_table(inv_remap, cmd_info->bias0, cmd_info->bias1, cmd_info->signedness, false, false);
+
+  init_stream(&bs_kmap, (uint8_t *)ibuf + header_size, kmap_size, true);
+  init_stream(&bs_data, (uint8_t *)ibuf + header_size + kmap_size, blk_bs_size, true);
   for (size_t blk_idx = 0; blk_idx < blk_num; blk_idx++)
   {
-    uint8_t blk_data[16] = {0}, blk_sr_data[16] = {0}, blk_data_frac[16] = {0};
-    size_t in_num = (blk_idx == (blk_num - 1)) ? ((isz >> 1) - (blk_idx << 4)) : 16;
-    dispatch_bf16_data(&ibuf16[blk_idx << 4], blk_data, blk_data_frac, in_num);
+    uint8_t blk_sr_data[16] = {0}, k_info = 0;
+    read_stream(&bs_kmap, &k_info, 8);
+    vlc_gr_dec_block_data(&bs_data, k_info, blk_sr_data, false);
+
+    size_t out_size = std::min<size_t>(osz - (blk_idx << 4), 16);
+    for (size_t i = 0; i < out_size; i++)
+    {
+      obuf[(blk_idx << 4) + i] = inv_remap[blk_sr_data[i]];
+    }
+  }
+}
+
+// -- vlc decode bfloat16 entry function --
+void decompressBf16Data(
+    const uint8_t *ibuf, int isz, uint8_t *obuf, int osz,
+    CompressCommandInfo *cmd_info)
+{
+  uint16_t *obuf16 = (uint16_t *)obuf;
+  StreamBuffer bs_header, bs_kmap, bs_data;
+  size_t blk_num = (osz + 31) >> 5; // 32 bytes per blok
+  size_t header_size = 16;
+  size_t kmap_size = llvm::divideCeil(blk_num, 16) << 4;
+  size_t blk_bs_size = 0;
 
-    // exp: BGR encode
-    symbol_remapping(blk_data, blk_sr_data, cmd_info->bias0, cmd_info->bias1, false, true, cmd_info->zero_guard_en);
+  init_stream(&bs_header, (uint8_t *)ibuf, header_size, true);
+  vlc_dec_header(&bs_header, cmd_info, &blk_bs_size);
+  assert(cmd_info->is_bfloat16);
+  assert(header_size + kmap_size + blk_bs_size <= (size_t)isz);
+  uint8_t inv_remap[256];
+  inv_symbol_remapping_table(inv_remap, cmd_info->bias0, cmd_info->bias1, false, true, cmd_info->zero_guard_en);
 
-    int k = vlc_estimate_block_order(blk_sr_data, cmd_info->zero_guard_en);
-    uint8_t ulen = vlc_gr_enc_block_data(blk_sr_data, &bs_data, k, cmd_info->zero_guard_en);
-    uint8_t k_info = (k == -1) ? 0xE0 : (k << 5) + ulen;
-    write_stream(&bs_kmap, &k_info, 8);
+  init_stream(&bs_kmap, (uint8_t *)ibuf + header_size, kmap_size, true);
+  init_stream(&bs_data, (uint8_t *)ibuf + header_size + kmap_size, blk_bs_size, true);
+  for (size_t blk_idx = 0; blk_idx < blk_num; blk_idx++)
+  {
+    uint8_t blk_sr_data[16] = {0}, k_info = 0;
+    read_stream(&bs_kmap, &k_info, 8);
+    vlc_gr_dec_block_data(&bs_data, k_info, blk_sr_data, cmd_info->zero_guard_en);
 
-    // frac: implicit zero compression
+    size_t out_num = std::min<size_t>((osz >> 1) - (blk_idx << 4), 16);
     for (size_t i = 0; i < 16; i++)
     {
-      if (!cmd_info->zero_guard_en || blk_data[i] != 0)
+      uint8_t exp = inv_remap[blk_sr_data[i]], frac = 0;
+      if (!cmd_info->zero_guard_en || exp != 0)
       {
-        write_stream(&bs_data, &blk_data_frac[i], 8);
+        read_stream(&bs_data, &frac, 8);
+      }
+      if (i < out_num)
+      {
+        obuf16[(blk_idx << 4) + i] = ((frac >> 7) << 15) | (exp << 7) | (frac & 0x7F);
       }
     }
   }
-
-  int blk_bs_size = llvm::divideCeil(((bs_data.bit_pos + 7) >> 3), 16) << 4; // 16 byte align
-  *osz = header_size + kmap_size + blk_bs_size;
-
-  // write header
-  init_stream(&bs_header, bsbuf, header_size, false);
-  vlc_enc_header(&bs_header, cmd_info, blk_bs_size);
-
-  memcpy(obuf, bsbuf, (*osz) * sizeof(uint8_t));
-  free(bsbuf);
 }
 
 // dataType: 0: 8bit, 1: 16bit
@@ -53,6 +53,22 @@ class BaseKldCalibrator:
                                                      c_float(width), c_longlong(bin_num))
         return threshold
 
+    def find_threshold(self, histogram_data_map, histogram_width_map):
+        # all histograms are searched in one call, in parallel
+        names = list(histogram_data_map.keys())
+        if len(names) == 0:
+            return {}
+        hists = np.ascontiguousarray(
+            np.stack([histogram_data_map[n] for n in names]).astype(np.int32))
+        widths = np.array([histogram_width_map[n] for n in names], dtype=np.float32)
+        thresholds = np.zeros(len(names), dtype=np.float32)
+        self.calib_lib.kl_diversity_hist_batch(hists.ctypes.data_as(POINTER(c_int)),
+                                               widths.ctypes.data_as(POINTER(c_float)),
+                                               c_longlong(len(names)),
+                                               c_longlong(self.histogram_bin_num),
+                                               thresholds.ctypes.data_as(POINTER(c_float)))
+        return {n: float(t) for n, t in zip(names, thresholds)}
+
 
 class CalibrationTable:
 
@@ -674,19 +690,45 @@ class ActivationCalibrator2(BaseKldCalibrator):
                     if count > 0:
                         self.ref_activations[i][output] = [self.module.get_tensor(output), count]
 
-    def find_threshold(self, histogram_data_map, histogram_width_map):
-        thresholds = {}
-        num = len(histogram_data_map)
-        pbar = tqdm(range(num), total=num, position=0, leave=True)
-        for item in histogram_data_map:
-            pbar.set_description("[{}] threshold: {}".format(self.histogram_bin_num, item))
-            pbar.update(1)
-            thresholds[item] = self.kld_threshold(histogram_data_map[item],
-                                                  histogram_width_map[item], self.histogram_bin_num)
-        pbar.close()
-        return thresholds
+    def thresholds_from_histogram(self, histogram_data_map, histogram_width_map):
+        thresholds_map = self.find_threshold(histogram_data_map, histogram_width_map)
+        thresholds_map['abs_max'] = {}
+        for k, v in self.activations_statistics.items():
+            _, _, abs_val = v
+            thresholds_map['abs_max'][k] = abs_val
+            if thresholds_map[k] > abs_val:
+                thresholds_map[k] = abs_val
+        return thresholds_map
+
+    def activation_collect_in_interpreter(self):
+        # min/max and histograms are updated by the interpreter right after
+        # each op, only the final tables come back to python
+        def invoke_all():
+            for idx in range(self.args.input_num):
+                for name in self.module.input_names:
+                    self.module.set_tensor(name, self.ref_activations[idx][name][0])
+                self.module.invoke()
+
+        self.module.calib_stat_start(self.histogram_bin_num)
+        invoke_all()
+        self.module.calib_stat_histogram()
+        invoke_all()
+        self.module.calib_stat_stop()
+        stats = self.module.get_calib_stat()
+        histogram_data_map = {}
+        histogram_width_map = {}
+        self.activations_statistics = {}
+        for op_name in self.parser.get_op_name_list():
+            min_value, max_value, abs_value, width, hist = stats[op_name]
+            self.activations_statistics[op_name] = (min_value, max_value, abs_value)
+            histogram_data_map[op_name] = hist
+            histogram_width_map[op_name] = width
+        return self.thresholds_from_histogram(histogram_data_map, histogram_width_map)
 
     def activation_collect_and_calc_th(self):
+        if 'use_torch_observer_for_cali' not in self.debug_cmd and \
+           'use_percetile9999' not in self.debug_cmd:
+            return self.activation_collect_in_interpreter()
         histogram_data_map = {}
         histogram_width_map = {}
         self.activations_statistics = {}
@@ -741,13 +783,8 @@ class ActivationCalibrator2(BaseKldCalibrator):
 
         thresholds_map = {}
         if 'use_torch_observer_for_cali' not in self.debug_cmd:
-            thresholds_map = self.find_threshold(histogram_data_map, histogram_width_map)
-            thresholds_map['abs_max'] = {}
-            for k, v in self.activations_statistics.items():
-                _, _, abs_val = v
-                thresholds_map['abs_max'][k] = abs_val
-                if thresholds_map[k] > abs_val:
-                    thresholds_map[k] = abs_val
+            thresholds_map = self.thresholds_from_histogram(histogram_data_map,
+                                                            histogram_width_map)
         return thresholds_map
 
     def run(self):
@@ -977,18 +1014,6 @@ class ActivationCalibrator(BaseKldCalibrator):
         show_mem_info('mem info after find_threshold')
         return thresholds_map
 
-    def find_threshold(self, histogram_data_map, histogram_width_map):
-        thresholds = {}
-        num = len(histogram_data_map)
-        pbar = tqdm(range(num), total=num, position=0, leave=True)
-        for item in histogram_data_map:
-            pbar.set_description("[{}] threshold: {}".format(self.histogram_bin_num, item))
-            pbar.update(1)
-            thresholds[item] = self.kld_threshold(histogram_data_map[item],
-                                                  histogram_width_map[item], self.histogram_bin_num)
-        pbar.close()
-        return thresholds
-
     def run(self):
         layer_name_list = []
         thresholds_map_list = []
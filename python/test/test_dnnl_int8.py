@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+#
+# TPU-MLIR is licensed under the 2-Clause BSD License except for the
+# third-party components.
+#
+# ==============================================================================
+
+# Int8 Conv/MatMul in the interpreter run on the oneDNN s8/u8 primitives when
+# the cpu has VNNI, and on the f32 primitive otherwise. Each case here is run
+# through both paths and the outputs must be the same. Without VNNI both runs
+# take the f32 path, so the cases are skipped.
+
+import numpy as np
+import onnx
+from onnx import helper
+from onnx import TensorProto
+from test_onnx import ONNX_IR_TESTER
+from utils.mlir_shell import mlir_lowering
+import argparse
+import os
+import subprocess
+
+# oneDNN capped below VNNI makes getDnnlInt8Type() pick the f32 primitive
+F32_PATH_ENV = {"ONEDNN_MAX_CPU_ISA": "AVX2"}
+
+
+def cpu_has_vnni():
+    with open("/proc/cpuinfo") as f:
+        flags = f.read().split()
+    return "avx512_vnni" in flags or "avx_vnni" in flags
+
+
+class DNNL_INT8_TESTER(object):
+
+    def __init__(self):
+        self.test_function = {
+            "Conv1d": self.test_Conv1d,
+            "Conv2d": self.test_Conv2d,
+            "Conv3d": self.test_Conv3d,
+            "MatMul": self.test_MatMul,
+            "MatMulLargeK": self.test_MatMulLargeK,
+            "Conv2dAsym": self.test_Conv2dAsym,
+            "MaxPool": self.test_MaxPool,
+        }
+        self.onnx_tester = ONNX_IR_TESTER("bm1684x", "int8")
+
+    def test_single(self, case: str):
+        print("Test: {}".format(case))
+        if case in self.test_function:
+            if not cpu_has_vnni():
+                print("====== TEST {} Skipped, cpu has no VNNI ======".format(case))
+                return
+            self.test_function[case](case)
+            print("====== TEST {} Success ======".format(case))
+        else:
+            raise RuntimeError("case [{}] is not exist".format(case))
+
+    def test_all(self):
+        for case in self.test_function:
+            self.test_single(case)
+        print("====== ALL TEST Success ======")
+
+    def inference(self, tpu_mlir: str, input_npz: str, output_npz: str, env: dict):
+        run_env = dict(os.environ)
+        run_env.update(env)
+        # the cpu isa of oneDNN is fixed per process, run each path apart
+        cmd = [
+            "model_runner.py", "--input", input_npz, "--model", tpu_mlir, "--output",
+            output_npz, "--dump_all_tensors"
+        ]
+        print("[CMD]: {} {}".format(" ".join("{}={}".format(k, v) for k, v in env.items()),
+                                    " ".join(cmd)))
+        subprocess.run(cmd, env=run_env, check=True)
+        return np.load(output_npz)
+
+    def int8_and_compare(self, graph_def, input_data: dict = None, asymmetric: bool = False):
+        tester = self.onnx_tester
+        model_name = graph_def.name
+        if input_data is None:
+            input_data = tester.create_random_input(graph_def)
+        _, top_mlir_outs, input_npz, _ = tester.onnx_convert(input_data, graph_def, model_name)
+        table_name = "{}_cali_table".format(model_name)
+        tester.make_test_calibration_table(top_mlir_outs, table_name)
+        tpu_mlir = "{}_int8_{}.mlir".format(model_name, "asym" if asymmetric else "sym")
+        mlir_lowering("{}.mlir".format(model_name),
+                      tpu_mlir,
+                      mode="int8",
+                      chip="bm1684x",
+                      cali_table=table_name,
+                      asymmetric=asymmetric)
+        int8_outs = self.inference(tpu_mlir, input_npz, "{}_dnnl_int8.npz".format(model_name),
+                                   {})
+        f32_outs = self.inference(tpu_mlir, input_npz, "{}_dnnl_f32.npz".format(model_name),
+                                  F32_PATH_ENV)
+        assert (set(int8_outs.files) == set(f32_outs.files))
+        for name in int8_outs.files:
+            if not np.array_equal(int8_outs[name], f32_outs[name]):
+                diff = np.abs(int8_outs[name].astype(np.float64) -
+                              f32_outs[name].astype(np.float64))
+                raise RuntimeError("{} differs between the int8 and f32 paths, {} of {}".format(
+                    name, np.count_nonzero(diff), diff.size))
+        return tpu_mlir, int8_outs
+
+    def ConvBase(self, case_name, input_shape, filter_shape, kernel, padding, asymmetric=False):
+        oc = filter_shape[0]
+        output_shape = [input_shape[0], oc] + input_shape[2:]
+        weight_data = np.random.randn(*filter_shape).astype(np.float32)
+        bias_data = np.random.randn(oc).astype(np.float32)
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, input_shape)
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, output_shape)
+        weight = helper.make_tensor('weight', TensorProto.FLOAT, filter_shape, weight_data)
+        bias = helper.make_tensor('bias', TensorProto.FLOAT, [oc], bias_data)
+        conv_def = helper.make_node(
+            "Conv",
+            inputs=['input', 'weight', 'bias'],
+            outputs=['output'],
+            kernel_shape=kernel,
+            pads=padding,
+        )
+        graph_def = helper.make_graph([conv_def],
+                                      case_name, [input], [output],
+                                      initializer=[weight, bias])
+        input_data = None
+        if asymmetric:
+            # all positive input is quantized to u8
+            input_data = {'input': np.random.rand(*input_shape).astype(np.float32)}
+        return self.int8_and_compare(graph_def, input_data, asymmetric)
+
+    def MatMulBase(self, case_name, input_shape, right_shape, positive=False):
+        output_shape = input_shape[:-1] + right_shape[-1:]
+        if positive:
+            right_data = np.random.rand(*right_shape).astype(np.float32)
+        else:
+            right_data = np.random.randn(*right_shape).astype(np.float32)
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, input_shape)
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, output_shape)
+        right = helper.make_tensor('right', TensorProto.FLOAT, right_shape, right_data)
+        matmul_def = helper.make_node("MatMul", inputs=['input', 'right'], outputs=['output'])
+        graph_def = helper.make_graph([matmul_def],
+                                      case_name, [input], [output],
+                                      initializer=[right])
+        input_data = None
+        if positive:
+            input_data = {'input': np.random.rand(*input_shape).astype(np.float32)}
+        self.int8_and_compare(graph_def, input_data)
+
+    def test_Conv1d(self, case_name):
+        self.ConvBase(case_name, [1, 16, 100], [32, 16, 3], [3], [1, 1])
+
+    def test_Conv2d(self, case_name):
+        self.ConvBase(case_name, [1, 16, 56, 56], [64, 16, 3, 3], [3, 3], [1, 1, 1, 1])
+
+    def test_Conv3d(self, case_name):
+        self.ConvBase(case_name, [1, 16, 8, 28, 28], [32, 16, 3, 3, 3], [3, 3, 3],
+                      [1, 1, 1, 1, 1, 1])
+
+    def test_MatMul(self, case_name):
+        self.MatMulBase(case_name, [1, 64, 256], [256, 128])
+
+    def test_MatMulLargeK(self, case_name):
+        # all positive int8 around 64, the sums go beyond 2^24 where only the
+        # int8 primitive would be exact, so getDnnlInt8Type() keeps it on f32
+        self.MatMulBase(case_name, [1, 16, 8192], [8192, 32], positive=True)
+
+    def test_Conv2dAsym(self, case_name):
+        tpu_mlir, _ = self.ConvBase(case_name, [1, 16, 56, 56], [64, 16, 3, 3], [3, 3],
+                                    [1, 1, 1, 1],
+                                    asymmetric=True)
+        with open(tpu_mlir) as f:
+            if "!quant.uniform<u8" not in f.read():
+                raise RuntimeError("{} has no u8 input".format(tpu_mlir))
+
+    def test_MaxPool(self, case_name):
+        # conv gives the int8 input of the max pool
+        input_shape = [1, 16, 56, 56]
+        weight = helper.make_tensor('weight', TensorProto.FLOAT, [32, 16, 3, 3],
+                                    np.random.randn(32, 16, 3, 3).astype(np.float32))
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, input_shape)
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, [1, 32, 28, 28])
+        conv_def = helper.make_node("Conv",
+                                    inputs=['input', 'weight'],
+                                    outputs=['conv'],
+                                    kernel_shape=[3, 3],
+                                    pads=[1, 1, 1, 1])
+        pool_def = helper.make_node("MaxPool",
+                                    inputs=['conv'],
+                                    outputs=['output'],
+                                    kernel_shape=[2, 2],
+                                    strides=[2, 2])
+        graph_def = helper.make_graph([conv_def, pool_def],
+                                      case_name, [input], [output],
+                                      initializer=[weight])
+        _, outs = self.int8_and_compare(graph_def)
+        conv = [outs[k] for k in outs.files if k.endswith("_Conv")][0]
+        pool = [outs[k] for k in outs.files if k.endswith("_MaxPool")][0]
+        ref = conv.reshape(1, 32, 28, 2, 28, 2).max(axis=(3, 5))
+        if not np.array_equal(pool.reshape(ref.shape), ref):
+            raise RuntimeError("int8 max pool differs from the max of its input")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--case", default="all", type=str, help="test one case, if all, then test all cases")
+    args = parser.parse_args()
+    tester = DNNL_INT8_TESTER()
+    dir = "dnnl_int8_test"
+    os.makedirs(dir, exist_ok=True)
+    os.chdir(dir)
+    if args.case == "" or args.case.lower() == "all":
+        tester.test_all()
+    else:
+        tester.test_single(args.case)
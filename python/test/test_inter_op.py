@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+#
+# TPU-MLIR is licensed under the 2-Clause BSD License except for the
+# third-party components.
+#
+# ==============================================================================
+
+# With inter_op_threads > 1 the interpreter runs independent ops of a mlir on
+# a thread pool. Each case here has several branches that can run at the same
+# time, and all of its tensors must be the same as when ops run one by one.
+
+import numpy as np
+from onnx import helper
+from onnx import TensorProto
+from test_onnx import ONNX_IR_TESTER
+from tools.model_runner import mlir_inference
+from utils.mlir_shell import mlir_lowering
+import argparse
+import os
+
+INTER_OP_THREADS = 4
+# races show up randomly, run each parallel invoke several times
+REPEAT = 5
+
+
+class INTER_OP_TESTER(object):
+
+    def __init__(self):
+        self.test_function = {
+            "Inception": self.test_Inception,
+            "SplitBranches": self.test_SplitBranches,
+        }
+        self.onnx_tester = ONNX_IR_TESTER("bm1684x", "int8")
+
+    def test_single(self, case: str):
+        print("Test: {}".format(case))
+        if case in self.test_function:
+            self.test_function[case](case)
+            print("====== TEST {} Success ======".format(case))
+        else:
+            raise RuntimeError("case [{}] is not exist".format(case))
+
+    def test_all(self):
+        for case in self.test_function:
+            self.test_single(case)
+        print("====== ALL TEST Success ======")
+
+    def serial_and_compare(self, mlir_file: str, input_npz: str):
+        inputs = np.load(input_npz)
+        ref_outs = mlir_inference(inputs, mlir_file, True)
+        for i in range(REPEAT):
+            outs = mlir_inference(inputs, mlir_file, True, inter_op_threads=INTER_OP_THREADS)
+            assert (set(outs.keys()) == set(ref_outs.keys()))
+            for name in ref_outs:
+                if not np.array_equal(outs[name], ref_outs[name]):
+                    raise RuntimeError("{} of {} differs when ops run in parallel".format(
+                        name, mlir_file))
+        print("{}: {} tensors are the same in {} parallel runs".format(
+            mlir_file, len(ref_outs), REPEAT))
+
+    def f32_int8_and_compare(self, graph_def):
+        tester = self.onnx_tester
+        model_name = graph_def.name
+        input_data = tester.create_random_input(graph_def)
+        _, top_mlir_outs, input_npz, _ = tester.onnx_convert(input_data, graph_def, model_name)
+        top_mlir = "{}.mlir".format(model_name)
+        self.serial_and_compare(top_mlir, input_npz)
+        table_name = "{}_cali_table".format(model_name)
+        tester.make_test_calibration_table(top_mlir_outs, table_name)
+        tpu_mlir = "{}_int8_sym.mlir".format(model_name)
+        mlir_lowering(top_mlir, tpu_mlir, mode="int8", chip="bm1684x", cali_table=table_name)
+        self.serial_and_compare(tpu_mlir, input_npz)
+
+    def make_conv(self, name, input, ic, oc, kernel, weights):
+        pad = kernel // 2
+        weight = helper.make_tensor(name + '_w', TensorProto.FLOAT, [oc, ic, kernel, kernel],
+                                    np.random.randn(oc, ic, kernel, kernel).astype(np.float32))
+        bias = helper.make_tensor(name + '_b', TensorProto.FLOAT, [oc],
+                                  np.random.randn(oc).astype(np.float32))
+        weights += [weight, bias]
+        return helper.make_node("Conv",
+                                inputs=[input, name + '_w', name + '_b'],
+                                outputs=[name],
+                                kernel_shape=[kernel, kernel],
+                                pads=[pad, pad, pad, pad])
+
+    def test_Inception(self, case_name):
+        #    input
+        #  /  |   |   \
+        # 1x1 1x1 1x1 pool
+        #  |  3x3 5x5 1x1
+        #  \  |   |   /
+        #     concat
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, [1, 16, 28, 28])
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, [1, 64, 28, 28])
+        weights = []
+        nodes = [
+            self.make_conv('b0', 'input', 16, 16, 1, weights),
+            self.make_conv('b1_0', 'input', 16, 8, 1, weights),
+            self.make_conv('b1', 'b1_0', 8, 16, 3, weights),
+            self.make_conv('b2_0', 'input', 16, 8, 1, weights),
+            self.make_conv('b2', 'b2_0', 8, 16, 5, weights),
+            helper.make_node("MaxPool",
+                             inputs=['input'],
+                             outputs=['b3_0'],
+                             kernel_shape=[3, 3],
+                             pads=[1, 1, 1, 1]),
+            self.make_conv('b3', 'b3_0', 16, 16, 1, weights),
+            helper.make_node("Concat",
+                             inputs=['b0', 'b1', 'b2', 'b3'],
+                             outputs=['output'],
+                             axis=1),
+        ]
+        graph_def = helper.make_graph(nodes, case_name, [input], [output], initializer=weights)
+        self.f32_int8_and_compare(graph_def)
+
+    def test_SplitBranches(self, case_name):
+        # each slice of split goes through a different chain, then add
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, [1, 32, 16, 16])
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, [1, 8, 16, 16])
+        weights = []
+        nodes = [
+            helper.make_node("Split",
+                             inputs=['input'],
+                             outputs=['s0', 's1', 's2', 's3'],
+                             axis=1),
+            self.make_conv('c0', 's0', 8, 8, 3, weights),
+            helper.make_node("Relu", inputs=['c0'], outputs=['r0']),
+            self.make_conv('c1', 's1', 8, 8, 1, weights),
+            helper.make_node("Sigmoid", inputs=['c1'], outputs=['r1']),
+            helper.make_node("AveragePool",
+                             inputs=['s2'],
+                             outputs=['r2'],
+                             kernel_shape=[3, 3],
+                             pads=[1, 1, 1, 1]),
+            self.make_conv('c3', 's3', 8, 8, 5, weights),
+            helper.make_node("Add", inputs=['r0', 'r1'], outputs=['a0']),
+            helper.make_node("Add", inputs=['r2', 'c3'], outputs=['a1']),
+            helper.make_node("Add", inputs=['a0', 'a1'], outputs=['output']),
+        ]
+        graph_def = helper.make_graph(nodes, case_name, [input], [output], initializer=weights)
+        self.f32_int8_and_compare(graph_def)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--case", default="all", type=str, help="test one case, if all, then test all cases")
+    args = parser.parse_args()
+    tester = INTER_OP_TESTER()
+    dir = "inter_op_test"
+    os.makedirs(dir, exist_ok=True)
+    os.chdir(dir)
+    if args.case == "" or args.case.lower() == "all":
+        tester.test_all()
+    else:
+        tester.test_single(args.case)
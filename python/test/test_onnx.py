@@ -8,6 +8,7 @@
 
 from copy import deepcopy
 from re import T
+import re
 import numpy as np
 import onnx
 from onnx import helper
@@ -30,7 +31,7 @@ CV18XX_Failed_Cases = [
     "ReshapeFuse", "PadEdge", "ScatterND", "Sqrt", "Sub2", "Where", "TopK", "TorchGelu", "TorchGRU",
     "TorchLayerNorm", "TorchLogSoftmax", "Transpose2", "TorchMaskedFill", "TorchWhere", "TorchStd",
     "QDQ", "QDQConv", "PermuteFuse", "SwapDimInner", "ChannelNorm", "TorchActivation",
-    "TorchArgmax", "TorchChannelShuffle"
+    "TorchArgmax", "TorchChannelShuffle", "ConvWSplit"
 ]
 
 
@@ -63,6 +64,7 @@ class ONNX_IR_TESTER(object):
             "Conv2d": self.test_Conv2d,
             "Conv3d": self.test_Conv3d,
             "ConvStride": self.test_ConvStride,
+            "ConvWSplit": self.test_ConvWSplit,
             "ConvDw": self.test_ConvDw,
             "ConvTranspose": self.test_ConvTranspose,
             "ConvTranspose2": self.test_ConvTranspose2,  #no pad
@@ -177,6 +179,7 @@ class ONNX_IR_TESTER(object):
             "PixelNorm": self.test_PixelNorm,
             "PixelNorm2": self.test_PixelNorm2,
             "GatherToSlice": self.test_GatherToSlice,
+            "GmemReuse": self.test_GmemReuse,
             "Mul2Scale": self.test_Mul2Scale,
             "MatMulTranspose": self.test_MatMulTranspose,
             # "PadConv1d": self.test_PadConv1d,
@@ -931,6 +934,64 @@ class ONNX_IR_TESTER(object):
                                       initializer=[filter0, filter1])
         self.onnx_and_test(graph_def)
 
+    def test_ConvWSplit(self, case_name):
+        # h = 1 and w too wide for local memory, layer group has to slice w (wsecs > 1)
+        in_shape = [1, 32, 1, 65536]
+        f_shape = [32, 32, 1, 3]
+
+        f_data0 = np.random.randn(*f_shape).astype(np.float32)
+        f_data1 = np.random.randn(*f_shape).astype(np.float32)
+        input = helper.make_tensor_value_info('input', TensorProto.FLOAT, in_shape)
+        filter0 = helper.make_tensor('filter0', TensorProto.FLOAT, f_shape, f_data0)
+        filter1 = helper.make_tensor('filter1', TensorProto.FLOAT, f_shape, f_data1)
+        output = helper.make_tensor_value_info('output', TensorProto.FLOAT, in_shape)
+
+        conv0_def = helper.make_node(
+            "Conv",
+            inputs=['input', 'filter0'],
+            outputs=['x1'],
+            kernel_shape=[1, 3],
+            pads=[0, 1, 0, 1],
+            strides=[1, 1],
+            dilations=[1, 1],
+            group=1,
+        )
+        relu_def = helper.make_node(
+            "Relu",
+            inputs=['x1'],
+            outputs=['x2'],
+        )
+        conv1_def = helper.make_node(
+            "Conv",
+            inputs=['x2', 'filter1'],
+            outputs=['x3'],
+            kernel_shape=[1, 3],
+            pads=[0, 1, 0, 1],
+            strides=[1, 1],
+            dilations=[1, 1],
+            group=1,
+        )
+        add_def = helper.make_node(
+            "Add",
+            inputs=['x3', 'input'],
+            outputs=['output'],
+        )
+        graph_def = helper.make_graph([conv0_def, relu_def, conv1_def, add_def],
+                                      case_name, [input], [output],
+                                      initializer=[filter0, filter1])
+        self.onnx_and_test(graph_def)
+        # the group must be sliced along w, not along h or left ungrouped
+        for quant_mode in self.quant_modes:
+            suffixes = [""]
+            if quant_mode == "int8" or quant_mode == "int4":
+                suffixes = ["_asym" if isAsym else "_sym" for isAsym in self.support_asym]
+            for suffix in suffixes:
+                tpu_final = "{}_{}{}_final.mlir".format(case_name, quant_mode, suffix)
+                with open(tpu_final, "r") as f:
+                    w_slices = re.findall(r"w_slice = array<i64: ([^>]*)>", f.read())
+                if not any(len(w_slice.split(",")) > 1 for w_slice in w_slices):
+                    raise RuntimeError("{} has no group split along w".format(tpu_final))
+
     def test_Conv3d(self, case_name):
         oc = 32
         input_shape = [1, 16, 10, 30, 50]
@@ -2326,6 +2387,30 @@ class ONNX_IR_TESTER(object):
         x = torch.randn(1, 3, 10, 640, 640).float()
         self.torch_and_test(x, Net(), case_name)
 
+    def test_GmemReuse(self, case_name):
+        # tensors of mixed sizes with nested live ranges, so every gmem
+        # allocator method has gaps to reuse and neighbours to overlap
+        class Net(torch.nn.Module):
+
+            def __init__(self):
+                super(Net, self).__init__()
+                self.convs = nn.ModuleList(
+                    [nn.Conv2d(16, 8 * (i + 1), 3, 1, 1) for i in range(4)])
+                self.pool = nn.MaxPool2d(2, 2)
+                self.conv_out = nn.Conv2d(80, 16, 1, 1, 0)
+
+            def forward(self, x):
+                ys = []
+                y = x
+                for conv in self.convs:
+                    ys.append(conv(y))
+                    y = torch.relu(y + x)
+                z = torch.cat([self.pool(t) for t in ys], 1)
+                return self.conv_out(z) + self.pool(y)
+
+        x = torch.randn(1, 16, 128, 128).float()
+        self.torch_and_test(x, Net(), case_name)
+
     def test_GatherToSlice(self, case_name):
 
         class Net(torch.nn.Module):
@@ -79,6 +79,8 @@ class DeployTool:
         self.dynamic = args.dynamic
         self.compare_all = args.compare_all
         self.post_op = args.post_op
+        # intermediate mlir in bytecode, text only for debug
+        self.bytecode = not args.debug
         if self.quantize == "int8":
             if self.asymmetric:
                 self.prefix += "_asym"
@@ -95,7 +97,7 @@ class DeployTool:
         self.final_mlir = "{}_final.mlir".format(self.prefix)
         mlir_lowering(self.mlir_file, self.tpu_mlir, self.quantize, self.chip, self.cali_table,
                       self.asymmetric, self.quantize_table, False, self.customization_format,
-                      self.fuse_preprocess, self.aligned_input)
+                      self.fuse_preprocess, self.aligned_input, self.bytecode)
         if self.do_validate:
             tool.validate_tpu_mlir()
 
@@ -211,6 +213,7 @@ class DeployTool:
             self.quant_input,
             self.quant_output,
             self.disable_layer_group,
+            self.bytecode,
         )
         if self.do_validate:
             tool.validate_model()
@@ -275,7 +278,8 @@ if __name__ == '__main__':
                         help="Decide whether to enable layer group pass")
     parser.add_argument("--post_op", action="store_true",
                         help="if the bmodel have post handle op")
-    parser.add_argument("--debug", action='store_true', help='to keep all intermediate files for debug')
+    parser.add_argument("--debug", action='store_true',
+                        help='to keep all intermediate files for debug, and save mlir as text')
     # yapf: enable
     args = parser.parse_args()
     if args.customization_format.startswith("YUV"):
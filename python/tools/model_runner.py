@@ -173,7 +173,11 @@ def model_inference(inputs: dict, model_file: str, post_op=False) -> dict:
     return outputs
 
 
-def mlir_inference(inputs: dict, mlir_file: str, dump_all: bool = True, debug=None) -> dict:
+def mlir_inference(inputs: dict,
+                   mlir_file: str,
+                   dump_all: bool = True,
+                   debug=None,
+                   inter_op_threads: int = 1) -> dict:
 
     import pymlir
 
@@ -184,7 +188,10 @@ def mlir_inference(inputs: dict, mlir_file: str, dump_all: bool = True, debug=No
             pymlir.debug(debug.split(","))
 
     module = pymlir.module()
-    module.load(mlir_file)
+    # without dump_all only outputs are read, let activations share memory;
+    # the shared arena is planned for running ops one by one
+    module.load(mlir_file, planned=not dump_all and inter_op_threads == 1)
+    module.set_inter_op_threads(inter_op_threads)
     for name in module.input_names:
         assert (name in inputs)
         input = inputs[name]
@@ -193,12 +200,11 @@ def mlir_inference(inputs: dict, mlir_file: str, dump_all: bool = True, debug=No
         else:
             module.set_tensor(name, input.astype(np.float32))
     module.invoke()
-    tensors = module.get_all_tensor()
     if dump_all:
-        return tensors
+        return module.get_all_tensor()
     outputs = dict()
     for name in module.output_names:
-        outputs[name] = tensors[name]
+        outputs[name] = module.get_tensor(name)
     return outputs
 
 
@@ -361,12 +367,15 @@ if __name__ == '__main__':
                         help="configure the debugging information.")
     parser.add_argument("--post_op", action='store_true',
                         help="if the bmodel have post handle op")
+    parser.add_argument("--inter_op_threads", type=int, default=1,
+                        help="run up to N independent ops of mlir at the same time")
     # yapf: enable
     args = parser.parse_args()
     data = np.load(args.input)
     output = dict()
     if args.model.endswith(".mlir"):
-        output = mlir_inference(data, args.model, args.dump_all_tensors, args.debug)
+        output = mlir_inference(data, args.model, args.dump_all_tensors, args.debug,
+                                args.inter_op_threads)
     elif args.model.endswith('.onnx'):
         output = onnx_inference(data, args.model, args.dump_all_tensors)
     elif args.model.endswith(".tflite"):
@@ -30,12 +30,12 @@ class ModelTransformer(object):
     def cleanup(self):
         file_clean()
 
-    def model_transform(self, mlir_file: str, post_handle_type=""):
+    def model_transform(self, mlir_file: str, post_handle_type="", bytecode=False):
         self.mlir_file = mlir_file
         mlir_origin = mlir_file.replace('.mlir', '_origin.mlir', 1)
         file_mark(mlir_origin)
         self.converter.generate_mlir(mlir_origin)
-        mlir_opt_for_top(mlir_origin, self.mlir_file, post_handle_type)
+        mlir_opt_for_top(mlir_origin, self.mlir_file, post_handle_type, bytecode)
         print("Mlir file generated:{}".format(mlir_file))
 
         self.module_parsered = MlirParser(self.mlir_file)
@@ -207,13 +207,14 @@ if __name__ == '__main__':
     parser.add_argument("--excepts", default='-', help="excepts")
     parser.add_argument("--post_handle_type", default="", type=str,
                          help="post handle type, such as yolo,ssd etc")
-    parser.add_argument("--debug", action='store_true', help='to keep all intermediate files for debug')
+    parser.add_argument("--debug", action='store_true',
+                        help='to keep all intermediate files for debug, and save mlir as text')
     parser.add_argument("--mlir", type=str, required=True, help="output mlir model file")
     # yapf: enable
     parser = get_preprocess_parser(existed_parser=parser)
     args = parser.parse_args()
     tool = get_model_transform(args)
-    tool.model_transform(args.mlir, args.post_handle_type)
+    tool.model_transform(args.mlir, args.post_handle_type, bytecode=not args.debug)
     if args.test_input:
         assert (args.test_result)
         tool.model_validate(args.test_input, args.tolerance, args.excepts, args.test_result)
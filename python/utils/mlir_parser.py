@@ -139,7 +139,8 @@ class Operation:
 class MlirParser:
 
     def __init__(self, mlir_file):
-        with open(mlir_file, 'r') as f:
+        # read as bytes, so both text and bytecode mlir can be parsed
+        with open(mlir_file, 'rb') as f:
             context = f.read()
         self.ctx = mlir.ir.Context()
         self.ctx.allow_unregistered_dialects = True
@@ -20,7 +20,17 @@ def _os_system(cmd: list):
         raise RuntimeError("[!Error]: {}".format(cmd_str))
 
 
-def mlir_opt_for_top(mlirfile, opt_mlirfile, post_handle_type=""):
+# tpuc-opt reads text or bytecode mlir transparently; bytecode is much faster
+# to write and parse for big models, use `tpuc-opt xx.mlir -o xx_text.mlir`
+# to get the text back
+def _output_args(output: str, bytecode: bool = False):
+    args = ["-o", output]
+    if bytecode:
+        args.append("--emit-bytecode")
+    return args
+
+
+def mlir_opt_for_top(mlirfile, opt_mlirfile, post_handle_type="", bytecode: bool = False):
     if len(post_handle_type) > 0:
         cmd = [
             "tpuc-opt",
@@ -31,9 +41,7 @@ def mlir_opt_for_top(mlirfile, opt_mlirfile, post_handle_type=""):
             "--save-weight",
             "--mlir-print-debuginfo",
             mlirfile,
-            "-o",
-            opt_mlirfile,
-        ]
+        ] + _output_args(opt_mlirfile, bytecode)
     else:
         cmd = [
             "tpuc-opt",
@@ -43,9 +51,7 @@ def mlir_opt_for_top(mlirfile, opt_mlirfile, post_handle_type=""):
             "--save-weight",
             "--mlir-print-debuginfo",
             mlirfile,
-            "-o",
-            opt_mlirfile,
-        ]
+        ] + _output_args(opt_mlirfile, bytecode)
     _os_system(cmd)
 
 
@@ -59,7 +65,8 @@ def mlir_lowering(top_mlir: str,
                   qdq: bool = False,
                   customization_format: str = None,
                   fuse_preprocess: bool = False,
-                  aligned_input: bool = False):
+                  aligned_input: bool = False,
+                  bytecode: bool = False):
     cmd = ["tpuc-opt", top_mlir, "--init"]
     mode = mode.upper()
     if mode == 'QDQ':
@@ -95,9 +102,7 @@ def mlir_lowering(top_mlir: str,
         "--canonicalize",
         save_w_cmd,
         "--mlir-print-debuginfo",
-        "-o",
-        tpu_mlir,
-    ])
+    ] + _output_args(tpu_mlir, bytecode))
     _os_system(cmd)
 
 
@@ -107,7 +112,8 @@ def mlir_to_model(tpu_mlir: str,
                   dynamic: bool = False,
                   quant_input: bool = False,
                   quant_output: bool = False,
-                  disable_layer_group: bool = False):
+                  disable_layer_group: bool = False,
+                  bytecode: bool = False):
     # generate final mlir
     strip_io_quant_param = '--strip-io-quant="quant_input={} quant_output={}"'.format(
         quant_input, quant_output)
@@ -132,9 +138,7 @@ def mlir_to_model(tpu_mlir: str,
         #"--address-assign=\"reuse_addr=false\"",
         "--save-weight",
         "--mlir-print-debuginfo",
-        "-o",
-        final_mlir,
-    ]
+    ] + _output_args(final_mlir, bytecode)
 
     _os_system(cmd)
 
@@ -99,4 +99,37 @@ model_deploy.py \
   --calibration_table mobilenet_v2_cali_table \
   --fuse_preprocess \
   --model mobilenet_v2_1684x_int8_fuse2.bmodel
+
+# mlir bytecode round trip, Top and Tpu modules should print the same text
+# whether read from text or bytecode
+for mlir in mobilenet_v2 mobilenet_v2_bm1684x_int8_sym_final; do
+  tpuc-opt ${mlir}.mlir --mlir-print-debuginfo -o ${mlir}_text.mlir
+  tpuc-opt ${mlir}_text.mlir --emit-bytecode -o ${mlir}_bc.mlir
+  tpuc-opt ${mlir}_bc.mlir --mlir-print-debuginfo -o ${mlir}_bc_text.mlir
+  diff ${mlir}_text.mlir ${mlir}_bc_text.mlir
+done
+
+# layer groups searched in parallel should be the same as a serial search
+tpuc-opt mobilenet_v2_bm1684x_int8_sym_final.mlir --mlir-print-debuginfo \
+  -o mobilenet_v2_lg_parallel.mlir
+OMP_NUM_THREADS=1 model_deploy.py \
+  --mlir mobilenet_v2.mlir \
+  --quantize INT8 \
+  --chip bm1684x \
+  --calibration_table mobilenet_v2_cali_table \
+  --fuse_preprocess \
+  --model mobilenet_v2_1684x_int8_fuse_serial.bmodel
+tpuc-opt mobilenet_v2_bm1684x_int8_sym_final.mlir --mlir-print-debuginfo \
+  -o mobilenet_v2_lg_serial.mlir
+diff mobilenet_v2_lg_parallel.mlir mobilenet_v2_lg_serial.mlir
+
+# int8 conv/matmul on the oneDNN int8 and f32 primitives should agree
+test_dnnl_int8.py
+
+# independent ops run on a thread pool should give the same tensors
+test_inter_op.py
+
+# cv18xx weight compression should match the scalar reference encoder
+compress_test
+
 popd
@@ -15,6 +15,13 @@
 #include<stdint.h>
 #include<stdexcept>
 #include <regex>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <set>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define ZIP64_LIMIT  ((((size_t)1) << 31) - 1)
 
@@ -315,60 +322,22 @@ void npy_save(std::string fname, const std::vector<T> data,
     npy_save<T>(fname, &data[0], shape, mode);
 }
 
-template<typename T>
-void npz_save(std::string zipname, std::string fname,
-        const T* data, const std::vector<size_t>& shape,
-        std::string mode) {
-    //first, append a .npy to the fname
-    fname += ".npy";
-
-    //now, on with the show
-    FILE* fp = NULL;
-    uint16_t nrecs = 0;
-    size_t global_header_offset = 0;
-    std::vector<char> global_header;
-
-    if(mode == "a") fp = fopen(zipname.c_str(),"r+b");
-
-    if(fp) {
-        //zip file exists. we need to add a new npy file to it.
-        //first read the footer.
-        //this gives us the offset and size of the global header
-        //then read and store the global header.
-        //below, we will write the the new data at the start of the global
-        //header then append the global header and footer below it
-        size_t global_header_size;
-        parse_zip_footer(fp,nrecs,global_header_size,global_header_offset);
-        fseek(fp,global_header_offset,SEEK_SET);
-        global_header.resize(global_header_size);
-        size_t res = fread(&global_header[0],sizeof(char),global_header_size,fp);
-        if(res != global_header_size){
-            throw std::runtime_error("npz_save: "
-                    "header read error while adding to existing zip");
-        }
-        fseek(fp,global_header_offset,SEEK_SET);
-    }
-    else {
-        fp = fopen(zipname.c_str(),"wb");
-    }
+//build the local header of a stored entry whose data starts at offset,
+//padded so that the array data is 64 bytes aligned in the file
+static std::vector<char> create_local_header(const std::string& fname,
+        const std::vector<char>& npy_header, const void* data,
+        size_t data_bytes, size_t offset) {
+    //pad the local header with an extra field, so that array data starts
+    //64 bytes aligned in the file and npz_load_mmap can use it in place
+    size_t data_pos = offset + 30 + fname.size() + npy_header.size();
+    uint16_t pad = (64 - data_pos % 64) % 64;
+    if(pad > 0 && pad < 4) pad += 64;
 
-    size_t word_size = sizeof(T);
-    char type = map_type(typeid(T));
-    std::vector<char> npy_header;
-    if(shape.size() != 0){
-        npy_header = create_npy_header(shape, word_size, type);
-    }else{
-        std::cerr << "[Warning] zip name: " << fname <<" npz shape size is 0, skip it\n";
-        fclose(fp);
-        return;
-    }
-
-    size_t nels = std::accumulate(shape.begin(),shape.end(),1,std::multiplies<size_t>());
-    size_t nbytes = nels*sizeof(T) + npy_header.size();
+    size_t nbytes = data_bytes + npy_header.size();
 
     //get the CRC of the data to be added
     uint32_t crc = crc32(0L,(uint8_t*)&npy_header[0],npy_header.size());
-    crc = crc32(crc,(const uint8_t*)data,nels*sizeof(T));
+    crc = crc32(crc,(const uint8_t*)data,data_bytes);
 
     //build the local header
     std::vector<char> local_header;
@@ -383,17 +352,26 @@ void npz_save(std::string zipname, std::string fname,
     local_header += (uint32_t) nbytes; //compressed size
     local_header += (uint32_t) nbytes; //uncompressed size
     local_header += (uint16_t) fname.size(); //fname length
-    local_header += (uint16_t) 0; //extra field length
+    local_header += (uint16_t) pad; //extra field length
     local_header += fname;
+    if(pad > 0) {
+        local_header += (uint16_t) 0x4e50; //padding extra field id
+        local_header += (uint16_t) (pad - 4); //padding data size
+        local_header.insert(local_header.end(), pad - 4, 0);
+    }
+    return local_header;
+}
 
-    fwrite(&local_header[0],sizeof(char),local_header.size(),fp);
-    fwrite(&npy_header[0],sizeof(char),npy_header.size(),fp);
-    fwrite(data,sizeof(T),nels,fp);
+//build the central directory record of an entry written at offset
+static std::vector<char> create_central_record(
+        const std::vector<char>& local_header, const std::string& fname,
+        size_t offset, bool zip64) {
+    std::vector<char> global_header;
     /*
       Only support global_header_offset is larger than ZIP64_LIMIT.
       Not support size is larger than ZIP64_LIMIT now.
     */
-    if (global_header_offset + nbytes + local_header.size() >= ZIP64_LIMIT) {
+    if (zip64) {
       //structCentralDir = "<4s4B4HL2L5H2L"
       //centdir = struct.pack(structCentralDir,
       //stringCentralDir, create_version,
@@ -430,27 +408,32 @@ void npz_save(std::string zipname, std::string fname,
       // create_version = max(45, zinfo.create_version)
       global_header += (uint16_t) 0x01;
       global_header += (uint16_t) 0x08;
-      global_header += (uint64_t) global_header_offset;
+      global_header += (uint64_t) offset;
     } else {
       //build global header
       global_header += "PK"; //first part of sig
       global_header += (uint16_t) 0x0201; //second part of sig
       global_header += (uint16_t) 20; //version made by
       global_header.insert(global_header.end(),local_header.begin()+4,
-                           local_header.begin()+30);
+                           local_header.begin()+28);
+      global_header += (uint16_t) 0; //extra field length
       global_header += (uint16_t) 0; //file comment length
       global_header += (uint16_t) 0; //disk number where file starts
       global_header += (uint16_t) 0; //internal file attributes
       global_header += (uint32_t) 0; //external file attributes
       //relative offset of local file header
       //since it begins where the global header used to begin
-      global_header += (uint32_t) global_header_offset;
+      global_header += (uint32_t) offset;
       global_header += fname;
     }
+    return global_header;
+}
 
-    fwrite(&global_header[0],sizeof(char),global_header.size(),fp);
-
-    if (global_header_offset >= ZIP64_LIMIT) {
+//write the end of central directory records, the central directory of
+//nrecs entries has been written at cd_offset
+static void write_zip_footer(FILE* fp, uint16_t nrecs, size_t cd_size,
+        size_t cd_offset, bool zip64) {
+    if (zip64) {
       //structEndArchive64 = "<4sQ2H2L4Q"
       //zip64endrec = struct.pack(
       //        structEndArchive64, stringEndArchive64,
@@ -465,10 +448,10 @@ void npz_save(std::string zipname, std::string fname,
       zip64endrec_header += (uint16_t) 0x45;
       zip64endrec_header += (uint32_t) 0x0;
       zip64endrec_header += (uint32_t) 0x0;
-      zip64endrec_header += (uint64_t) (nrecs+1); //centDirCount
-      zip64endrec_header += (uint64_t) (nrecs+1); //centDirCount
-      zip64endrec_header += (uint64_t) global_header.size(); //centDirSize
-      zip64endrec_header += (uint64_t) global_header_offset + nbytes + local_header.size(); //centDirOffset
+      zip64endrec_header += (uint64_t) nrecs; //centDirCount
+      zip64endrec_header += (uint64_t) nrecs; //centDirCount
+      zip64endrec_header += (uint64_t) cd_size; //centDirSize
+      zip64endrec_header += (uint64_t) cd_offset; //centDirOffset
       fwrite(&zip64endrec_header[0],sizeof(char),zip64endrec_header.size(),fp);
 
       //structEndArchive64Locator = "<4sLQL"
@@ -480,7 +463,7 @@ void npz_save(std::string zipname, std::string fname,
       zip64locrec_header += "PK";
       zip64locrec_header += (uint16_t) 0x0706;
       zip64locrec_header += (uint32_t) 0x0;
-      zip64locrec_header += (uint64_t) global_header_offset + nbytes + local_header.size() +
+      zip64locrec_header += (uint64_t) cd_offset +
                              zip64endrec_header.size(); // zip64endrec_header offset
       zip64locrec_header += (uint32_t) 0x1;
       fwrite(&zip64locrec_header[0],sizeof(char),zip64locrec_header.size(),fp);
@@ -491,16 +474,84 @@ void npz_save(std::string zipname, std::string fname,
     footer += (uint16_t) 0x0605; //second part of sig
     footer += (uint16_t) 0; //number of this disk
     footer += (uint16_t) 0; //disk where footer starts
-    footer += (uint16_t) (nrecs+1); //number of records on this disk
-    footer += (uint16_t) (nrecs+1); //total number of records
-    footer += (uint32_t) global_header.size(); //nbytes of global headers
+    footer += (uint16_t) nrecs; //number of records on this disk
+    footer += (uint16_t) nrecs; //total number of records
+    footer += (uint32_t) cd_size; //nbytes of global headers
     //offset of start of global headers
-    //since global header now starts after newly written array
-    footer += (global_header_offset >= ZIP64_LIMIT) ?
-               (uint32_t) 0xFFFFFFFF : (uint32_t) (global_header_offset + nbytes + local_header.size());
+    footer += zip64 ? (uint32_t) 0xFFFFFFFF : (uint32_t) cd_offset;
     footer += (uint16_t) 0; //zip file comment length
 
     fwrite(&footer[0],sizeof(char),footer.size(),fp);
+}
+
+template<typename T>
+void npz_save(std::string zipname, std::string fname,
+        const T* data, const std::vector<size_t>& shape,
+        std::string mode) {
+    //first, append a .npy to the fname
+    fname += ".npy";
+
+    //now, on with the show
+    FILE* fp = NULL;
+    uint16_t nrecs = 0;
+    size_t global_header_offset = 0;
+    std::vector<char> global_header;
+
+    if(mode == "a") fp = fopen(zipname.c_str(),"r+b");
+
+    if(fp) {
+        //zip file exists. we need to add a new npy file to it.
+        //first read the footer.
+        //this gives us the offset and size of the global header
+        //then read and store the global header.
+        //below, we will write the the new data at the start of the global
+        //header then append the global header and footer below it
+        size_t global_header_size;
+        parse_zip_footer(fp,nrecs,global_header_size,global_header_offset);
+        fseek(fp,global_header_offset,SEEK_SET);
+        global_header.resize(global_header_size);
+        size_t res = fread(&global_header[0],sizeof(char),global_header_size,fp);
+        if(res != global_header_size){
+            throw std::runtime_error("npz_save: "
+                    "header read error while adding to existing zip");
+        }
+        fseek(fp,global_header_offset,SEEK_SET);
+    }
+    else {
+        fp = fopen(zipname.c_str(),"wb");
+    }
+
+    size_t word_size = sizeof(T);
+    char type = map_type(typeid(T));
+    std::vector<char> npy_header;
+    if(shape.size() != 0){
+        npy_header = create_npy_header(shape, word_size, type);
+    }else{
+        std::cerr << "[Warning] zip name: " << fname <<" npz shape size is 0, skip it\n";
+        fclose(fp);
+        return;
+    }
+
+    size_t nels = std::accumulate(shape.begin(),shape.end(),1,std::multiplies<size_t>());
+    size_t nbytes = nels*sizeof(T) + npy_header.size();
+
+    std::vector<char> local_header = create_local_header(fname, npy_header,
+            data, nels*sizeof(T), global_header_offset);
+
+    fwrite(&local_header[0],sizeof(char),local_header.size(),fp);
+    fwrite(&npy_header[0],sizeof(char),npy_header.size(),fp);
+    fwrite(data,sizeof(T),nels,fp);
+
+    size_t cd_offset = global_header_offset + nbytes + local_header.size();
+    std::vector<char> record = create_central_record(local_header, fname,
+            global_header_offset, cd_offset >= ZIP64_LIMIT);
+    global_header.insert(global_header.end(), record.begin(), record.end());
+
+    fwrite(&global_header[0],sizeof(char),global_header.size(),fp);
+
+    //global header now starts after newly written array
+    write_zip_footer(fp, nrecs + 1, global_header.size(), cd_offset,
+            global_header_offset >= ZIP64_LIMIT);
     fclose(fp);
 }
 
@@ -523,7 +574,9 @@ void npz_save(std::string zipname, std::string fname,
 template<typename T>
 void npz_save(std::string zipname, std::string fname,
         NpyArray &array, std::string mode) {
-    npz_save<T>(zipname, fname, array.data<T>(), array.shape, mode);
+    //read through the const view, mapped data needn't be copied
+    const NpyArray &carray = array;
+    npz_save<T>(zipname, fname, carray.data<T>(), array.shape, mode);
 }
 
 template<typename T>
@@ -636,13 +689,9 @@ static NpyArray load_the_npy_file(FILE* fp) {
     return arr;
 }
 
-static NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes,
-        uint32_t uncompr_bytes) {
-    std::vector<unsigned char> buffer_compr(compr_bytes);
+static NpyArray inflate_the_npz_array(unsigned char* compr,
+        uint32_t compr_bytes, uint32_t uncompr_bytes) {
     std::vector<unsigned char> buffer_uncompr(uncompr_bytes);
-    size_t nread = fread(&buffer_compr[0],1,compr_bytes,fp);
-    if(nread != compr_bytes)
-        throw std::runtime_error("load_the_npy_file: failed fread");
 
     int err;
     z_stream d_stream;
@@ -656,7 +705,7 @@ static NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes,
     assert(err = 0);
 
     d_stream.avail_in = compr_bytes;
-    d_stream.next_in = &buffer_compr[0];
+    d_stream.next_in = compr;
     d_stream.avail_out = uncompr_bytes;
     d_stream.next_out = &buffer_uncompr[0];
 
@@ -679,6 +728,120 @@ static NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes,
     return array;
 }
 
+static NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes,
+        uint32_t uncompr_bytes) {
+    std::vector<unsigned char> buffer_compr(compr_bytes);
+    size_t nread = fread(&buffer_compr[0],1,compr_bytes,fp);
+    if(nread != compr_bytes)
+        throw std::runtime_error("load_the_npy_file: failed fread");
+    return inflate_the_npz_array(&buffer_compr[0], compr_bytes, uncompr_bytes);
+}
+
+//an entry in the central directory of a zip file
+struct ZipRecord {
+    std::string varname;   //without the lagging .npy
+    size_t offset;         //offset of the local header
+    std::vector<char> raw; //the central directory record
+};
+
+//read all records of the central directory, return false if fp is not a
+//zip file as written by cnpy or numpy
+static bool read_central_directory(FILE* fp, std::vector<ZipRecord>& records,
+        size_t& cd_offset) {
+    fseek(fp,0,SEEK_END);
+    if(ftell(fp) < 22) return false;
+    char sig[4];
+    fseek(fp,-22,SEEK_END);
+    if(fread(sig,sizeof(char),4,fp) != 4) return false;
+    if(sig[0] != 'P' || sig[1] != 'K' || sig[2] != 0x05 || sig[3] != 0x06)
+        return false;
+
+    uint16_t nrecs;
+    size_t cd_size;
+    parse_zip_footer(fp,nrecs,cd_size,cd_offset);
+    std::vector<char> cd(cd_size);
+    fseek(fp,cd_offset,SEEK_SET);
+    if(fread(cd.data(),sizeof(char),cd_size,fp) != cd_size) return false;
+
+    size_t pos = 0;
+    for(uint16_t i = 0; i < nrecs; i++) {
+        if(pos + 46 > cd_size) return false;
+        const char* rec = &cd[pos];
+        if(*(uint32_t*) rec != 0x02014b50) return false;
+        uint32_t compr_bytes = *(uint32_t*) &rec[20];
+        uint32_t uncompr_bytes = *(uint32_t*) &rec[24];
+        uint16_t name_len = *(uint16_t*) &rec[28];
+        uint16_t extra_field_len = *(uint16_t*) &rec[30];
+        uint16_t comment_len = *(uint16_t*) &rec[32];
+        size_t offset = *(uint32_t*) &rec[42];
+        size_t rec_size = 46 + name_len + extra_field_len + comment_len;
+        if(pos + rec_size > cd_size) return false;
+        if(offset == 0xFFFFFFFF) {
+            //the offset is in the zip64 extra field, after the sizes that
+            //don't fit in 32 bits
+            const char* extra = rec + 46 + name_len;
+            size_t epos = 0;
+            while(epos + 4 <= extra_field_len) {
+                uint16_t id = *(uint16_t*) &extra[epos];
+                uint16_t len = *(uint16_t*) &extra[epos+2];
+                if(id == 0x0001) {
+                    size_t field = epos + 4;
+                    if(uncompr_bytes == 0xFFFFFFFF) field += 8;
+                    if(compr_bytes == 0xFFFFFFFF) field += 8;
+                    offset = *(uint64_t*) &extra[field];
+                    break;
+                }
+                epos += 4 + len;
+            }
+        }
+        std::string varname(rec + 46, name_len);
+        if(varname.size() >= 4) varname.erase(varname.end()-4,varname.end());
+        records.push_back({varname, offset,
+                           std::vector<char>(rec, rec + rec_size)});
+        pos += rec_size;
+    }
+    return true;
+}
+
+//read the array whose local header is at the current position of fp,
+//return false if there is no local header
+static bool load_the_npz_entry(FILE* fp, npz_t& arrays) {
+    std::vector<char> local_header(30);
+    size_t headerres = fread(&local_header[0],sizeof(char),30,fp);
+    if(headerres != 30)
+        return false;
+
+    //if we've reached the global header, stop reading
+    if(local_header[2] != 0x03 || local_header[3] != 0x04) return false;
+
+    //read in the variable name
+    uint16_t name_len = *(uint16_t*) &local_header[26];
+    std::string varname(name_len,' ');
+    size_t vname_res = fread(&varname[0],sizeof(char),name_len,fp);
+    if(vname_res != name_len)
+        throw std::runtime_error("npz_load: failed fread");
+
+    //erase the lagging .npy
+    varname.erase(varname.end()-4,varname.end());
+
+    //read in the extra field
+    uint16_t extra_field_len = *(uint16_t*) &local_header[28];
+    if(extra_field_len > 0) {
+        std::vector<char> buff(extra_field_len);
+        size_t efield_res = fread(&buff[0],sizeof(char),extra_field_len,fp);
+        if(efield_res != extra_field_len)
+            throw std::runtime_error("npz_load: failed fread");
+    }
+
+    uint16_t compr_method = *reinterpret_cast<uint16_t*>(&local_header[0]+8);
+    uint32_t compr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+18);
+    uint32_t uncompr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+22);
+
+    if(compr_method == 0) {arrays[varname] = load_the_npy_file(fp);}
+    else {arrays[varname] = load_the_npz_array(fp,compr_bytes,uncompr_bytes);}
+    return true;
+}
+
 npz_t npz_load(std::string fname) {
     npz_t arrays;
     arrays.clear();
@@ -689,44 +852,218 @@ npz_t npz_load(std::string fname) {
         return arrays;
     }
 
-    while(1) {
-        std::vector<char> local_header(30);
-        size_t headerres = fread(&local_header[0],sizeof(char),30,fp);
-        if(headerres != 30)
-            break;
+    std::vector<ZipRecord> records;
+    size_t cd_offset;
+    if(read_central_directory(fp, records, cd_offset)) {
+        //only entries in the central directory are valid, an appended npz
+        //keeps stale copies of updated or deleted arrays
+        for(auto& rec : records) {
+            fseek(fp,rec.offset,SEEK_SET);
+            load_the_npz_entry(fp, arrays);
+        }
+    } else {
+        fseek(fp,0,SEEK_SET);
+        while(load_the_npz_entry(fp, arrays));
+    }
 
-        //if we've reached the global header, stop reading
-        if(local_header[2] != 0x03 || local_header[3] != 0x04) break;
+    fclose(fp);
+    return arrays;
+}
 
-        //read in the variable name
-        uint16_t name_len = *(uint16_t*) &local_header[26];
-        std::string varname(name_len,' ');
-        size_t vname_res = fread(&varname[0],sizeof(char),name_len,fp);
-        if(vname_res != name_len)
-            throw std::runtime_error("npz_load: failed fread");
+//read the array whose local header is at pos of the mapping, return the
+//position after it, or 0 if there is no local header
+static size_t load_the_mapped_entry(const std::shared_ptr<const char>& mapping,
+        size_t file_size, size_t pos, npz_t& arrays) {
+    const char* base = mapping.get();
+    if(pos + 30 > file_size) return 0;
+    const char* local_header = base + pos;
+    //if we've reached the global header, stop reading
+    if(local_header[2] != 0x03 || local_header[3] != 0x04) return 0;
+
+    uint16_t compr_method = *(uint16_t*) &local_header[8];
+    uint32_t compr_bytes = *(uint32_t*) &local_header[18];
+    uint32_t uncompr_bytes = *(uint32_t*) &local_header[22];
+    uint16_t name_len = *(uint16_t*) &local_header[26];
+    uint16_t extra_field_len = *(uint16_t*) &local_header[28];
+    pos += 30;
+    if(pos + name_len + extra_field_len > file_size)
+        throw std::runtime_error("npz_load_mmap: truncated file");
+    if(name_len < 4)
+        throw std::runtime_error("npz_load_mmap: bad entry name");
+
+    //erase the lagging .npy
+    std::string varname(base + pos, name_len - 4);
+    pos += name_len + extra_field_len;
+
+    if(compr_method != 0) {
+        if(pos + compr_bytes > file_size)
+            throw std::runtime_error("npz_load_mmap: truncated file");
+        arrays[varname] = inflate_the_npz_array(
+            (unsigned char*)(base + pos), compr_bytes, uncompr_bytes);
+        return pos + compr_bytes;
+    }
 
-        //erase the lagging .npy
-        varname.erase(varname.end()-4,varname.end());
+    std::vector<size_t> shape;
+    size_t word_size;
+    char type;
+    bool fortran_order;
+    unsigned char* npy = (unsigned char*)(base + pos);
+    parse_npy_header(npy, word_size, type, shape, fortran_order);
+    //magic(6) + version(2) + header_len(2) + header
+    size_t header_size = 10 + *(uint16_t*)(npy + 8);
+    size_t num_vals = 1;
+    for(auto d : shape) num_vals *= d;
+    size_t nbytes = num_vals * word_size;
+    const char* data = base + pos + header_size;
+    if(pos + header_size + nbytes > file_size)
+        throw std::runtime_error("npz_load_mmap: truncated file");
+
+    NpyArray array;
+    array.shape = shape;
+    array.word_size = word_size;
+    array.type = type;
+    array.fortran_order = fortran_order;
+    array.num_vals = num_vals;
+    if(word_size > 0 && (uintptr_t)data % word_size == 0) {
+        //share the mapping, no copy
+        array.mapped_data = std::shared_ptr<const char>(mapping, data);
+    } else {
+        //misaligned for its type, keep a copy
+        array.data_holder = std::make_shared<std::vector<char>>(
+            data, data + nbytes);
+    }
+    arrays[varname] = array;
+    return pos + header_size + nbytes;
+}
 
-        //read in the extra field
-        uint16_t extra_field_len = *(uint16_t*) &local_header[28];
-        if(extra_field_len > 0) {
-            std::vector<char> buff(extra_field_len);
-            size_t efield_res = fread(&buff[0],sizeof(char),extra_field_len,fp);
-            if(efield_res != extra_field_len)
-                throw std::runtime_error("npz_load: failed fread");
+npz_t npz_load_mmap(std::string fname) {
+    npz_t arrays;
+
+    FILE* fp = fopen(fname.c_str(),"rb");
+    if(!fp) return arrays;
+    std::vector<ZipRecord> records;
+    size_t cd_offset;
+    bool has_cd = read_central_directory(fp, records, cd_offset);
+    fclose(fp);
+
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0) return arrays;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return arrays;
+    }
+    size_t file_size = st.st_size;
+    void* addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) return npz_load(fname);
+    std::shared_ptr<const char> mapping((const char*)addr,
+        [file_size](const char* p) { munmap((void*)p, file_size); });
+
+    if(has_cd) {
+        //only entries in the central directory are valid
+        for(auto& rec : records) {
+            load_the_mapped_entry(mapping, file_size, rec.offset, arrays);
         }
+    } else {
+        size_t pos = 0;
+        while((pos = load_the_mapped_entry(mapping, file_size, pos, arrays)));
+    }
+    return arrays;
+}
 
-        uint16_t compr_method = *reinterpret_cast<uint16_t*>(&local_header[0]+8);
-        uint32_t compr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+18);
-        uint32_t uncompr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+22);
+size_t npz_append_all(std::string zipname, npz_t &map,
+        const std::set<std::string> &dirty) {
+    FILE* fp = fopen(zipname.c_str(),"r+b");
+    std::vector<ZipRecord> records;
+    size_t cd_offset;
+    if(!fp || !read_central_directory(fp, records, cd_offset)) {
+        if(fp) fclose(fp);
+        throw std::runtime_error("npz_append_all: invalid zip file "+zipname);
+    }
+
+    //keep the records of unchanged arrays, their data stays where it is
+    std::vector<char> global_header;
+    std::set<std::string> kept;
+    size_t live_bytes = 0;
+    for(auto& rec : records) {
+        if(map.find(rec.varname) == map.end() || dirty.count(rec.varname) ||
+           kept.count(rec.varname))
+            continue;
+        std::vector<char> local_header(30);
+        fseek(fp,rec.offset,SEEK_SET);
+        if(fread(&local_header[0],sizeof(char),30,fp) != 30)
+            throw std::runtime_error("npz_append_all: failed fread");
+        uint32_t compr_bytes = *(uint32_t*) &local_header[18];
+        uint16_t name_len = *(uint16_t*) &local_header[26];
+        uint16_t extra_field_len = *(uint16_t*) &local_header[28];
+        live_bytes += 30 + name_len + extra_field_len + compr_bytes;
+        global_header.insert(global_header.end(),rec.raw.begin(),rec.raw.end());
+        kept.insert(rec.varname);
+    }
 
-        if(compr_method == 0) {arrays[varname] = load_the_npy_file(fp);}
-        else {arrays[varname] = load_the_npz_array(fp,compr_bytes,uncompr_bytes);}
+    //write the others where the central directory was
+    fseek(fp,cd_offset,SEEK_SET);
+    size_t offset = cd_offset;
+    size_t nrecs = kept.size();
+    for(auto& it : map) {
+        if(kept.count(it.first)) continue;
+        const NpyArray& arr = it.second;
+        if(arr.shape.size() == 0) {
+            std::cerr << "[Warning] zip name: " << it.first <<" npz shape size is 0, skip it\n";
+            continue;
+        }
+        std::string fname = it.first + ".npy";
+        std::vector<char> npy_header = create_npy_header(arr.shape,
+                arr.word_size, arr.type);
+        size_t data_bytes = arr.num_bytes();
+        std::vector<char> local_header = create_local_header(fname,
+                npy_header, arr.data<char>(), data_bytes, offset);
+        fwrite(&local_header[0],sizeof(char),local_header.size(),fp);
+        fwrite(&npy_header[0],sizeof(char),npy_header.size(),fp);
+        fwrite(arr.data<char>(),sizeof(char),data_bytes,fp);
+        size_t entry_bytes = local_header.size() + npy_header.size() + data_bytes;
+        std::vector<char> record = create_central_record(local_header, fname,
+                offset, offset + entry_bytes >= ZIP64_LIMIT);
+        global_header.insert(global_header.end(),record.begin(),record.end());
+        offset += entry_bytes;
+        live_bytes += entry_bytes;
+        nrecs++;
     }
+    if(nrecs > 0xFFFF)
+        throw std::runtime_error("npz_append_all: too many arrays");
 
+    fwrite(&global_header[0],sizeof(char),global_header.size(),fp);
+    write_zip_footer(fp, nrecs, global_header.size(), offset,
+            offset >= ZIP64_LIMIT);
+    //drop what is left of the old central directory
+    fflush(fp);
+    if(ftruncate(fileno(fp), ftell(fp)) != 0)
+        throw std::runtime_error("npz_append_all: failed ftruncate");
     fclose(fp);
-    return arrays;
+    return offset - live_bytes;
+}
+
+bool npz_reflink(std::string src, std::string dst) {
+    //write aside and rename, dst may be mapped by npz_load_mmap
+    std::string tmp = dst + ".tmp";
+    int in = open(src.c_str(), O_RDONLY);
+    if(in < 0) throw std::runtime_error("npz_reflink: Unable to open file "+src);
+    int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(out < 0) {
+        close(in);
+        throw std::runtime_error("npz_reflink: Unable to open file "+tmp);
+    }
+    bool shared = ioctl(out, FICLONE, in) == 0;
+    close(in);
+    close(out);
+    if(!shared) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    if(rename(tmp.c_str(), dst.c_str()) != 0)
+        throw std::runtime_error("npz_reflink: failed to rename "+tmp);
+    return true;
 }
 
 NpyArray npz_load(std::string fname, std::string varname) {
@@ -16,6 +16,7 @@
 #include<cassert>
 #include<zlib.h>
 #include<map>
+#include<set>
 #include<memory>
 #include<stdint.h>
 #include<numeric>
@@ -37,14 +38,24 @@ struct NpyArray {
 
     template<typename T>
     T* data() {
+        detach();
         return reinterpret_cast<T*>(&(*data_holder)[0]);
     }
 
     template<typename T>
     const T* data() const {
+        if (mapped_data) return reinterpret_cast<const T*>(mapped_data.get());
         return reinterpret_cast<T*>(&(*data_holder)[0]);
     }
 
+    // copy mapped data into data_holder, so that it can be modified
+    void detach() {
+        if (!mapped_data) return;
+        data_holder = std::make_shared<std::vector<char>>(
+            mapped_data.get(), mapped_data.get() + num_vals * word_size);
+        mapped_data.reset();
+    }
+
     template<typename T>
     std::vector<T> as_vec() const {
         const T* p = data<T>();
@@ -52,10 +63,14 @@ struct NpyArray {
     }
 
     size_t num_bytes() const {
+        if (mapped_data) return num_vals * word_size;
         return data_holder->size();
     }
 
     std::shared_ptr<std::vector<char>> data_holder;
+    // read-only view into a file mapping, used instead of data_holder when
+    // set (see npz_load_mmap); it keeps the mapping alive
+    std::shared_ptr<const char> mapped_data;
     std::vector<size_t> shape;
     size_t word_size;
     char type;
@@ -74,6 +89,9 @@ void parse_npy_header(unsigned char* buffer, size_t& word_size, char& type,
 void parse_zip_footer(FILE* fp, uint16_t& nrecs, size_t& global_header_size,
         size_t& global_header_offset);
 npz_t npz_load(std::string fname);
+// same as npz_load, but stored (uncompressed) arrays are not copied, they
+// point into a read-only mapping of the file
+npz_t npz_load_mmap(std::string fname);
 NpyArray npz_load(std::string fname, std::string varname);
 NpyArray npy_load(std::string fname);
 
@@ -111,6 +129,16 @@ void npz_add_array(npz_t &map, std::string fname,
         const std::vector<T> &data);
 
 void npz_save_all(std::string zipname, npz_t &map);
+// update an existing npz to hold exactly the arrays of map, without
+// rewriting it: entries whose name is in map but not in dirty are kept in
+// place, the other arrays of map are appended, and the central directory is
+// rewritten. returns the bytes left unreferenced by dropped entries.
+size_t npz_append_all(std::string zipname, npz_t &map,
+        const std::set<std::string> &dirty);
+// copy npz file src to dst by sharing its data blocks (FICLONE on btrfs,
+// xfs with reflink, ...). returns false without touching dst if the file
+// system can't, e.g. ext4.
+bool npz_reflink(std::string src, std::string dst);
 
 } // namespace cnpy
 
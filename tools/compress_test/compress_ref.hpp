@@ -0,0 +1,24 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// TPU-MLIR is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "tpu_mlir/Support/TPUCompressUtil.h"
+
+namespace tpu_mlir {
+
+// reference encoders, same interface and output as compressInt8Data and
+// compressBf16Data
+void compressInt8DataRef(const uint8_t *ibuf, int isz, uint8_t *obuf, int *osz,
+                         CompressCommandInfo *cmd_info);
+
+void compressBf16DataRef(const uint8_t *ibuf, int isz, uint8_t *obuf, int *osz,
+                         CompressCommandInfo *cmd_info);
+
+} // namespace tpu_mlir
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// TPU-MLIR is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "compress_ref.hpp"
+#include "tpu_mlir/Support/MathUtils.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <random>
+
+using namespace tpu_mlir;
+
+static std::mt19937 gen(0);
+
+static std::vector<uint8_t> make_data(int isz, int is_bf16, float scale,
+                                      float zero_ratio) {
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::vector<uint8_t> data(isz, 0);
+  if (is_bf16) {
+    auto data16 = (uint16_t *)data.data();
+    for (int i = 0; i < isz / 2; i++) {
+      float val = uniform(gen) < zero_ratio ? 0.0f : normal(gen) * scale;
+      uint32_t bits;
+      memcpy(&bits, &val, sizeof(bits));
+      data16[i] = bits >> 16;
+    }
+  } else {
+    for (int i = 0; i < isz; i++) {
+      float val = uniform(gen) < zero_ratio ? 0.0f : normal(gen) * scale;
+      data[i] = (uint8_t)(int8_t)std::max(-128.0f, std::min(127.0f, val));
+    }
+  }
+  return data;
+}
+
+static double compress(const std::vector<uint8_t> &data, int is_bf16,
+                       bool ref, std::vector<uint8_t> &compressed,
+                       CompressCommandInfo &cmd_info) {
+  memset(&cmd_info, 0, sizeof(cmd_info));
+  cmd_info.signedness = is_bf16 ? 0 : 1;
+  cmd_info.is_bfloat16 = is_bf16;
+  cmd_info.bias0 = is_bf16 ? 127 : 0;
+  getCompressParameter(data.data(), data.size(), cmd_info.signedness,
+                       cmd_info.is_bfloat16, &cmd_info);
+  compressed.assign(getCompressedDataSize(data.size(), is_bf16), 0);
+  int osz = compressed.size();
+  auto start = std::chrono::steady_clock::now();
+  if (is_bf16) {
+    (ref ? compressBf16DataRef : compressBf16Data)(
+        data.data(), data.size(), compressed.data(), &osz, &cmd_info);
+  } else {
+    (ref ? compressInt8DataRef : compressInt8Data)(
+        data.data(), data.size(), compressed.data(), &osz, &cmd_info);
+  }
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  compressed.resize(osz);
+  return cost.count();
+}
+
+// random weights are encoded by the encoder and the scalar reference, which
+// must agree byte for byte, and decoded back; then the encoder throughput
+// is reported
+static bool testCompress() {
+  const float scales[] = {0.5f, 4.0f, 40.0f, 1000.0f};
+  for (int is_bf16 = 0; is_bf16 <= 1; is_bf16++) {
+    const char *name = is_bf16 ? "bf16" : "int8";
+    for (int iter = 0; iter < 200; iter++) {
+      int isz = std::uniform_int_distribution<int>(
+          1, 1 << (iter % 2 ? 10 : 18))(gen);
+      isz = is_bf16 ? align_up(isz, 2) : isz;
+      auto data = make_data(isz, is_bf16, scales[iter % 4], (iter % 3) * 0.3f);
+      std::vector<uint8_t> compressed, expected;
+      CompressCommandInfo cmd_info, ref_info;
+      compress(data, is_bf16, false, compressed, cmd_info);
+      compress(data, is_bf16, true, expected, ref_info);
+      if (compressed != expected) {
+        llvm::errs() << name << " compress differs from reference, size "
+                     << isz << "\n";
+        return false;
+      }
+
+      std::vector<uint8_t> decompressed(isz);
+      CompressCommandInfo dec_info;
+      if (is_bf16) {
+        decompressBf16Data(compressed.data(), compressed.size(),
+                           decompressed.data(), isz, &dec_info);
+        // fraction of zero exponent is not kept with zero guard
+        auto data16 = (uint16_t *)data.data();
+        for (int i = 0; i < isz / 2 && cmd_info.zero_guard_en; i++) {
+          if ((data16[i] & 0x7F80) == 0) {
+            data16[i] = 0;
+          }
+        }
+      } else {
+        decompressInt8Data(compressed.data(), compressed.size(),
+                           decompressed.data(), isz, &dec_info);
+      }
+      if (decompressed != data || dec_info.bias0 != cmd_info.bias0 ||
+          dec_info.bias1 != cmd_info.bias1) {
+        llvm::errs() << name << " compress round trip failed, size " << isz
+                     << "\n";
+        return false;
+      }
+    }
+
+    int isz = 64 << 20;
+    auto data = make_data(isz, is_bf16, is_bf16 ? 0.5f : 40.0f, 0.1f);
+    std::vector<uint8_t> compressed, expected;
+    CompressCommandInfo cmd_info;
+    double cost = compress(data, is_bf16, false, compressed, cmd_info);
+    double ref_cost = compress(data, is_bf16, true, expected, cmd_info);
+    if (compressed != expected) {
+      llvm::errs() << name << " compress differs from reference, size " << isz
+                   << "\n";
+      return false;
+    }
+    llvm::outs() << name << " compress: " << (isz >> 20) << " MB to "
+                 << (compressed.size() >> 20) << " MB, "
+                 << llvm::format("%.1f", (isz >> 20) / cost)
+                 << " MB/s, reference "
+                 << llvm::format("%.1f", (isz >> 20) / ref_cost) << " MB/s\n";
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (!testCompress()) {
+    llvm::errs() << "compress test FAILED\n";
+    return 1;
+  }
+  llvm::outs() << "compress test PASSED\n";
+  return 0;
+}
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// TPU-MLIR is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tpu_mlir/Support/Float16.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+
+using namespace tpu_mlir;
+
+static std::mt19937 gen(0);
+
+// normal values with some zeros, denorms, infs and nans mixed in
+static std::vector<float> make_data(int64_t num) {
+  std::normal_distribution<float> normal(0.0f, 100.0f);
+  std::uniform_int_distribution<uint32_t> bits;
+  std::vector<float> data(num);
+  for (int64_t i = 0; i < num; i++) {
+    if (i % 16 == 0) {
+      uint32_t u = bits(gen);
+      memcpy(&data[i], &u, sizeof(u));
+    } else {
+      data[i] = normal(gen);
+    }
+  }
+  return data;
+}
+
+// best of a few runs, in seconds
+static double timeit(const std::function<void()> &fn) {
+  double best = 0;
+  for (int i = 0; i < 5; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double> cost =
+        std::chrono::steady_clock::now() - start;
+    best = i == 0 ? cost.count() : std::min(best, cost.count());
+  }
+  return best;
+}
+
+template <typename T>
+static bool report(const char *name, int64_t num, const std::vector<T> &out,
+                   const std::vector<T> &ref, double cost, double ref_cost) {
+  if (memcmp(out.data(), ref.data(), num * sizeof(T)) != 0) {
+    llvm::errs() << name << " differs from the scalar version\n";
+    return false;
+  }
+  llvm::outs() << llvm::format("%-12s", name)
+               << llvm::format("%8.1f", num / cost / 1e6) << " M/s, scalar "
+               << llvm::format("%8.1f", num / ref_cost / 1e6) << " M/s, "
+               << llvm::format("%.1f", ref_cost / cost) << "x\n";
+  return true;
+}
+
+// each bulk conversion is timed against a loop of its scalar version, and
+// must give the same bits
+static bool benchFloat16(int64_t num) {
+  auto src = make_data(num);
+  std::vector<uint16_t> u16(num), u16_ref(num);
+  std::vector<float> f32(num), f32_ref(num);
+  double cost, ref_cost;
+
+  cost = timeit([&]() { f32_to_bf16(src.data(), u16.data(), num); });
+  ref_cost = timeit([&]() {
+    for (int64_t i = 0; i < num; i++) {
+      u16_ref[i] = f32_to_bf16(src[i]);
+    }
+  });
+  if (!report("f32_to_bf16", num, u16, u16_ref, cost, ref_cost)) {
+    return false;
+  }
+
+  cost = timeit([&]() { f32_to_f16(src.data(), u16.data(), num); });
+  ref_cost = timeit([&]() {
+    for (int64_t i = 0; i < num; i++) {
+      u16_ref[i] = f32_to_f16(src[i]);
+    }
+  });
+  if (!report("f32_to_f16", num, u16, u16_ref, cost, ref_cost)) {
+    return false;
+  }
+
+  cost = timeit([&]() { BF16(src.data(), f32.data(), num); });
+  ref_cost = timeit([&]() {
+    for (int64_t i = 0; i < num; i++) {
+      f32_ref[i] = BF16(src[i]);
+    }
+  });
+  if (!report("BF16", num, f32, f32_ref, cost, ref_cost)) {
+    return false;
+  }
+
+  cost = timeit([&]() { F16(src.data(), f32.data(), num); });
+  ref_cost = timeit([&]() {
+    for (int64_t i = 0; i < num; i++) {
+      f32_ref[i] = F16(src[i]);
+    }
+  });
+  return report("F16", num, f32, f32_ref, cost, ref_cost);
+}
+
+int main(int argc, char **argv) {
+  int64_t num = argc > 1 ? std::atoll(argv[1]) : 16 << 20;
+  llvm::outs() << "convert " << num << " floats\n";
+  if (!benchFloat16(num)) {
+    llvm::errs() << "float16 bench FAILED\n";
+    return 1;
+  }
+  return 0;
+}
@@ -518,7 +518,9 @@ void bm_combine_bmodels(int argc, char **argv, bool is_dir = false) {
     model_vec.push_back(model_info);
   }
   prepare_output(ofile, is_dir);
-  ModelGen model_gen;
+  // binaries of all models may not fit in memory, keep them in a spill file
+  ModelGen model_gen(0);
+  model_gen.SetBinaryStream(ofile + ".binary");
   combine_bmodels(model_gen, model_vec, is_dir);
   model_gen.Save(ofile);
   cout << "Success: combined to [" << ofile << "]." << endl;